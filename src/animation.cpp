@@ -0,0 +1,150 @@
+/**
+ * @file animation.cpp
+ * @brief Implements the Animator pool and the Animation handle.
+ */
+#include "animation.hpp"
+#include <Arduino.h>
+
+Animator g_animator;
+
+/// Checks whether a distance or velocity is large enough to keep a property moving.
+static inline bool exceedsThreshold(AnimValue amount) {
+    static const AnimValue threshold = ANIMATION_SETTLE_THRESHOLD;
+    return amount > threshold || amount < -threshold;
+}
+
+// --- Animator Implementation ---
+
+Animator::Animator() : moving_count(0) {}
+
+Animator::Property* Animator::acquire(AnimationGains gains, AnimValue initial) {
+    for (Property& property : pool) {
+        if (!property.in_use) {
+            property.in_use = true;
+            property.moving = false;
+            property.value = initial;
+            property.target = initial;
+            property.velocity = 0;
+            property.gains = gains;
+            property.pid.reset();
+            loadGains(property);
+            return &property;
+        }
+    }
+    return nullptr;
+}
+
+void Animator::release(Property* property) {
+    if (!property) return;
+    if (property->moving) {
+        moving_count--;
+    }
+    property->moving = false;
+    property->in_use = false;
+}
+
+void Animator::retarget(Property* property, AnimValue target) {
+    if (target == property->target) return;
+    property->target = target;
+    if (!property->moving) {
+        property->pid.reset();
+        property->moving = true;
+        moving_count++;
+    }
+}
+
+void Animator::jump(Property* property, AnimValue value) {
+    if (property->moving) {
+        property->moving = false;
+        moving_count--;
+    }
+    property->value = value;
+    property->target = value;
+    property->velocity = 0;
+    property->pid.reset();
+}
+
+/**
+ * @brief Advances every moving property.
+ * @details Returns immediately when everything is at rest, so a settled UI does no
+ * animation math at all.
+ */
+bool Animator::advance(AnimValue dt) {
+    if (moving_count == 0) return false;
+
+    for (Property& property : pool) {
+        if (!property.moving) continue;
+
+        if (exceedsThreshold(property.target - property.value) || exceedsThreshold(property.velocity)) {
+            property.velocity = property.pid.update(property.target, property.value, dt);
+            property.value += property.velocity * dt;
+        } else {
+            property.value = property.target;
+            property.velocity = 0;
+            property.moving = false;
+            moving_count--;
+        }
+    }
+    return true;
+}
+
+bool Animator::settled() const {
+    return moving_count == 0;
+}
+
+void Animator::applyGains() {
+    for (Property& property : pool) {
+        if (property.in_use) {
+            loadGains(property);
+        }
+    }
+}
+
+void Animator::loadGains(Property& property) {
+    if (property.gains == AnimationGains::SCROLL) {
+        property.pid.set_gains(g_config.scroll_pid_kp, g_config.scroll_pid_ki, g_config.scroll_pid_kd);
+    } else {
+        property.pid.set_gains(g_config.anim_pid_kp, g_config.anim_pid_ki, g_config.anim_pid_kd);
+    }
+}
+
+// --- Animation Implementation ---
+
+Animation::Animation(AnimationGains gains, AnimValue initial, Animator& animator)
+    : animator(animator), property(animator.acquire(gains, initial)), fallback(initial) {}
+
+Animation::~Animation() {
+    animator.release(property);
+}
+
+void Animation::animateTo(AnimValue target) {
+    if (property) {
+        animator.retarget(property, target);
+    } else {
+        fallback = target;
+    }
+}
+
+void Animation::jumpTo(AnimValue value) {
+    if (property) {
+        animator.jump(property, value);
+    } else {
+        fallback = value;
+    }
+}
+
+AnimValue Animation::value() const {
+    return property ? property->value : fallback;
+}
+
+int Animation::rounded() const {
+    return roundToInt(value());
+}
+
+AnimValue Animation::target() const {
+    return property ? property->target : fallback;
+}
+
+bool Animation::settled() const {
+    return !property || !property->moving;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file animation.hpp
+ * @brief Defines the animation engine: a pool of PID-driven properties advanced once per frame.
+ * @defgroup Animation
+ * @{
+ */
+#pragma once
+
+#include <stdint.h>
+#include "config.hpp"
+#include "pid.hpp"
+
+/**
+ * @enum AnimationGains
+ * @brief Selects which set of PID gains from g_config drives a property.
+ * @ingroup Animation
+ */
+enum class AnimationGains : uint8_t {
+    SCROLL,    ///< The menu scrolling gains (scroll_pid_*).
+    TRANSITION ///< The page/menu transition gains (anim_pid_*).
+};
+
+/**
+ * @class Animator
+ * @brief A fixed pool of animated properties that are advanced together once per frame.
+ * @ingroup Animation
+ *
+ * Each property moves its value towards its target with a PIDController whose output is
+ * used as velocity. A property is settled once both the remaining distance and the
+ * velocity are below ANIMATION_SETTLE_THRESHOLD; it then snaps to the target and costs
+ * nothing until it is given a new target. All per-frame math uses AnimValue, so it runs
+ * in fixed point when the firmware is built with RINGUI_FIXED_POINT. Properties are normally used through the
+ * RAII handle Animation rather than directly.
+ */
+class Animator {
+public:
+    /**
+     * @struct Property
+     * @brief A single animated value in the pool.
+     */
+    struct Property {
+        Property() : value(0), target(0), velocity(0), pid(0, 0, 0),
+                     gains(AnimationGains::SCROLL), in_use(false), moving(false) {}
+
+        AnimValue value;      ///< The current value.
+        AnimValue target;     ///< The value being animated towards.
+        AnimValue velocity;   ///< The last PID output, per animation step.
+        PIDController pid;    ///< The controller that drives the value.
+        AnimationGains gains; ///< The gain set loaded into the controller.
+        bool in_use;          ///< True if the slot is allocated.
+        bool moving;          ///< True until the property has settled at its target.
+    };
+
+    Animator();
+
+    /**
+     * @brief Allocates a property from the pool.
+     * @param gains The gain set that drives the property.
+     * @param initial The initial value, which is also the initial target.
+     * @return The property, or nullptr if the pool is exhausted.
+     */
+    Property* acquire(AnimationGains gains, AnimValue initial);
+
+    /**
+     * @brief Returns a property to the pool.
+     * @param property The property to release. nullptr is ignored.
+     */
+    void release(Property* property);
+
+    /**
+     * @brief Gives a property a new target.
+     *
+     * A property that starts moving from rest gets a fresh controller state, while
+     * retargeting a moving property keeps its momentum.
+     * @param property The property to animate.
+     * @param target The new target value.
+     */
+    void retarget(Property* property, AnimValue target);
+
+    /**
+     * @brief Sets a property's value and target immediately and stops its motion.
+     * @param property The property to change.
+     * @param value The new value.
+     */
+    void jump(Property* property, AnimValue value);
+
+    /**
+     * @brief Advances every moving property.
+     * @param dt The elapsed time in animation steps of ANIMATION_REFERENCE_MS.
+     * @return true if any property changed its value, i.e. a redraw is needed.
+     */
+    bool advance(AnimValue dt);
+
+    /**
+     * @brief Checks whether all properties are at rest.
+     * @return true if no property is moving.
+     */
+    bool settled() const;
+
+    /**
+     * @brief Reloads the PID gains of all properties from g_config.
+     */
+    void applyGains();
+
+private:
+    /// Loads the gains of a property's gain set into its controller.
+    static void loadGains(Property& property);
+
+    Property pool[MAX_ANIMATIONS]; ///< The property slots.
+    int moving_count;              ///< The number of properties that are moving.
+};
+
+/// @brief Global animation engine, advanced once per frame by the RingController.
+/// @ingroup Animation
+extern Animator g_animator;
+
+/**
+ * @class Animation
+ * @brief An RAII handle to an animated property in an Animator's pool.
+ * @ingroup Animation
+ *
+ * The property is released when the handle goes out of scope. If the pool is exhausted,
+ * the handle still works but jumps straight to each new target.
+ */
+class Animation {
+public:
+    /**
+     * @brief Allocates an animated property.
+     * @param gains The gain set that drives the property.
+     * @param initial The initial value.
+     * @param animator The pool to allocate from.
+     */
+    Animation(AnimationGains gains, AnimValue initial, Animator& animator = g_animator);
+    ~Animation();
+    Animation(const Animation&) = delete;
+    Animation& operator=(const Animation&) = delete;
+
+    /**
+     * @brief Sets a new target. The value moves towards it on the following frames.
+     * @param target The new target value.
+     */
+    void animateTo(AnimValue target);
+
+    /**
+     * @brief Sets the value and the target immediately, without animating.
+     * @param value The new value.
+     */
+    void jumpTo(AnimValue value);
+
+    /**
+     * @brief Gets the current value.
+     * @return The animated value.
+     */
+    AnimValue value() const;
+
+    /**
+     * @brief Gets the current value rounded to the nearest pixel.
+     * @return The animated value as an integer.
+     */
+    int rounded() const;
+
+    /**
+     * @brief Gets the current target.
+     * @return The value being animated towards.
+     */
+    AnimValue target() const;
+
+    /**
+     * @brief Checks whether the value has reached its target.
+     * @return true if the property is at rest.
+     */
+    bool settled() const;
+
+private:
+    Animator& animator;           ///< The pool the property belongs to.
+    Animator::Property* property; ///< The property, or nullptr if the pool was exhausted.
+    AnimValue fallback;           ///< The value used when no property could be allocated.
+};
+/** @} */
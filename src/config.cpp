@@ -3,6 +3,8 @@
  * @brief Contains the initialization for the global application configuration.
  */
 #include "config.hpp"
+#include <stddef.h>
+#include <string.h>
 
 /// @brief Global instance of the application configuration, with default values.
 AppConfig g_config = {
@@ -12,5 +14,45 @@ AppConfig g_config = {
     .anim_pid_kp = 0.25f,
     .anim_pid_ki = 0.0f,
     .anim_pid_kd = 0.15f,
-    .use_serial_control = true
-};
\ No newline at end of file
+    .use_serial_control = true,
+    .show_profiler_hud = false
+};
+
+/// How a ConfigField is stored in AppConfig.
+struct ConfigFieldInfo {
+    size_t offset; ///< The offset of the field in AppConfig.
+    uint8_t size;  ///< 4 for a float, 1 for a bool.
+};
+
+/// The fields in ConfigField order.
+static const ConfigFieldInfo CONFIG_FIELDS[] = {
+    {offsetof(AppConfig, scroll_pid_kp), sizeof(float)},
+    {offsetof(AppConfig, scroll_pid_ki), sizeof(float)},
+    {offsetof(AppConfig, scroll_pid_kd), sizeof(float)},
+    {offsetof(AppConfig, anim_pid_kp), sizeof(float)},
+    {offsetof(AppConfig, anim_pid_ki), sizeof(float)},
+    {offsetof(AppConfig, anim_pid_kd), sizeof(float)},
+    {offsetof(AppConfig, use_serial_control), sizeof(bool)},
+    {offsetof(AppConfig, show_profiler_hud), sizeof(bool)},
+};
+static_assert(sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]) == CONFIG_FIELD_COUNT,
+              "CONFIG_FIELDS must list every ConfigField");
+
+size_t configFieldSize(uint8_t id) {
+    return id < CONFIG_FIELD_COUNT ? CONFIG_FIELDS[id].size : 0;
+}
+
+void readConfigField(uint8_t id, uint8_t* out) {
+    const ConfigFieldInfo& field = CONFIG_FIELDS[id];
+    memcpy(out, reinterpret_cast<const uint8_t*>(&g_config) + field.offset, field.size);
+}
+
+void writeConfigField(uint8_t id, const uint8_t* in) {
+    const ConfigFieldInfo& field = CONFIG_FIELDS[id];
+    uint8_t* target = reinterpret_cast<uint8_t*>(&g_config) + field.offset;
+    if (field.size == sizeof(bool)) {
+        *reinterpret_cast<bool*>(target) = in[0] != 0;
+    } else {
+        memcpy(target, in, field.size);
+    }
+}
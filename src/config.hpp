@@ -6,6 +6,9 @@
  */
 #pragma once
 #include <U8g2lib.h>
+#if defined(RINGUI_SIMULATOR)
+#include "sim/sim_display.hpp"
+#endif
 
 //==============================================================================
 // Display Properties
@@ -16,8 +19,13 @@
  * @{
  */
 /// 
-/// The type definition for the display driver.
+/// The type definition for the display driver. The `native` environment replaces it
+/// with the in-memory display of the host simulator.
+#if defined(RINGUI_SIMULATOR)
+using DisplayDriver = SimDisplay;
+#else
 using DisplayDriver = U8G2_SSD1306_128X32_UNIVISION_F_HW_I2C;
+#endif
 ///
 /// The width of the OLED screen in pixels.
 static constexpr int SCREEN_WIDTH = 128;
@@ -52,6 +60,21 @@ static constexpr int INIT_CURSOR_X = 0;
 ///
 /// The initial vertical position for the text cursor.
 static constexpr int INIT_CURSOR_Y = 0;
+///
+/// The state text shown right-aligned on an enabled SWITCH item.
+static constexpr const char* SWITCH_ON_TEXT = "[ON]";
+///
+/// The state text shown right-aligned on a disabled SWITCH item.
+static constexpr const char* SWITCH_OFF_TEXT = "[OFF]";
+///
+/// The number of produced items a CallbackMenu keeps. Must cover the visible rows and the selection.
+static constexpr int MENU_WINDOW_SIZE = 8;
+///
+/// The size in bytes of the label buffer a CallbackMenu provides for each produced item.
+static constexpr size_t MENU_LABEL_CAPACITY = 32;
+///
+/// The longest text in bytes that is measured for layout. Longer text is measured by its start.
+static constexpr size_t MAX_MEASURED_TEXT = 48;
 /** @} */
 
 //==============================================================================
@@ -80,8 +103,56 @@ static constexpr int CTRL_ADDR = 0x4C; // Not currently used
  * @ingroup Config
  * @{
  */
-/// The delay in milliseconds between animation frames.
-static constexpr int ANIMATION_DELAY = 10; // ms
+/// The frame rate the UI loops aim for while something moves. A settled screen sleeps until input.
+static constexpr uint32_t TARGET_FPS = 100;
+/// The frame period in milliseconds the animation gains are tuned for. One animation step.
+static constexpr float ANIMATION_REFERENCE_MS = 10.0f;
+/// The largest number of animation steps a single frame may advance, to avoid overshoot after stalls.
+static constexpr float MAX_ANIMATION_STEPS = 4.0f;
+/// The distance and velocity below which an animated property is considered settled.
+static constexpr float ANIMATION_SETTLE_THRESHOLD = 0.1f;
+/// The number of animated properties that can exist at the same time.
+static constexpr int MAX_ANIMATIONS = 8;
+/** @} */
+
+//==============================================================================
+// Render Task
+//==============================================================================
+/**
+ * @defgroup RenderTaskConfig Render Task
+ * @ingroup Config
+ * @{
+ */
+/// The CPU core the render task is pinned to. The Arduino loop runs on core 1.
+static constexpr int RENDER_TASK_CORE = 0;
+/// The FreeRTOS priority of the render task.
+static constexpr unsigned RENDER_TASK_PRIORITY = 2;
+/// The stack size of the render task in bytes.
+static constexpr size_t RENDER_TASK_STACK_SIZE = 4096;
+/** @} */
+
+//==============================================================================
+// Pages
+//==============================================================================
+/**
+ * @defgroup PageConfig Pages
+ * @ingroup Config
+ * @{
+ */
+/// The size in bytes of the slab that pages created with emplacePage() are built in.
+/// Every such page type must fit; this is checked at compile time.
+static constexpr size_t PAGE_ARENA_SIZE = 256;
+///
+/// The size in bytes of a chunk of text that a StreamInfoPage reads from its source at once.
+static constexpr size_t STREAM_CHUNK_SIZE = 256;
+///
+/// The number of chunks a StreamInfoPage keeps around the scroll position.
+static constexpr int STREAM_CHUNK_COUNT = 4;
+///
+/// How far back in bytes a StreamInfoPage looks for the start of a line when scrolling up.
+/// Above a longer paragraph, scrolling up keeps to the lines below but may wrap differently
+/// from scrolling down.
+static constexpr size_t STREAM_MAX_BACKSCAN = 2048;
 /** @} */
 
 //==============================================================================
@@ -102,6 +173,96 @@ static constexpr int PIN_ENCODER_A = 13;
 static constexpr int PIN_ENCODER_B = 12;
 /** @} */
 
+//==============================================================================
+// Input
+//==============================================================================
+/**
+ * @defgroup InputConfig Input
+ * @ingroup Config
+ * @{
+ */
+/// The number of slots in the input event queue. Must be a power of two.
+static constexpr size_t INPUT_QUEUE_SIZE = 32;
+/// The minimum time in milliseconds between two accepted edges of a button.
+static constexpr uint32_t BUTTON_DEBOUNCE_MS = 50;
+/// How long in microseconds an encoder pin state must be held to count. Shorter changes are
+/// contact bounce. Used by the interrupt decoder only, see ENCODER_PCNT_FILTER_CYCLES.
+static constexpr uint32_t ENCODER_GLITCH_FILTER_US = 500;
+/// The glitch filter of the PCNT encoder backend, in APB clock cycles. 1023 is the longest
+/// the hardware supports, about 12.8 us at the 80 MHz APB clock, so longer contact bounce
+/// reaches the counter; it cancels out, as the counter counts every edge both ways.
+static constexpr uint16_t ENCODER_PCNT_FILTER_CYCLES = 1023;
+/// How often in milliseconds a settled UI reads the pulse counter, which raises no interrupt
+/// when the encoder turns. The first detent of a turn waits up to this long to be seen.
+static constexpr uint32_t ENCODER_PCNT_IDLE_POLL_MS = 20;
+/// Encoder detents at least this many milliseconds apart are never accelerated.
+static constexpr uint16_t ACCEL_SLOW_INTERVAL_MS = 80;
+/// Encoder detents at most this many milliseconds apart get the full acceleration.
+static constexpr uint16_t ACCEL_FAST_INTERVAL_MS = 12;
+/// The steps one detent moves an EditFloatPage value at full speed.
+static constexpr uint16_t VALUE_ACCEL_MAX_STEPS = 25;
+/// The items one detent moves the selection at full speed in a menu that opts into acceleration.
+static constexpr uint16_t MENU_ACCEL_MAX_STEPS = 8;
+/** @} */
+
+//==============================================================================
+// Profiler
+//==============================================================================
+/**
+ * @defgroup ProfilerConfig Profiler
+ * @ingroup Config
+ * @{
+ */
+/// The number of frames the profiler keeps. At TARGET_FPS this should cover more than a second.
+static constexpr int PROFILER_SAMPLES = 128;
+/// The interval in milliseconds at which the performance HUD is redrawn on a settled screen.
+static constexpr uint32_t HUD_REFRESH_MS = 250;
+/** @} */
+
+//==============================================================================
+// Remote Control
+//==============================================================================
+/**
+ * @defgroup RemoteConfig Remote Control
+ * @ingroup Config
+ * @{
+ */
+/// The size in bytes of the serial receive buffer frames are parsed in. Must hold at least
+/// one frame with the largest payload (260 bytes).
+static constexpr size_t REMOTE_BUFFER_SIZE = 512;
+/// The size in bytes of the queue replies wait in until the serial port has room for them.
+/// Must hold the PROFILE reply, 2010 bytes with 128 profiler samples, plus a few more replies.
+static constexpr size_t REMOTE_TX_BUFFER_SIZE = 2560;
+/// The deepest menu path a NAVIGATE command may give.
+static constexpr size_t REMOTE_MAX_PATH = 8;
+/// The shortest time in milliseconds between two frames sent by the framebuffer mirror.
+static constexpr uint32_t MIRROR_INTERVAL_MS = 100;
+/// The most bytes the framebuffer mirror writes per UI frame. Less is written when the
+/// serial transmit buffer has less room.
+static constexpr size_t MIRROR_MAX_BYTES = 512;
+/** @} */
+
+//==============================================================================
+// Settings Storage
+//==============================================================================
+/**
+ * @defgroup StorageConfig Settings Storage
+ * @ingroup Config
+ * @{
+ */
+/// The version of the stored AppConfig record. Bump it when a ConfigField id is reused or
+/// a field's meaning changes; records of another version are ignored. New fields get new
+/// ids and need no bump.
+static constexpr uint8_t CONFIG_VERSION = 1;
+/// How long in milliseconds g_config must stay unchanged before it is written to flash,
+/// so a burst of edits costs one write.
+static constexpr uint32_t CONFIG_COMMIT_DELAY_MS = 3000;
+/// The NVS namespace the settings are stored in.
+static constexpr const char* CONFIG_NVS_NAMESPACE = "ringui";
+/// The NVS key of the AppConfig record.
+static constexpr const char* CONFIG_NVS_KEY = "config";
+/** @} */
+
 /**
  * @struct AppConfig
  * @brief Holds runtime-configurable parameters, primarily PID gains for animations.
@@ -118,8 +279,54 @@ struct AppConfig {
     float anim_pid_kd;   ///< Derivative gain for page/menu transitions.
     // System settings
     bool use_serial_control; ///< If true, allows controlling the UI via serial commands.
+    bool show_profiler_hud;  ///< If true, draws FPS, worst frame time and free heap over the UI.
 };
 
 /// Global instance of the application configuration.
 extern AppConfig g_config;
+
+/**
+ * @enum ConfigField
+ * @brief Identifies the AppConfig fields that are stored and remotely accessible.
+ * @ingroup Config
+ *
+ * The ids are used by GET_CONFIG and SET_CONFIG and in the stored record, so they are
+ * never reused: a new field gets the next id. The gains are 4-byte IEEE 754 floats, the
+ * switches one byte (0 or 1), both little-endian like the ESP32.
+ */
+enum class ConfigField : uint8_t {
+    SCROLL_PID_KP = 0,
+    SCROLL_PID_KI = 1,
+    SCROLL_PID_KD = 2,
+    ANIM_PID_KP = 3,
+    ANIM_PID_KI = 4,
+    ANIM_PID_KD = 5,
+    USE_SERIAL_CONTROL = 6,
+    SHOW_PROFILER_HUD = 7
+};
+/// The number of ConfigField ids.
+static constexpr uint8_t CONFIG_FIELD_COUNT = 8;
+/// The size in bytes of the largest field value.
+static constexpr size_t CONFIG_FIELD_MAX_SIZE = sizeof(float);
+
+/**
+ * @brief Gets the size of a field's value.
+ * @param id A ConfigField id.
+ * @return 4 for a gain, 1 for a switch, or 0 if there is no field with this id.
+ */
+size_t configFieldSize(uint8_t id);
+
+/**
+ * @brief Copies a field's value out of g_config.
+ * @param id A valid ConfigField id.
+ * @param out Receives configFieldSize(id) bytes.
+ */
+void readConfigField(uint8_t id, uint8_t* out);
+
+/**
+ * @brief Sets a field of g_config.
+ * @param id A valid ConfigField id.
+ * @param in configFieldSize(id) bytes. Any nonzero byte turns a switch on.
+ */
+void writeConfigField(uint8_t id, const uint8_t* in);
 /** @} */
\ No newline at end of file
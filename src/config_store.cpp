@@ -0,0 +1,118 @@
+/**
+ * @file config_store.cpp
+ * @brief Implements the settings store and its NVS backend.
+ */
+#include "config_store.hpp"
+#include <Arduino.h>
+#include <string.h>
+#if !defined(RINGUI_SIMULATOR)
+#include <Preferences.h>
+#endif
+
+ConfigStore g_config_store;
+
+// --- PreferencesBackend ---
+
+#if !defined(RINGUI_SIMULATOR)
+size_t PreferencesBackend::read(uint8_t* data, size_t capacity) {
+    Preferences preferences;
+    if (!preferences.begin(CONFIG_NVS_NAMESPACE, true)) return 0;
+    size_t length = preferences.getBytes(CONFIG_NVS_KEY, data, capacity);
+    preferences.end();
+    return length;
+}
+
+bool PreferencesBackend::write(const uint8_t* data, size_t length) {
+    Preferences preferences;
+    if (!preferences.begin(CONFIG_NVS_NAMESPACE, false)) return false;
+    size_t written = preferences.putBytes(CONFIG_NVS_KEY, data, length);
+    preferences.end();
+    return written == length;
+}
+
+ConfigBackend& defaultConfigBackend() {
+    static PreferencesBackend backend;
+    return backend;
+}
+#endif
+
+// --- ConfigStore ---
+
+/**
+ * @brief Loads g_config from a backend.
+ * @details A record of another CONFIG_VERSION is ignored. The values are applied field
+ * by field, so a truncated record still restores the fields before the cut.
+ */
+bool ConfigStore::begin(ConfigBackend& backend) {
+    this->backend = &backend;
+    uint8_t record[RECORD_CAPACITY];
+    size_t length = backend.read(record, sizeof(record));
+    bool loaded = length > 0 && record[0] == CONFIG_VERSION;
+    if (loaded) {
+        for (size_t i = 1; i < length;) {
+            size_t size = configFieldSize(record[i]);
+            if (!size || i + 1 + size > length) break;
+            writeConfigField(record[i], record + i + 1);
+            i += 1 + size;
+        }
+    }
+    // Whatever was not loaded is written with the next change, not now.
+    memcpy(&stored, &g_config, sizeof(AppConfig));
+    memcpy(&observed, &g_config, sizeof(AppConfig));
+    return loaded;
+}
+
+void ConfigStore::poll() {
+    if (!backend) return;
+    uint32_t now = millis();
+    if (memcmp(&observed, &g_config, sizeof(AppConfig)) != 0) {
+        memcpy(&observed, &g_config, sizeof(AppConfig));
+        changed_ms = now;
+        return;
+    }
+    if (now - changed_ms >= CONFIG_COMMIT_DELAY_MS && memcmp(&stored, &g_config, sizeof(AppConfig)) != 0) {
+        commit();
+    }
+}
+
+/**
+ * @brief Gets how long until poll() has something to do.
+ * @details A change poll() has not seen yet is due at once, as seeing it starts the
+ * commit delay.
+ */
+uint32_t ConfigStore::msUntilCommit() const {
+    if (!backend) return UINT32_MAX;
+    if (memcmp(&observed, &g_config, sizeof(AppConfig)) != 0) return 0;
+    if (memcmp(&stored, &g_config, sizeof(AppConfig)) == 0) return UINT32_MAX;
+    uint32_t waited = millis() - changed_ms;
+    return waited >= CONFIG_COMMIT_DELAY_MS ? 0 : CONFIG_COMMIT_DELAY_MS - waited;
+}
+
+void ConfigStore::flush() {
+    if (!backend) return;
+    if (memcmp(&stored, &g_config, sizeof(AppConfig)) != 0) {
+        commit();
+    }
+}
+
+/**
+ * @brief Writes g_config.
+ * @details If the write fails, the stored copy is left as it was, so the next poll()
+ * after another CONFIG_COMMIT_DELAY_MS tries again.
+ */
+void ConfigStore::commit() {
+    uint8_t record[RECORD_CAPACITY];
+    size_t length = 0;
+    record[length++] = CONFIG_VERSION;
+    for (uint8_t id = 0; id < CONFIG_FIELD_COUNT; id++) {
+        record[length++] = id;
+        readConfigField(id, record + length);
+        length += configFieldSize(id);
+    }
+    memcpy(&observed, &g_config, sizeof(AppConfig));
+    changed_ms = millis();
+    if (backend->write(record, length)) {
+        memcpy(&stored, &g_config, sizeof(AppConfig));
+        commit_count++;
+    }
+}
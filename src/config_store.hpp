@@ -0,0 +1,114 @@
+/**
+ * @file config_store.hpp
+ * @brief Defines ConfigStore, which keeps g_config in flash across reboots.
+ * @ingroup Config
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.hpp"
+
+/**
+ * @class ConfigBackend
+ * @brief Stores one settings record, e.g. in NVS. Swapped for a stand-in on the host.
+ * @ingroup Config
+ */
+class ConfigBackend {
+public:
+    virtual ~ConfigBackend() {}
+
+    /**
+     * @brief Reads the stored record.
+     * @param data Receives the record.
+     * @param capacity The size of data.
+     * @return The length of the record, or 0 if none is stored or it does not fit.
+     */
+    virtual size_t read(uint8_t* data, size_t capacity) = 0;
+
+    /**
+     * @brief Replaces the stored record. Each call costs a flash write.
+     * @param data The record.
+     * @param length The length of the record.
+     * @return false if the record could not be stored.
+     */
+    virtual bool write(const uint8_t* data, size_t length) = 0;
+};
+
+#if !defined(RINGUI_SIMULATOR)
+/**
+ * @class PreferencesBackend
+ * @brief Stores the record as one blob in the ESP32's NVS, using the Preferences library.
+ * @ingroup Config
+ */
+class PreferencesBackend : public ConfigBackend {
+public:
+    size_t read(uint8_t* data, size_t capacity) override;
+    bool write(const uint8_t* data, size_t length) override;
+};
+#endif
+
+/**
+ * @brief Gets the backend of this build: NVS on the device, a stand-in in the simulator.
+ * @return The backend, which lives for the whole program.
+ */
+ConfigBackend& defaultConfigBackend();
+
+/**
+ * @class ConfigStore
+ * @brief Loads g_config at boot and writes it back after it changed, coalescing edits.
+ * @ingroup Config
+ *
+ * The store does not need to be told about changes: poll() compares g_config with the
+ * copy it saw on the previous frame, so edits from pages, SWITCH items and remote
+ * commands are all picked up. A change is written once g_config has stayed the same
+ * for CONFIG_COMMIT_DELAY_MS, so scrolling a value through a hundred steps costs one
+ * flash write; flush() writes at once, e.g. when a menu closes.
+ *
+ * The record is a version byte followed by (ConfigField id, value) pairs, as in a
+ * SET_CONFIG payload. Loading it does not depend on the layout of AppConfig: fields the
+ * record lacks keep their defaults, and decoding stops at an id this build does not know.
+ */
+class ConfigStore {
+public:
+    /// The size in bytes of the largest record.
+    static constexpr size_t RECORD_CAPACITY = 1 + CONFIG_FIELD_COUNT * (1 + CONFIG_FIELD_MAX_SIZE);
+
+    /**
+     * @brief Loads g_config from a backend, which later changes are written to.
+     * @param backend The backend, which must outlive the store.
+     * @return true if a record was loaded, false if g_config kept its defaults.
+     */
+    bool begin(ConfigBackend& backend);
+
+    /// @brief Writes g_config if it changed and then stayed the same for CONFIG_COMMIT_DELAY_MS. Called once per frame.
+    void poll();
+
+    /// @brief Writes g_config now if it differs from the stored record.
+    void flush();
+
+    /**
+     * @brief Gets how long until poll() has something to do, so a settled UI knows how long it may sleep.
+     * @return The time in milliseconds, 0 if poll() is due now, or UINT32_MAX if nothing is waiting to be written.
+     */
+    uint32_t msUntilCommit() const;
+
+    /**
+     * @brief Gets the number of records written since begin().
+     * @return The write count.
+     */
+    uint32_t commits() const { return commit_count; }
+
+private:
+    /// Encodes g_config as a record and writes it.
+    void commit();
+
+    ConfigBackend* backend = nullptr; ///< Where the record is stored, or nullptr before begin().
+    AppConfig stored;                 ///< The values the backend holds.
+    AppConfig observed;               ///< g_config as of the previous poll().
+    uint32_t changed_ms = 0;          ///< When poll() last saw g_config change.
+    uint32_t commit_count = 0;        ///< The records written.
+};
+
+/// @brief Global settings store, polled by the UI loop.
+extern ConfigStore g_config_store;
@@ -0,0 +1,118 @@
+/**
+ * @file delegate.hpp
+ * @brief Defines Delegate, a fixed-size callback type that never allocates.
+ * @ingroup MenuSystem
+ */
+#pragma once
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature>
+class Delegate;
+
+/**
+ * @class Delegate
+ * @brief A callable reference stored inline, as a replacement for std::function.
+ * @ingroup MenuSystem
+ *
+ * Holds a function pointer, a function pointer with a `void*` context, or a const-callable
+ * object (e.g. a lambda) of up to CAPACITY bytes. The callable must be trivially copyable,
+ * which covers lambdas that capture pointers, references and plain values. That rules
+ * out capturing a String or a std::vector by value, but it lets a Delegate be copied and
+ * moved with memcpy: copying never allocates and there is nothing to destroy.
+ * Oversized or non-trivial callables are rejected at compile time.
+ * @tparam R The return type.
+ * @tparam Args The argument types.
+ */
+template <typename R, typename... Args>
+class Delegate<R(Args...)> {
+public:
+    /// The inline storage size in bytes: room for two pointers, e.g. a lambda that
+    /// captures `this` and one more value.
+    static constexpr size_t CAPACITY = 2 * sizeof(void*);
+
+    /// A function that receives the context pointer given at construction.
+    using ContextFunction = R (*)(void* context, Args...);
+
+    /// Constructs an empty delegate. constexpr, so that objects holding one can be constant-initialized.
+    constexpr Delegate() : invoker(nullptr), storage() {}
+
+    /// Constructs an empty delegate.
+    constexpr Delegate(std::nullptr_t) : invoker(nullptr), storage() {}
+
+    /**
+     * @brief Wraps a plain function.
+     * @param function The function to call. nullptr makes an empty delegate.
+     */
+    Delegate(R (*function)(Args...)) : invoker(nullptr) {
+        if (function) store(function);
+    }
+
+    /**
+     * @brief Wraps a function that takes a context pointer as its first argument.
+     * @param function The function to call. nullptr makes an empty delegate.
+     * @param context The pointer passed to @p function on every call.
+     */
+    Delegate(ContextFunction function, void* context) : invoker(nullptr) {
+        if (function) store(Bound{function, context});
+    }
+
+    /**
+     * @brief Wraps a callable object, such as a lambda.
+     * @param callable The object to copy into the inline storage.
+     */
+    template <typename F,
+              typename Result = decltype(std::declval<const F&>()(std::declval<Args>()...)),
+              typename = typename std::enable_if<!std::is_same<F, Delegate>::value &&
+                                                 (std::is_void<R>::value || std::is_convertible<Result, R>::value)>::type>
+    Delegate(const F& callable) : invoker(nullptr) {
+        store(callable);
+    }
+
+    /// @brief Checks whether the delegate holds a callable.
+    explicit operator bool() const { return invoker != nullptr; }
+
+    /**
+     * @brief Calls the stored callable. The delegate must not be empty.
+     * @param args The arguments to forward.
+     * @return The callable's result.
+     */
+    R operator()(Args... args) const {
+        return invoker(&storage, std::forward<Args>(args)...);
+    }
+
+private:
+    using Invoker = R (*)(const void* storage, Args...);
+
+    /// A context function and its context.
+    struct Bound {
+        ContextFunction function;
+        void* context;
+        R operator()(Args... args) const { return function(context, std::forward<Args>(args)...); }
+    };
+
+    /// Calls a callable of type F stored in @p storage.
+    template <typename F>
+    static R invoke(const void* storage, Args... args) {
+        return (*static_cast<const F*>(storage))(std::forward<Args>(args)...);
+    }
+
+    /// Copies a callable into the inline storage.
+    template <typename F>
+    void store(const F& callable) {
+        static_assert(sizeof(F) <= CAPACITY, "Callable is too large for a Delegate; capture less or use a context pointer");
+        static_assert(alignof(F) <= alignof(Storage), "Callable is over-aligned for a Delegate");
+        static_assert(std::is_trivially_copyable<F>::value,
+                      "Callable must be trivially copyable; capture pointers instead of objects");
+        ::new (static_cast<void*>(&storage)) F(callable);
+        invoker = &invoke<F>;
+    }
+
+    using Storage = typename std::aligned_storage<CAPACITY, alignof(void*)>::type;
+
+    Invoker invoker; ///< Calls the stored callable, or nullptr if empty.
+    Storage storage; ///< The callable, copied bytewise.
+};
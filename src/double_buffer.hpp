@@ -0,0 +1,115 @@
+/**
+ * @file double_buffer.hpp
+ * @brief Defines DoubleBuffer, which lets a U8g2 driver draw the next frame while the last one is sent.
+ * @ingroup Framebuffer
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <vector>
+#include "frame_transport.hpp"
+
+/**
+ * @class DoubleBuffer
+ * @brief Wraps a U8g2 full-buffer driver with a second framebuffer and a FrameTransport.
+ * @ingroup Framebuffer
+ *
+ * present() hands the finished frame to the transport and points the driver at the other
+ * buffer, so drawing continues while the transport streams the frame out. Before a buffer
+ * is handed to the transport again, the previous transfer is fenced with wait(). With a
+ * synchronous transport no second buffer is allocated and no swap takes place.
+ *
+ * After a swap the driver's buffer holds an older frame, so every frame must be drawn
+ * from scratch, starting with clearBuffer().
+ *
+ * The swap only changes U8g2's tile buffer pointer, so it works with any U8g2 `_F_` driver.
+ * @tparam Driver The U8g2 driver class.
+ */
+template <typename Driver>
+class DoubleBuffer {
+public:
+    /**
+     * @brief Constructs a new DoubleBuffer for a driver.
+     * @param oled The driver whose buffer is wrapped.
+     */
+    explicit DoubleBuffer(Driver& oled) : OLED(oled) {}
+
+    /**
+     * @brief Selects the transport. Must be called after the driver's begin().
+     * @param transport The transport used by present(). It must outlive the DoubleBuffer.
+     */
+    void begin(FrameTransport* transport) {
+        if (this->transport) {
+            settle();
+        }
+        this->transport = transport;
+        if (!primary) {
+            primary = OLED.getBufferPtr();
+        }
+        OLED.getU8g2()->tile_buf_ptr = primary;
+        if (transport->isAsync() && secondary.empty()) {
+            secondary.assign((size_t)OLED.getBufferTileWidth() * OLED.getBufferTileHeight() * 8, 0);
+        }
+    }
+
+    /**
+     * @brief Sends the frame in the driver's buffer and switches drawing to the other buffer.
+     */
+    void present() {
+        unsigned long begin = micros();
+
+        // Fence: the transport must be done with the previous frame before it gets the next.
+        settle();
+
+        uint8_t* finished = OLED.getBufferPtr();
+        transport->start(finished);
+        if (transport->isAsync()) {
+            OLED.getU8g2()->tile_buf_ptr = (finished == primary) ? secondary.data() : primary;
+            in_flight = true;
+        } else {
+            account();
+        }
+
+        report.frames++;
+        report.blocked_us += micros() - begin;
+    }
+
+    /**
+     * @brief Gets the accumulated frame timings.
+     * @details With an asynchronous transport the transfer of the newest frame is not
+     * counted until the next present(), which fences it.
+     * @return The report since the last resetReport().
+     */
+    const FrameTimeReport& frameTimeReport() const { return report; }
+
+    /**
+     * @brief Clears the accumulated frame timings.
+     */
+    void resetReport() { report = FrameTimeReport(); }
+
+private:
+    Driver& OLED;                       ///< The wrapped driver.
+    FrameTransport* transport = nullptr; ///< Sends finished frames.
+    uint8_t* primary = nullptr;         ///< The buffer allocated by the driver.
+    std::vector<uint8_t> secondary;     ///< The second buffer, allocated for asynchronous transports.
+    bool in_flight = false;             ///< True while an asynchronous transfer was not fenced.
+    FrameTimeReport report;             ///< Accumulated timings.
+
+    /// Waits for the pending transfer and accounts for it.
+    void settle() {
+        transport->wait();
+        if (in_flight) {
+            account();
+            in_flight = false;
+        }
+    }
+
+    /// Adds the last completed transfer to the report. Only called once it is fenced, as
+    /// the transport writes its results from the transferring context.
+    void account() {
+        report.transfer_us += transport->lastTransferUs();
+        report.bytes += transport->lastTransferBytes();
+        report.last_frame_bytes = (uint32_t)transport->lastTransferBytes();
+    }
+};
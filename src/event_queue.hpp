@@ -0,0 +1,126 @@
+/**
+ * @file event_queue.hpp
+ * @brief Defines EventQueue, a lock-free single-producer/single-consumer ring buffer.
+ * @ingroup Input
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @class EventQueue
+ * @brief A fixed-size, lock-free ring buffer for passing events from one producer to one consumer.
+ * @ingroup Input
+ *
+ * The producer (typically an interrupt service routine) calls push(), the consumer (the UI
+ * loop) calls pop() or drain(). Neither side blocks or masks interrupts: the head index is
+ * only written by the producer and the tail index only by the consumer, and each publishes
+ * its progress with release/acquire ordering. This header has no Arduino dependencies so
+ * the queue can be exercised on a host.
+ *
+ * @tparam T The event type. It is copied in and out of the buffer.
+ * @tparam Capacity The number of slots. Must be a power of two; one slot is kept free.
+ */
+template <typename T, size_t Capacity>
+class EventQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    EventQueue() : head(0), tail(0), overflows(0) {}
+
+    /**
+     * @brief Appends an event. Must only be called from the single producer.
+     * @param event The event to append.
+     * @return true if the event was queued, false if the queue was full and it was dropped.
+     */
+    bool push(const T& event) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t next = (h + 1) & MASK;
+        if (next == tail.load(std::memory_order_acquire)) {
+            overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[h] = event;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest event. Must only be called from the single consumer.
+     * @param event Receives the removed event.
+     * @return true if an event was removed, false if the queue was empty.
+     */
+    bool pop(T& event) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        event = slots[t];
+        tail.store((t + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Copies the oldest event without removing it. Must only be called from the single consumer.
+     * @param event Receives the oldest event.
+     * @return true if an event was copied, false if the queue was empty.
+     */
+    bool peek(T& event) const {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        event = slots[t];
+        return true;
+    }
+
+    /**
+     * @brief Removes and handles queued events in order. Must only be called from the single consumer.
+     * @param handler A callable taking `const T&` and returning true to stop draining.
+     * The event passed to a handler that returns true is consumed; later events stay queued.
+     * @return true if the handler stopped the drain, false if the queue was emptied.
+     */
+    template <typename Handler>
+    bool drain(Handler handler) {
+        T event;
+        while (pop(event)) {
+            if (handler(event)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Discards all queued events. Must only be called from the single consumer.
+     */
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief Checks whether the queue holds no events.
+     * @return true if there is nothing to pop.
+     */
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Gets the number of events dropped because the queue was full.
+     * @return The overflow count since construction.
+     */
+    uint32_t overflowCount() const {
+        return overflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    T slots[Capacity];             ///< Event storage.
+    std::atomic<size_t> head;      ///< Next slot to write; owned by the producer.
+    std::atomic<size_t> tail;      ///< Next slot to read; owned by the consumer.
+    std::atomic<uint32_t> overflows; ///< Number of events dropped on a full queue.
+};
@@ -0,0 +1,114 @@
+/**
+ * @file fixed.hpp
+ * @brief Defines Fixed16, a Q16.16 fixed-point number type for the animation math.
+ * @ingroup PID
+ */
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @class Fixed16
+ * @brief A signed Q16.16 fixed-point number.
+ * @ingroup PID
+ *
+ * Covers roughly ±32768 with a resolution of 1/65536, which is plenty for pixel
+ * positions and PID terms on a 128x32 screen. Multiplication and division use a 64-bit
+ * intermediate, and everything else is plain integer arithmetic, so no floating-point
+ * instructions (or software double emulation) are involved after construction.
+ */
+class Fixed16 {
+public:
+    /// The number of fractional bits.
+    static constexpr int FRACTION_BITS = 16;
+    /// The raw value of 1.0.
+    static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+    constexpr Fixed16() : raw_value(0) {}
+    constexpr Fixed16(int value) : raw_value(value * ONE) {}
+    constexpr Fixed16(float value) : raw_value((int32_t)(value * ONE + (value >= 0 ? 0.5f : -0.5f))) {}
+    constexpr Fixed16(double value) : raw_value((int32_t)(value * ONE + (value >= 0 ? 0.5 : -0.5))) {}
+
+    /**
+     * @brief Creates a value from its raw Q16.16 representation.
+     * @param raw The raw value.
+     * @return The fixed-point number.
+     */
+    static constexpr Fixed16 fromRaw(int32_t raw) { return Fixed16(raw, RawTag()); }
+
+    /// @brief Gets the raw Q16.16 representation.
+    constexpr int32_t raw() const { return raw_value; }
+
+    /// @brief Converts to float.
+    constexpr float toFloat() const { return (float)raw_value / ONE; }
+
+    /// @brief Rounds to the nearest integer, with halves rounded up.
+    constexpr int round() const { return (raw_value + ONE / 2) >> FRACTION_BITS; }
+
+    constexpr Fixed16 operator-() const { return fromRaw(-raw_value); }
+    constexpr Fixed16 operator+(Fixed16 o) const { return fromRaw(raw_value + o.raw_value); }
+    constexpr Fixed16 operator-(Fixed16 o) const { return fromRaw(raw_value - o.raw_value); }
+    constexpr Fixed16 operator*(Fixed16 o) const {
+        return fromRaw((int32_t)(((int64_t)raw_value * o.raw_value) >> FRACTION_BITS));
+    }
+    constexpr Fixed16 operator/(Fixed16 o) const {
+        return fromRaw((int32_t)(((int64_t)raw_value * ONE) / o.raw_value));
+    }
+
+    Fixed16& operator+=(Fixed16 o) { raw_value += o.raw_value; return *this; }
+    Fixed16& operator-=(Fixed16 o) { raw_value -= o.raw_value; return *this; }
+    Fixed16& operator*=(Fixed16 o) { return *this = *this * o; }
+    Fixed16& operator/=(Fixed16 o) { return *this = *this / o; }
+
+    constexpr bool operator==(Fixed16 o) const { return raw_value == o.raw_value; }
+    constexpr bool operator!=(Fixed16 o) const { return raw_value != o.raw_value; }
+    constexpr bool operator<(Fixed16 o) const { return raw_value < o.raw_value; }
+    constexpr bool operator>(Fixed16 o) const { return raw_value > o.raw_value; }
+    constexpr bool operator<=(Fixed16 o) const { return raw_value <= o.raw_value; }
+    constexpr bool operator>=(Fixed16 o) const { return raw_value >= o.raw_value; }
+
+private:
+    struct RawTag {};
+    constexpr Fixed16(int32_t raw, RawTag) : raw_value(raw) {}
+
+    int32_t raw_value; ///< The value multiplied by 2^16.
+};
+
+/**
+ * @brief Converts an animation value to float.
+ * @ingroup PID
+ */
+inline float toFloat(float value) { return value; }
+/// @copydoc toFloat(float)
+inline float toFloat(double value) { return (float)value; }
+/// @copydoc toFloat(float)
+inline float toFloat(Fixed16 value) { return value.toFloat(); }
+
+/**
+ * @brief Converts the ratio of two integers to an animation value.
+ * @ingroup PID
+ *
+ * The Fixed16 specialization divides in integers, so e.g. a frame time in microseconds
+ * becomes an animation step without any floating-point math.
+ * @tparam T The animation number type.
+ * @param numerator The numerator.
+ * @param denominator The denominator, not 0.
+ */
+template <typename T>
+inline T fromRatio(uint32_t numerator, uint32_t denominator) { return (T)numerator / (T)denominator; }
+/// @copydoc fromRatio
+template <>
+inline Fixed16 fromRatio<Fixed16>(uint32_t numerator, uint32_t denominator) {
+    return Fixed16::fromRaw((int32_t)(((uint64_t)numerator << Fixed16::FRACTION_BITS) / denominator));
+}
+
+/**
+ * @brief Rounds an animation value to the nearest integer pixel, with halves rounded up.
+ * @ingroup PID
+ */
+inline int roundToInt(float value) { return (int)floorf(value + 0.5f); }
+/// @copydoc roundToInt(float)
+inline int roundToInt(double value) { return (int)floor(value + 0.5); }
+/// @copydoc roundToInt(float)
+inline int roundToInt(Fixed16 value) { return value.round(); }
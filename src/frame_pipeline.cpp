@@ -0,0 +1,55 @@
+/**
+ * @file frame_pipeline.cpp
+ * @brief Implements the FramePipeline class.
+ */
+#include "frame_pipeline.hpp"
+#include "config.hpp"
+
+FramePipeline::FramePipeline()
+    : frame(nullptr), in_flight(false) {}
+
+bool FramePipeline::begin(Transfer transfer, int core) {
+    if (task.running()) return false;
+    this->transfer = transfer;
+    return task.start(taskEntry, this, "ringui_render", core, RENDER_TASK_PRIORITY, RENDER_TASK_STACK_SIZE);
+}
+
+bool FramePipeline::running() const {
+    return task.running();
+}
+
+void FramePipeline::start(const uint8_t* frame) {
+    wait();
+    this->frame = frame;
+    in_flight = true;
+    frame_ready.give();
+}
+
+void FramePipeline::wait() {
+    if (in_flight) {
+        frame_done.take();
+        in_flight = false;
+    }
+}
+
+void FramePipeline::taskEntry(void* arg) {
+    static_cast<FramePipeline*>(arg)->run();
+}
+
+/**
+ * @brief The body of the render task: waits for frames and transfers them.
+ * @details The signals order the accesses to `frame`, `last_transfer_us` and
+ * `last_transfer_bytes`: the UI task only writes `frame` after frame_done was taken, and
+ * only reads the other two after the same fence.
+ */
+void FramePipeline::run() {
+    while (true) {
+        frame_ready.take();
+
+        unsigned long begin = micros();
+        last_transfer_bytes = transfer(frame);
+        last_transfer_us = micros() - begin;
+
+        frame_done.give();
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file frame_pipeline.hpp
+ * @brief Defines FramePipeline, which transfers finished frames to the display from a dedicated task.
+ * @ingroup Framebuffer
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "frame_transport.hpp"
+#include "rtos.hpp"
+
+/**
+ * @class FramePipeline
+ * @brief An asynchronous FrameTransport that sends frames from a dedicated render task.
+ * @ingroup Framebuffer
+ *
+ * start() only hands the frame to the render task and returns, so the blocking bus
+ * transfer runs on another core while the UI loop handles input and draws the next frame
+ * into the other half of a DoubleBuffer. wait() is the fence that blocks until the render
+ * task is done with the frame.
+ *
+ * The render task only sends finished frames; composing them stays with the caller.
+ */
+class FramePipeline : public FrameTransport {
+public:
+    FramePipeline();
+
+    /**
+     * @brief Starts the render task.
+     * @param transfer The function that sends a frame to the display.
+     * @param core The CPU core to pin the render task to, or -1 for any core.
+     * @return true if the render task was started.
+     */
+    bool begin(Transfer transfer, int core);
+
+    /**
+     * @brief Checks whether the render task is running.
+     * @return true if begin() succeeded.
+     */
+    bool running() const;
+
+    void start(const uint8_t* frame) override;
+    void wait() override;
+    bool isAsync() const override { return true; }
+
+private:
+    /// The entry point of the render task.
+    static void taskEntry(void* arg);
+    /// The body of the render task: waits for frames and transfers them.
+    void run();
+
+    Transfer transfer;       ///< The function that sends a frame to the display.
+    const uint8_t* frame;    ///< The frame being sent. Only changed while no transfer is in flight.
+    bool in_flight;          ///< True between start() and the matching wait(). UI task only.
+    Signal frame_ready;      ///< Wakes the render task when a frame is started.
+    Signal frame_done;       ///< Given by the render task when the transfer is complete.
+    Task task;               ///< The render task.
+};
@@ -0,0 +1,89 @@
+/**
+ * @file frame_scheduler.cpp
+ * @brief Implements the FrameScheduler class.
+ */
+#include "frame_scheduler.hpp"
+#include "config.hpp"
+#include <Arduino.h>
+
+FrameScheduler::FrameScheduler(uint32_t target_fps)
+    : period_us(0), frame_start(0), started(false), missed(0), last_frame_us(0) {
+    setTargetFps(target_fps);
+}
+
+void FrameScheduler::setTargetFps(uint32_t target_fps) {
+    if (target_fps < 1) target_fps = 1;
+    period_us = 1000000UL / target_fps;
+}
+
+uint32_t FrameScheduler::targetFps() const {
+    return 1000000UL / period_us;
+}
+
+void FrameScheduler::reset() {
+    started = false;
+}
+
+/// The duration of one animation step in microseconds.
+static constexpr uint32_t ANIMATION_STEP_US = (uint32_t)(ANIMATION_REFERENCE_MS * 1000);
+/// The longest frame time turned into animation steps, in microseconds.
+static constexpr uint32_t MAX_ANIMATION_US = (uint32_t)(MAX_ANIMATION_STEPS * ANIMATION_REFERENCE_MS * 1000);
+
+/**
+ * @brief Marks the start of a frame.
+ * @details Long stalls are clamped to MAX_ANIMATION_STEPS, because a single large step
+ * makes the PID animations overshoot. The clamp and the division are done on the integer
+ * microseconds, and only the result is an AnimValue.
+ */
+AnimValue FrameScheduler::beginFrame() {
+    uint32_t now = micros();
+    uint32_t elapsed_us = ANIMATION_STEP_US;
+    if (started) {
+        elapsed_us = now - frame_start;
+        if (elapsed_us > MAX_ANIMATION_US) elapsed_us = MAX_ANIMATION_US;
+    }
+    frame_start = now;
+    started = true;
+    return fromRatio<AnimValue>(elapsed_us, ANIMATION_STEP_US);
+}
+
+void FrameScheduler::endFrame() {
+    uint32_t busy = micros() - frame_start;
+    last_frame_us = busy;
+    if (busy >= period_us) {
+        missed++;
+        return;
+    }
+    // delay() yields to the scheduler instead of spinning; rounding to whole milliseconds
+    // is harmless because the next beginFrame() measures the real elapsed time.
+    uint32_t remaining_ms = (period_us - busy + 500) / 1000;
+    if (remaining_ms > 0) {
+        delay(remaining_ms);
+    }
+}
+
+/**
+ * @brief Sleeps until a signal is given or a timeout passes.
+ * @details In the simulator, virtual time only advances in delay(), which is also where
+ * the scripted input arrives, so the wait is taken in frame periods with the signal
+ * checked after each; the frames are then the same as those of a loop that never idles.
+ */
+void FrameScheduler::idle(Signal& wake, uint32_t timeout_ms) {
+#if defined(RINGUI_SIMULATOR)
+    uint32_t period_ms = period_us < 1000 ? 1 : (period_us + 500) / 1000;
+    for (uint32_t waited = 0; !wake.take(0) && waited < timeout_ms; waited += period_ms) {
+        delay(period_ms);
+    }
+#else
+    wake.take(timeout_ms);
+#endif
+    started = false;
+}
+
+uint32_t FrameScheduler::missedDeadlines() const {
+    return missed;
+}
+
+uint32_t FrameScheduler::lastFrameUs() const {
+    return last_frame_us;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file frame_scheduler.hpp
+ * @brief Defines the FrameScheduler class, which paces the UI loops to a target frame rate.
+ * @ingroup UI
+ */
+#pragma once
+
+#include <stdint.h>
+#include "pid.hpp"
+#include "rtos.hpp"
+
+/**
+ * @class FrameScheduler
+ * @brief Paces a render loop to a target frame rate and measures the real frame time.
+ * @ingroup UI
+ *
+ * Each loop iteration calls beginFrame(), which returns the time elapsed since the previous
+ * frame as a multiple of ANIMATION_REFERENCE_MS, and endFrame(), which sleeps only for what
+ * is left of the frame period. Animations scale their step by the returned value, so motion
+ * speed does not depend on how long drawing and the display transfer take. The step is an
+ * AnimValue, so with RINGUI_FIXED_POINT the frame timing involves no floating-point math.
+ */
+class FrameScheduler {
+public:
+    /**
+     * @brief Constructs a new FrameScheduler.
+     * @param target_fps The frame rate to aim for.
+     */
+    explicit FrameScheduler(uint32_t target_fps);
+
+    /**
+     * @brief Changes the target frame rate.
+     * @param target_fps The new frame rate. Values below 1 are treated as 1.
+     */
+    void setTargetFps(uint32_t target_fps);
+
+    /**
+     * @brief Gets the target frame rate.
+     * @return The frame rate in frames per second.
+     */
+    uint32_t targetFps() const;
+
+    /**
+     * @brief Restarts timing, so the next beginFrame() returns a single nominal step.
+     *
+     * Call this before entering a loop, so time spent outside of it (e.g. in a callback)
+     * does not turn into a jump of the animation.
+     */
+    void reset();
+
+    /**
+     * @brief Marks the start of a frame.
+     * @return The elapsed time since the previous frame in animation steps of
+     * ANIMATION_REFERENCE_MS, clamped to MAX_ANIMATION_STEPS.
+     */
+    AnimValue beginFrame();
+
+    /**
+     * @brief Marks the end of a frame and sleeps for the rest of the frame period.
+     *
+     * If the frame took longer than the period, it returns immediately and counts a
+     * missed deadline.
+     */
+    void endFrame();
+
+    /**
+     * @brief Sleeps past the frame period until a signal is given or a timeout passes.
+     *
+     * For a loop with nothing to animate or draw: call it after endFrame(), and the
+     * loop sleeps until there is input instead of waking every frame period. Timing
+     * restarts as with reset(), so the wait does not turn into an animation step.
+     * @param wake The signal that ends the wait, e.g. g_input_signal.
+     * @param timeout_ms The longest wait in milliseconds, or Signal::WAIT_FOREVER.
+     */
+    void idle(Signal& wake, uint32_t timeout_ms);
+
+    /**
+     * @brief Gets the number of frames that overran the frame period.
+     * @return The number of missed deadlines since construction.
+     */
+    uint32_t missedDeadlines() const;
+
+    /**
+     * @brief Gets the busy time of the last completed frame, excluding the sleep.
+     * @return The time from beginFrame() to endFrame() in microseconds.
+     */
+    uint32_t lastFrameUs() const;
+
+private:
+    uint32_t period_us;      ///< The target frame period.
+    uint32_t frame_start;    ///< micros() at the last beginFrame().
+    bool started;            ///< False until the first beginFrame() after reset().
+    uint32_t missed;         ///< The number of missed deadlines.
+    uint32_t last_frame_us;  ///< The busy time of the last frame.
+};
@@ -0,0 +1,30 @@
+/**
+ * @file frame_transport.cpp
+ * @brief Implements the synchronous frame transport and the frame-time report.
+ */
+#include "frame_transport.hpp"
+
+void FrameTimeReport::print(Print& out) const {
+    if (frames == 0) {
+        out.println("frames: 0");
+        return;
+    }
+    out.print("frames: ");
+    out.println((unsigned long)frames);
+    out.print("avg transfer us: ");
+    out.println((unsigned long)(transfer_us / frames));
+    out.print("avg blocked us: ");
+    out.println((unsigned long)(blocked_us / frames));
+    out.print("avg bytes: ");
+    out.println((unsigned long)(bytes / frames));
+    out.print("recovered us/frame: ");
+    out.println((unsigned long)(recoveredUs() / frames));
+}
+
+SyncTransport::SyncTransport(Transfer transfer) : transfer(transfer) {}
+
+void SyncTransport::start(const uint8_t* frame) {
+    unsigned long begin = micros();
+    last_transfer_bytes = transfer(frame);
+    last_transfer_us = micros() - begin;
+}
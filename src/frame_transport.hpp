@@ -0,0 +1,108 @@
+/**
+ * @file frame_transport.hpp
+ * @brief Defines the FrameTransport interface for sending finished frames to the display.
+ * @ingroup Framebuffer
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <functional>
+
+/**
+ * @struct FrameTimeReport
+ * @brief Accumulated timings of the frames handed to a transport.
+ * @ingroup Framebuffer
+ */
+struct FrameTimeReport {
+    uint32_t frames = 0;           ///< The number of frames presented.
+    uint64_t transfer_us = 0;      ///< Total time spent sending frames to the display.
+    uint64_t blocked_us = 0;       ///< Total time the UI loop was blocked while presenting.
+    uint64_t bytes = 0;            ///< Total framebuffer bytes sent by the completed transfers.
+    uint32_t last_frame_bytes = 0; ///< The bytes sent by the newest completed transfer.
+
+    /**
+     * @brief Gets the transfer time the UI loop did not have to wait for.
+     * @return The recovered CPU time in microseconds.
+     */
+    uint64_t recoveredUs() const { return transfer_us > blocked_us ? transfer_us - blocked_us : 0; }
+
+    /**
+     * @brief Prints the per-frame averages and the recovered CPU time.
+     * @param out The stream to print to, e.g. Serial.
+     */
+    void print(Print& out) const;
+};
+
+/**
+ * @class FrameTransport
+ * @brief Sends finished frames to the display, possibly asynchronously.
+ * @ingroup Framebuffer
+ *
+ * A frame passed to start() must not be modified until wait() has returned, which acts
+ * as the completion fence before the buffer is drawn into again.
+ */
+class FrameTransport {
+public:
+    /// Sends a complete frame to the display and returns the framebuffer bytes it sent.
+    /// Runs wherever the transport performs the transfer.
+    using Transfer = std::function<size_t(const uint8_t* frame)>;
+
+    virtual ~FrameTransport() = default;
+
+    /**
+     * @brief Starts sending a frame. Must only be called after wait().
+     * @param frame The frame to send. It must stay unchanged until wait() returns.
+     */
+    virtual void start(const uint8_t* frame) = 0;
+
+    /**
+     * @brief Blocks until the frame passed to the last start() has been sent.
+     */
+    virtual void wait() = 0;
+
+    /**
+     * @brief Checks whether start() returns before the frame is sent.
+     * @return true if the transport transfers in the background.
+     */
+    virtual bool isAsync() const = 0;
+
+    /**
+     * @brief Gets the duration of the last completed transfer. Only valid after wait().
+     * @return The transfer time in microseconds.
+     */
+    uint32_t lastTransferUs() const { return last_transfer_us; }
+
+    /**
+     * @brief Gets the framebuffer bytes sent by the last completed transfer. Only valid after wait().
+     * @return The byte count.
+     */
+    size_t lastTransferBytes() const { return last_transfer_bytes; }
+
+protected:
+    /// Duration of the last completed transfer, written by the transferring context.
+    uint32_t last_transfer_us = 0;
+    /// Bytes sent by the last completed transfer, written by the transferring context.
+    size_t last_transfer_bytes = 0;
+};
+
+/**
+ * @class SyncTransport
+ * @brief A FrameTransport that sends the frame inside start(), blocking the caller.
+ * @ingroup Framebuffer
+ */
+class SyncTransport : public FrameTransport {
+public:
+    /**
+     * @brief Constructs a new SyncTransport.
+     * @param transfer The function that sends a frame to the display.
+     */
+    explicit SyncTransport(Transfer transfer);
+
+    void start(const uint8_t* frame) override;
+    void wait() override {}
+    bool isAsync() const override { return false; }
+
+private:
+    Transfer transfer; ///< The function that sends a frame to the display.
+};
@@ -0,0 +1,79 @@
+/**
+ * @file framebuffer.cpp
+ * @brief Implements the FrameDiff class.
+ */
+#include "framebuffer.hpp"
+#include <string.h>
+
+/// The number of bytes in a single 8x8 pixel tile.
+static constexpr size_t TILE_BYTES = 8;
+
+FrameDiff::FrameDiff()
+    : tile_width(0), tile_height(0), valid(false), dirty_bytes(0) {}
+
+void FrameDiff::begin(uint8_t tile_width, uint8_t tile_height) {
+    this->tile_width = tile_width;
+    this->tile_height = tile_height;
+    shadow.assign((size_t)tile_width * tile_height * TILE_BYTES, 0);
+    spans.clear();
+    spans.reserve(tile_height);
+    dirty_bytes = 0;
+    valid = false;
+}
+
+/**
+ * @brief Compares a new frame against the shadow copy and records the dirty spans.
+ * @details Each tile row produces at most one span, from its first to its last changed
+ * tile. Sending a few unchanged tiles in between is cheaper than the addressing overhead
+ * of starting a separate I2C transaction for every changed tile.
+ */
+int FrameDiff::update(const uint8_t* buffer) {
+    spans.clear();
+    dirty_bytes = 0;
+    if (!buffer || shadow.empty()) return 0;
+
+    const size_t row_bytes = (size_t)tile_width * TILE_BYTES;
+    for (uint8_t ty = 0; ty < tile_height; ty++) {
+        const uint8_t* row = buffer + ty * row_bytes;
+        uint8_t* shadow_row = shadow.data() + ty * row_bytes;
+
+        int first = -1, last = -1;
+        if (!valid) {
+            first = 0;
+            last = tile_width - 1;
+        } else {
+            for (int tx = 0; tx < tile_width; tx++) {
+                if (memcmp(row + tx * TILE_BYTES, shadow_row + tx * TILE_BYTES, TILE_BYTES) != 0) {
+                    if (first < 0) first = tx;
+                    last = tx;
+                }
+            }
+        }
+
+        if (first >= 0) {
+            Span span = { (uint8_t)first, ty, (uint8_t)(last - first + 1) };
+            spans.push_back(span);
+            memcpy(shadow_row + first * TILE_BYTES, row + first * TILE_BYTES, span.width * TILE_BYTES);
+            dirty_bytes += span.width * TILE_BYTES;
+        }
+    }
+
+    valid = true;
+    return spans.size();
+}
+
+void FrameDiff::invalidate() {
+    valid = false;
+}
+
+int FrameDiff::spanCount() const {
+    return spans.size();
+}
+
+const FrameDiff::Span& FrameDiff::span(int index) const {
+    return spans[index];
+}
+
+size_t FrameDiff::dirtyBytes() const {
+    return dirty_bytes;
+}
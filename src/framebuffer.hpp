@@ -0,0 +1,88 @@
+/**
+ * @file framebuffer.hpp
+ * @brief Defines the FrameDiff class used to push only changed display tiles.
+ * @defgroup Framebuffer
+ * @{
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * @class FrameDiff
+ * @brief Tracks which 8x8 tiles of a U8g2 full framebuffer changed since the last transfer.
+ * @ingroup Framebuffer
+ *
+ * U8g2 full-buffer drivers store the screen as rows of 8x8 pixel tiles, 8 bytes per tile.
+ * FrameDiff keeps a shadow copy of the last transferred frame and, for every tile row,
+ * reports the horizontal span that covers all tiles that differ from it. The controller
+ * then sends only these spans with `u8x8_DrawTile()`, read from the frame being
+ * transferred rather than the driver's current buffer, and skips the bus transfer
+ * completely when nothing changed.
+ */
+class FrameDiff {
+public:
+    /**
+     * @struct Span
+     * @brief A horizontal run of tiles within a single tile row that must be transferred.
+     */
+    struct Span {
+        uint8_t x;     ///< The first tile column of the span.
+        uint8_t y;     ///< The tile row of the span.
+        uint8_t width; ///< The number of tiles in the span.
+    };
+
+    FrameDiff();
+
+    /**
+     * @brief Allocates the shadow buffer for a framebuffer of the given tile dimensions.
+     * @param tile_width The width of the framebuffer in tiles (e.g. 16 for 128 px).
+     * @param tile_height The height of the framebuffer in tiles (e.g. 4 for 32 px).
+     */
+    void begin(uint8_t tile_width, uint8_t tile_height);
+
+    /**
+     * @brief Compares a new frame against the shadow copy and records the dirty spans.
+     *
+     * The shadow copy is updated to the new frame, so the caller must transfer every
+     * reported span before the next call.
+     * @param buffer The framebuffer to compare, in U8g2 tile layout.
+     * @return The number of dirty spans (0 if the frame is unchanged).
+     */
+    int update(const uint8_t* buffer);
+
+    /**
+     * @brief Forces the next update() to report the whole frame as dirty.
+     */
+    void invalidate();
+
+    /**
+     * @brief Gets the number of dirty spans found by the last update().
+     * @return The number of spans.
+     */
+    int spanCount() const;
+
+    /**
+     * @brief Gets a dirty span found by the last update().
+     * @param index The index of the span, between 0 and spanCount() - 1.
+     * @return A reference to the span.
+     */
+    const Span& span(int index) const;
+
+    /**
+     * @brief Gets the number of framebuffer bytes covered by the last update()'s spans.
+     * @return The number of bytes that must be sent over the bus.
+     */
+    size_t dirtyBytes() const;
+
+private:
+    uint8_t tile_width;  ///< Framebuffer width in tiles.
+    uint8_t tile_height; ///< Framebuffer height in tiles.
+    bool valid;          ///< False if the shadow copy does not reflect the display contents.
+    size_t dirty_bytes;  ///< Bytes covered by the spans of the last update.
+    std::vector<uint8_t> shadow; ///< Copy of the last transferred frame.
+    std::vector<Span> spans;     ///< Dirty spans of the last update, at most one per tile row.
+};
+/** @} */
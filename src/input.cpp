@@ -1,129 +1,286 @@
 /**
  * @file input.cpp
- * @brief Implements the RotaryEncoder class and other input helpers.
+ * @brief Implements the input event queue, the RotaryEncoder class and other input helpers.
  */
 #include "input.hpp"
 #include "config.hpp"
+#if defined(RINGUI_ENCODER_PCNT)
+#include <driver/pcnt.h>
+
+/// The pulse counter unit the encoder uses.
+static constexpr pcnt_unit_t ENCODER_PCNT_UNIT = PCNT_UNIT_0;
+/// The count at which the pulse counter restarts from 0. Any value works: CounterDetents
+/// unwraps the restart and carries partial detents over it.
+static constexpr int16_t ENCODER_PCNT_LIMIT = 32000;
+#endif
+#if !defined(RINGUI_SIMULATOR)
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#endif
+
+InputQueue g_input;
+InputQueue g_ui_input;
+Signal g_input_signal;
 
 RotaryEncoder* RotaryEncoder::instance = nullptr;
 
 // Global encoder object. Using 4 pulses per detent is common for EC11 encoders.
 RotaryEncoder g_encoder(PIN_ENCODER_A, PIN_ENCODER_B, PIN_ENCODER_BUTTON, 4);
 
-RotaryEncoder::RotaryEncoder(int pinA, int pinB, int pinButton, int pulsesPerDetent) 
-    : _pinA(pinA), _pinB(pinB), _pinButton(pinButton), _pulsesPerDetent(pulsesPerDetent) {
+// The cancel button is wired to VCC and uses the internal pull-down.
+Button g_cancel_button(PIN_CANCEL, HIGH, InputEventType::CANCEL);
+
+// --- Acceleration Implementation ---
+
+int AccelerationCurve::stepsAt(uint32_t interval_ms) const {
+    if (interval_ms >= slow_interval_ms) return 1;
+    if (interval_ms <= fast_interval_ms) return max_steps;
+    float speed = (float)(slow_interval_ms - interval_ms) / (slow_interval_ms - fast_interval_ms);
+    return 1 + (int)((max_steps - 1) * speed * speed + 0.5f);
+}
+
+void DetentAccelerator::setCurve(const AccelerationCurve* curve) {
+    this->curve = curve;
+    last_direction = 0;
+}
+
+/**
+ * @brief Gets the steps of an event and updates the speed.
+ * @details The average halves the weight of older gaps with every detent, so a spin
+ * reaches its speed within three or four detents and slows down as quickly.
+ */
+int DetentAccelerator::steps(const InputEvent& event) {
+    int direction;
+    if (event.type == InputEventType::DETENT_CW) {
+        direction = 1;
+    } else if (event.type == InputEventType::DETENT_CCW) {
+        direction = -1;
+    } else {
+        return 0;
+    }
+    if (!curve) return direction;
+
+    uint32_t gap = event.timestamp - last_ms;
+    if (direction != last_direction || gap >= curve->slow_interval_ms) {
+        // The first detent of a spin.
+        last_ms = event.timestamp;
+        last_direction = direction;
+        interval_ms = curve->slow_interval_ms;
+        return direction;
+    }
+    if (gap == 0) return direction;
+    last_ms = event.timestamp;
+    interval_ms = (interval_ms + gap) / 2;
+    return direction * curve->stepsAt(interval_ms);
+}
+
+// --- Button Implementation ---
+
+Button::Button(int pin, int activeLevel, InputEventType pressEvent, InputEventType releaseEvent)
+    : _pin(pin), _activeLevel(activeLevel), _pressEvent(pressEvent), _releaseEvent(releaseEvent),
+      _stableLevel(activeLevel == HIGH ? LOW : HIGH) {}
+
+void Button::begin() {
+    pinMode(_pin, _activeLevel == HIGH ? INPUT_PULLDOWN : INPUT_PULLUP);
+    _stableLevel = digitalRead(_pin);
+    attachInterruptArg(digitalPinToInterrupt(_pin), isr, this, CHANGE);
+}
+
+void IRAM_ATTR Button::isr(void* arg) {
+    Button* button = static_cast<Button*>(arg);
+    button->onEdge(digitalRead(button->_pin), millis());
+    g_input_signal.giveFromIsr();
+}
+
+/**
+ * @brief Processes a level change of the button pin.
+ * @details Edges closer than BUTTON_DEBOUNCE_MS to the last accepted edge are treated as
+ * contact bounce. The interrupt fires on every change, so reading the already accepted
+ * level again after the debounce window means a short release/press pair was swallowed
+ * by the filter; both edges are queued so that the press is not lost.
+ */
+void IRAM_ATTR Button::onEdge(int level, uint32_t now) {
+    if (now - _lastEdge < BUTTON_DEBOUNCE_MS) {
+        return;
+    }
+
+    bool pressed = (level == _activeLevel);
+    if (level == _stableLevel) {
+        InputEventType missed = pressed ? _releaseEvent : _pressEvent;
+        if (missed != InputEventType::NONE) {
+            g_input.push({ missed, now });
+        }
+    }
+
+    InputEventType type = pressed ? _pressEvent : _releaseEvent;
+    if (type != InputEventType::NONE) {
+        g_input.push({ type, now });
+    }
+    _stableLevel = level;
+    _lastEdge = now;
+}
+
+// --- RotaryEncoder Implementation ---
+
+RotaryEncoder::RotaryEncoder(int pinA, int pinB, int pinButton, int pulsesPerDetent)
+    : _pinA(pinA), _pinB(pinB), _pulsesPerDetent(pulsesPerDetent),
+      _button(pinButton, LOW, InputEventType::PRESS, InputEventType::RELEASE),
+      _decoder(pulsesPerDetent, ENCODER_GLITCH_FILTER_US)
+#if defined(RINGUI_ENCODER_PCNT)
+      , _counterDetents(pulsesPerDetent, ENCODER_PCNT_LIMIT)
+#endif
+{
     instance = this;
 }
 
 void RotaryEncoder::begin() {
     pinMode(_pinA, INPUT_PULLUP);
     pinMode(_pinB, INPUT_PULLUP);
-    pinMode(_pinButton, INPUT_PULLUP);
-
-    // Read the initial state of the encoder pins to prevent missing the first turn.
-    int msb = digitalRead(_pinA);
-    int lsb = digitalRead(_pinB);
-    _lastEncoded = (msb << 1) | lsb;
-
+#if defined(RINGUI_ENCODER_PCNT)
+    beginCounter();
+#else
+    // Start from the current state to prevent missing the first turn.
+    _decoder.reset(readPins());
     attachInterrupt(digitalPinToInterrupt(_pinA), readEncoder, CHANGE);
     attachInterrupt(digitalPinToInterrupt(_pinB), readEncoder, CHANGE);
+#endif
+    _button.begin();
+}
+
+void IRAM_ATTR RotaryEncoder::readEncoder() {
+    instance->onPinChange(instance->readPins(), micros());
+    // Also when no detent completed: the new state is counted by a poll() after the glitch filter time.
+    g_input_signal.giveFromIsr();
 }
 
 /**
- * @brief This ISR reads the encoder state and determines the direction of rotation.
- * @details It uses a state machine lookup table implemented with the 'sum' variable to
- * decode the quadrature signal. This method is designed to be fast and efficient
- * for execution within an interrupt context.
+ * @brief Reads both pins as `(A << 1) | B`.
+ * @details On the device, both levels come from the GPIO input register rather than two
+ * digitalRead() calls, so A and B are sampled at the same instant. Pins 32 and up are
+ * in a second register, read only if one of the pins is there.
  */
-void IRAM_ATTR RotaryEncoder::readEncoder() {
-    int msb = digitalRead(instance->_pinA);
-    int lsb = digitalRead(instance->_pinB);
+uint8_t IRAM_ATTR RotaryEncoder::readPins() const {
+#if defined(RINGUI_SIMULATOR)
+    return (uint8_t)((digitalRead(_pinA) << 1) | digitalRead(_pinB));
+#else
+    uint32_t low = REG_READ(GPIO_IN_REG);
+    uint32_t high = (_pinA >= 32 || _pinB >= 32) ? REG_READ(GPIO_IN1_REG) : 0;
+    uint32_t a = _pinA < 32 ? low >> _pinA : high >> (_pinA - 32);
+    uint32_t b = _pinB < 32 ? low >> _pinB : high >> (_pinB - 32);
+    return (uint8_t)(((a & 1) << 1) | (b & 1));
+#endif
+}
 
-    int encoded = (msb << 1) | lsb;
-    int sum = (instance->_lastEncoded << 2) | encoded;
+void IRAM_ATTR RotaryEncoder::onPinChange(int encoded, uint32_t now_us) {
+    _decoderLock.lockFromIsr();
+    int detents = _decoder.update((uint8_t)encoded, now_us);
+    uint32_t detent_us = _decoder.detentTimeUs();
+    _decoderLock.unlockFromIsr();
+    pushDetents(g_input, detents, detent_us, now_us);
+}
 
-    int increment = 0;
-    if(sum == 0b1101 || sum == 0b0100 || sum == 0b0010 || sum == 0b1011) {
-        increment = 1; // Counter-Clockwise
-    } else if (sum == 0b1110 || sum == 0b0111 || sum == 0b0001 || sum == 0b1000) {
-        increment = -1; // Clockwise
+/**
+ * @brief Queues the detents the decoder returned.
+ * @details The decoder counts a detent only once its last state was held for the glitch
+ * filter time, so it is stamped with when that state was reached, not with now.
+ */
+void IRAM_ATTR RotaryEncoder::pushDetents(InputQueue& queue, int detents, uint32_t detent_us, uint32_t now_us) {
+    if (detents == 0) return;
+    uint32_t timestamp = millis() - (now_us - detent_us) / 1000;
+    InputEventType type = detents > 0 ? InputEventType::DETENT_CW : InputEventType::DETENT_CCW;
+    for (int i = detents > 0 ? detents : -detents; i > 0; i--) {
+        queue.push({ type, timestamp });
     }
+}
 
-    if (increment != 0) {
-        // If the direction of rotation has changed, reset the pulse counter.
-        // This prevents leftover pulses from a previous turn in the opposite
-        // direction from cancelling out the new turn, making the controls feel more responsive.
-        if (instance->_direction != 0 && instance->_direction != increment) {
-            instance->_encoderValue = 0;
-        }
-        instance->_direction = increment;
-        instance->_encoderValue += increment;
-    }
+/**
+ * @brief Queues the detents that completed since the last pin change.
+ * @details Only the interrupt handlers produce into g_input, so the detents found here go
+ * to g_ui_input; drainInput() puts both back in timestamp order. The spinlock keeps the
+ * pin interrupt out of the decoder meanwhile, whichever core it runs on.
+ */
+void RotaryEncoder::poll() {
+#if defined(RINGUI_ENCODER_PCNT)
+    pollCounter();
+#else
+    _decoderLock.lock();
+    uint32_t now_us = micros();
+    int detents = _decoder.poll(now_us);
+    uint32_t detent_us = _decoder.detentTimeUs();
+    _decoderLock.unlock();
+    pushDetents(g_ui_input, detents, detent_us, now_us);
+#endif
+}
 
-    instance->_lastEncoded = encoded;
+uint32_t RotaryEncoder::idleTimeoutMs() {
+#if defined(RINGUI_ENCODER_PCNT)
+    return ENCODER_PCNT_IDLE_POLL_MS;
+#else
+    _decoderLock.lock();
+    bool waiting = _decoder.waiting();
+    _decoderLock.unlock();
+    return waiting ? 0 : Signal::WAIT_FOREVER;
+#endif
 }
 
-RotaryDirection RotaryEncoder::getDirection() {
-    long value;
-    noInterrupts();
-    value = _encoderValue;
-    interrupts();
+#if defined(RINGUI_ENCODER_PCNT)
+/**
+ * @brief Configures the pulse counter to count all four edges of a quadrature cycle.
+ * @details Channel 0 counts the edges of A and channel 1 those of B, each with the other
+ * pin deciding the direction, so that clockwise (11, 10, 00, 01) counts up.
+ */
+void RotaryEncoder::beginCounter() {
+    pcnt_config_t config = {};
+    config.unit = ENCODER_PCNT_UNIT;
+    config.counter_h_lim = ENCODER_PCNT_LIMIT;
+    config.counter_l_lim = -ENCODER_PCNT_LIMIT;
 
-    // This logic accounts for encoders with multiple pulses per detent (e.g., 4).
-    // It returns a direction only once a full detent has been turned, preventing
-    // multiple scroll events for a single physical "click" of the encoder.
-    if (value >= _pulsesPerDetent) {
-        noInterrupts();
-        _encoderValue -= _pulsesPerDetent;
-        interrupts();
-        return RotaryDirection::COUNTERCLOCKWISE;
-    }
-    if (value <= -_pulsesPerDetent) {
-        noInterrupts();
-        _encoderValue += _pulsesPerDetent;
-        interrupts();
-        return RotaryDirection::CLOCKWISE;
-    }
-    
-    return RotaryDirection::NOROTATION;
-}
-
-bool RotaryEncoder::isPressed() {
-    bool triggered = false;
-    int current_state = digitalRead(_pinButton);
-    // Trigger on the falling edge (from HIGH to LOW) for the PULLUP button.
-    if (current_state == LOW && _lastButtonState == HIGH) {
-        // Basic debounce check.
-        if (millis() - _lastButtonPress > 50) {
-            triggered = true;
-        }
-        _lastButtonPress = millis();
-    }
-    _lastButtonState = current_state;
-    return triggered;
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = _pinA;
+    config.ctrl_gpio_num = _pinB;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.lctrl_mode = PCNT_MODE_REVERSE;
+    pcnt_unit_config(&config);
+
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = _pinB;
+    config.ctrl_gpio_num = _pinA;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    pcnt_unit_config(&config);
+
+    pcnt_set_filter_value(ENCODER_PCNT_UNIT, ENCODER_PCNT_FILTER_CYCLES);
+    pcnt_filter_enable(ENCODER_PCNT_UNIT);
+
+    pcnt_counter_pause(ENCODER_PCNT_UNIT);
+    pcnt_counter_clear(ENCODER_PCNT_UNIT);
+    pcnt_counter_resume(ENCODER_PCNT_UNIT);
+    _counterDetents.reset(0);
+    _lastPollMs = millis();
 }
 
 /**
- * @brief A generic, debounced button press checker.
- * @details This is used for the CANCEL button, which uses INPUT_PULLDOWN. It triggers
- * on the rising edge and includes a simple debounce timer.
- * @param pin The GPIO pin to check.
- * @return true if a debounced press event was detected, false otherwise.
+ * @brief Reads the pulse counter and queues the detents since the last call.
+ * @details The counter is read every frame, far more often than half of
+ * ENCODER_PCNT_LIMIT can be turned, so CounterDetents can unwrap its restarts. The
+ * detents are spread evenly over the time since the last poll. No interrupt handler
+ * touches the counter, so they go straight to g_ui_input.
  */
-bool is_button_pressed(int pin) {
-    static unsigned long last_press_time = 0;
-    static int last_button_state = LOW;
-
-    bool triggered = false;
-    int current_state = digitalRead(pin);
-    // Trigger on the rising edge (from LOW to HIGH) for the PULLDOWN button.
-    if (current_state == HIGH && last_button_state == LOW) {
-        // Basic debounce check.
-        if (millis() - last_press_time > 50) {
-            triggered = true;
+void RotaryEncoder::pollCounter() {
+    int16_t count;
+    pcnt_get_counter_value(ENCODER_PCNT_UNIT, &count);
+    int detents = _counterDetents.update(count);
+
+    uint32_t now = millis();
+    if (detents != 0) {
+        InputEventType type = detents > 0 ? InputEventType::DETENT_CW : InputEventType::DETENT_CCW;
+        int n = detents > 0 ? detents : -detents;
+        for (int i = 1; i <= n; i++) {
+            g_ui_input.push({ type, _lastPollMs + (now - _lastPollMs) * i / n });
         }
-        last_press_time = millis();
     }
-    last_button_state = current_state;
-    return triggered;
+    _lastPollMs = now;
 }
+#endif
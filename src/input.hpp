@@ -1,32 +1,224 @@
 /**
  * @file input.hpp
- * @brief Defines the RotaryEncoder class and other input helpers.
+ * @brief Defines the input event queue, the RotaryEncoder class and other input helpers.
  * @defgroup Input
  * @{
  */
 #pragma once
 
 #include <Arduino.h>
+#include "config.hpp"
+#include "event_queue.hpp"
+#include "quadrature.hpp"
+#include "rtos.hpp"
+
+#if defined(RINGUI_ENCODER_PCNT) && defined(RINGUI_SIMULATOR)
+#error "RINGUI_ENCODER_PCNT needs the ESP32 pulse counter, which the simulator does not have"
+#endif
+
+/**
+ * @enum InputEventType
+ * @brief The kinds of events produced by the input interrupt handlers.
+ * @ingroup Input
+ */
+enum class InputEventType : uint8_t {
+    NONE = 0,   ///< No event. Used to disable reporting for a button edge.
+    DETENT_CW,  ///< The encoder was turned one detent clockwise.
+    DETENT_CCW, ///< The encoder was turned one detent counter-clockwise.
+    PRESS,      ///< The encoder's push button was pressed.
+    RELEASE,    ///< The encoder's push button was released.
+    CANCEL      ///< The cancel/back button was pressed.
+};
+
+/**
+ * @struct InputEvent
+ * @brief A single input event with the time at which the interrupt handler saw it.
+ * @ingroup Input
+ */
+struct InputEvent {
+    InputEventType type; ///< What happened.
+    uint32_t timestamp;  ///< The value of millis() when the event was detected.
+};
+
+/**
+ * @brief The queue type that carries input events from the interrupt handlers to the UI loop.
+ * @ingroup Input
+ *
+ * All GPIO interrupts are dispatched from the same interrupt level on one core, so the
+ * handlers never run concurrently and together form the single producer of the queue.
+ */
+using InputQueue = EventQueue<InputEvent, INPUT_QUEUE_SIZE>;
+
+/// @brief Global input event queue, filled by the encoder and button ISRs and drained by the UI.
+/// @ingroup Input
+extern InputQueue g_input;
+
+/// @brief Input events produced by the UI task itself, e.g. by RotaryEncoder::poll() and
+/// RemoteControl. Only the UI task pushes here, so g_input keeps the ISRs as its only producer.
+/// @ingroup Input
+extern InputQueue g_ui_input;
+
+/// @brief Given whenever input arrives: by the button and encoder interrupts and, through
+/// RemoteControl::begin(), by the serial port. A settled UI sleeps on it.
+/// @ingroup Input
+extern Signal g_input_signal;
 
 /**
- * @enum RotaryDirection
- * @brief Represents the direction of rotation for the encoder.
+ * @brief Removes and handles the events of g_input and g_ui_input in timestamp order.
  * @ingroup Input
+ *
+ * Must only be called from the UI task, the consumer of both queues. Of two events with
+ * the same timestamp, the one from g_input is handled first.
+ * @param handler A callable taking `const InputEvent&` and returning true to stop draining.
+ * The event passed to a handler that returns true is consumed; later events stay queued.
+ * @return true if the handler stopped the drain, false if both queues were emptied.
  */
-enum class RotaryDirection {
-    NOROTATION = 0,       ///< No complete rotation detent has been detected.
-    CLOCKWISE = 1,        ///< A clockwise rotation detent has been detected.
-    COUNTERCLOCKWISE = -1 ///< A counter-clockwise rotation detent has been detected.
+template <typename Handler>
+bool drainInput(Handler handler) {
+    InputEvent isr_event{}, ui_event{}, event{};
+    while (true) {
+        bool has_isr = g_input.peek(isr_event);
+        bool has_ui = g_ui_input.peek(ui_event);
+        if (!has_isr && !has_ui) {
+            return false;
+        }
+        if (has_isr && (!has_ui || (int32_t)(isr_event.timestamp - ui_event.timestamp) <= 0)) {
+            g_input.pop(event);
+        } else {
+            g_ui_input.pop(event);
+        }
+        if (handler(event)) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @struct AccelerationCurve
+ * @brief Maps the speed of an encoder spin to the steps each detent stands for.
+ * @ingroup Input
+ *
+ * Below the slow speed every detent is one step, so slow turns keep full precision.
+ * Between the two speeds the steps grow with the square of the speed, and at the fast
+ * speed and above each detent is max_steps steps.
+ */
+struct AccelerationCurve {
+    uint16_t slow_interval_ms; ///< Detents at least this far apart are one step each.
+    uint16_t fast_interval_ms; ///< Detents at most this far apart are max_steps each. Less than slow_interval_ms.
+    uint16_t max_steps;        ///< The steps of one detent at full speed.
+
+    /**
+     * @brief Gets the steps of a detent.
+     * @param interval_ms The time between detents.
+     * @return The number of steps, from 1 to max_steps.
+     */
+    int stepsAt(uint32_t interval_ms) const;
+};
+
+/// @brief The acceleration of EditFloatPage values.
+/// @ingroup Input
+static constexpr AccelerationCurve VALUE_ACCELERATION = {ACCEL_SLOW_INTERVAL_MS, ACCEL_FAST_INTERVAL_MS, VALUE_ACCEL_MAX_STEPS};
+/// @brief The acceleration for long menus, see MenuModel::setAcceleration().
+/// @ingroup Input
+static constexpr AccelerationCurve MENU_ACCELERATION = {ACCEL_SLOW_INTERVAL_MS, ACCEL_FAST_INTERVAL_MS, MENU_ACCEL_MAX_STEPS};
+
+/**
+ * @class DetentAccelerator
+ * @brief Turns detent events into accelerated steps, using the timestamps the encoder gave them.
+ * @ingroup Input
+ *
+ * The speed is the time between consecutive detents in the same direction, averaged
+ * over the last few so that a single short gap does not jump the value. A pause of
+ * slow_interval_ms or a change of direction starts over at one step per detent.
+ * Detents with the same timestamp, e.g. a batch queued by a remote INPUT_EVENTS
+ * command, are one step each, as no hand can turn that fast. Only the timestamps are
+ * used, so the accelerator can be fed synthetic event streams on the host.
+ */
+class DetentAccelerator {
+public:
+    /// @param curve The curve to apply, or nullptr for one step per detent.
+    explicit DetentAccelerator(const AccelerationCurve* curve = nullptr) : curve(curve) {}
+
+    /**
+     * @brief Sets the curve and forgets the current spin.
+     * @param curve The curve to apply, or nullptr for one step per detent.
+     */
+    void setCurve(const AccelerationCurve* curve);
+
+    /**
+     * @brief Gets the steps of an event and updates the speed.
+     * @param event An input event, handled in queue order.
+     * @return The steps, positive for DETENT_CW and negative for DETENT_CCW; 0 for other events.
+     */
+    int steps(const InputEvent& event);
+
+private:
+    const AccelerationCurve* curve; ///< The curve, or nullptr.
+    uint32_t last_ms = 0;           ///< The timestamp of the previous detent.
+    int last_direction = 0;         ///< The direction of the previous detent, or 0 if the spin was reset.
+    uint32_t interval_ms = 0;       ///< The averaged time between the detents of the current spin.
+};
+
+/**
+ * @class Button
+ * @brief An interrupt-driven, debounced push button that reports its edges to g_input.
+ * @ingroup Input
+ */
+class Button {
+public:
+    /**
+     * @brief Constructs a new Button object.
+     * @param pin The GPIO pin the button is connected to.
+     * @param activeLevel The pin level while the button is held (LOW for pull-up wiring, HIGH for pull-down).
+     * @param pressEvent The event to queue when the button is pressed, or NONE.
+     * @param releaseEvent The event to queue when the button is released, or NONE.
+     */
+    Button(int pin, int activeLevel, InputEventType pressEvent, InputEventType releaseEvent = InputEventType::NONE);
+
+    /**
+     * @brief Configures the pin with the matching pull resistor and attaches the interrupt.
+     */
+    void begin();
+
+    /**
+     * @brief Processes a level change of the button pin.
+     *
+     * Called from the pin's interrupt handler. It is public so that tests and simulators
+     * can inject pin levels without hardware.
+     * @param level The current pin level.
+     * @param now The current time in milliseconds.
+     */
+    void IRAM_ATTR onEdge(int level, uint32_t now);
+
+private:
+    /// The interrupt service routine attached to the button pin.
+    static void IRAM_ATTR isr(void* arg);
+
+    int _pin; ///< GPIO pin of the button.
+    int _activeLevel; ///< Pin level while the button is held.
+    InputEventType _pressEvent; ///< Event queued on press.
+    InputEventType _releaseEvent; ///< Event queued on release.
+
+    volatile int _stableLevel; ///< The last accepted (debounced) pin level.
+    volatile uint32_t _lastEdge = 0; ///< Time of the last accepted edge, for debouncing.
 };
 
 /**
  * @class RotaryEncoder
  * @brief Handles input from a rotary encoder with a push button.
  * @ingroup Input
- * 
- * This class uses interrupts to read encoder rotation and provides debounced
- * methods to get the direction of turn and button press state. It is designed
- * as a singleton to be used with hardware interrupts.
+ *
+ * Queues one InputEvent per detent, press and release. Events found by the interrupt
+ * handlers go to g_input, those found by poll() on the UI task to g_ui_input. The
+ * rotation is decoded in one of two ways:
+ * - By default, a pin interrupt reads both pins at once and feeds a QuadratureDecoder,
+ *   which filters out contact bounce.
+ * - Built with `-DRINGUI_ENCODER_PCNT`, the ESP32 pulse counter decodes the pins in
+ *   hardware, so a fast spin causes no interrupts at all. poll() reads the counter once
+ *   per frame and spreads the detents it finds over the time since the last poll, so
+ *   DetentAccelerator still sees their speed.
+ *
+ * It is designed as a singleton to be used with hardware interrupts.
  */
 class RotaryEncoder {
 public:
@@ -45,47 +237,63 @@ public:
     void begin();
 
     /**
-     * @brief Gets the direction of the last full detent turn.
-     * @return The direction of rotation, or NOROTATION if no full turn has occurred.
+     * @brief Queues the detents that completed since the last pin change. Called once per frame by the UI loop.
+     * @details With the pulse counter, this is where all detents are found.
+     */
+    void poll();
+
+    /**
+     * @brief Gets how long the UI may sleep on g_input_signal before it must call poll() again.
+     * @return The time in milliseconds: 0 while a pin change waits out the glitch filter,
+     * ENCODER_PCNT_IDLE_POLL_MS with the pulse counter, which raises no interrupt, and
+     * Signal::WAIT_FOREVER otherwise, as every pin change gives the signal.
      */
-    RotaryDirection getDirection();
+    uint32_t idleTimeoutMs();
 
     /**
-     * @brief Checks if the encoder's button has been pressed.
-     * 
-     * This method is debounced.
-     * @return true if a press event occurred, false otherwise.
+     * @brief Decodes a new quadrature state and queues a detent event once a full detent is reached.
+     *
+     * Called from the pin interrupt handler. It is public so that tests and simulators
+     * can inject pin states without hardware.
+     * @param encoded The current pin state, `(A << 1) | B`.
+     * @param now_us The current time in microseconds.
      */
-    bool isPressed();
+    void IRAM_ATTR onPinChange(int encoded, uint32_t now_us);
 
 private:
     /// The interrupt service routine (ISR) for reading encoder state changes.
     static void IRAM_ATTR readEncoder();
+    /// Reads both pins as `(A << 1) | B`.
+    uint8_t IRAM_ATTR readPins() const;
+    /// Queues the detents the decoder returned, stamped with the time they completed.
+    static void IRAM_ATTR pushDetents(InputQueue& queue, int detents, uint32_t detent_us, uint32_t now_us);
+#if defined(RINGUI_ENCODER_PCNT)
+    /// Configures the pulse counter to count all four edges of a quadrature cycle.
+    void beginCounter();
+    /// Reads the pulse counter and queues the detents since the last call.
+    void pollCounter();
+#endif
     /// Singleton instance pointer for the ISR.
     static RotaryEncoder* instance;
 
     int _pinA; ///< GPIO pin for encoder output A.
     int _pinB; ///< GPIO pin for encoder output B.
-    int _pinButton; ///< GPIO pin for the encoder's push button.
     int _pulsesPerDetent; ///< Number of pulses per physical detent.
+    Button _button; ///< The encoder's push button.
 
-    volatile int _lastEncoded = 0; ///< Stores the last combined state of pins A and B.
-    volatile long _encoderValue = 0; ///< Accumulates encoder pulses.
-    volatile int _direction = 0; ///< Stores the current direction of rotation (1 or -1).
-    
-    unsigned long _lastButtonPress = 0; ///< Timestamp of the last button press for debouncing.
-    int _lastButtonState = HIGH; // Assumes INPUT_PULLUP
+    QuadratureDecoder _decoder; ///< Decodes the pin states. Shared by the ISR and poll(), under _decoderLock.
+    SpinLock _decoderLock; ///< Keeps the ISR and poll() out of the decoder at the same time.
+#if defined(RINGUI_ENCODER_PCNT)
+    CounterDetents _counterDetents; ///< Turns the pulse counter readings into detents.
+    uint32_t _lastPollMs = 0; ///< The time of the last poll, which the next detents are spread from.
+#endif
 };
 
 /// @brief Global instance of the rotary encoder, used throughout the application.
 /// @ingroup Input
 extern RotaryEncoder g_encoder;
 
-/**
- * @brief A generic, debounced button press checker for a given pin.
- * @ingroup Input
- * @param pin The GPIO pin to check, assuming it's configured with INPUT_PULLDOWN.
- * @return true if a press event occurred, false otherwise.
- */
-bool is_button_pressed(int pin);
-/** @} */
\ No newline at end of file
+/// @brief Global instance of the cancel/back button, wired with a pull-down resistor.
+/// @ingroup Input
+extern Button g_cancel_button;
+/** @} */
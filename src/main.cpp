@@ -6,10 +6,11 @@
 #include <Arduino.h>
 #include "config.hpp"
 #include "menu.hpp"
+#include "static_menu.hpp"
 #include "ui.hpp"
 #include "input.hpp"
 #include "pages.hpp"
-#include <functional>
+#include "config_store.hpp"
 
 /// @brief Global U8g2 display driver object.
 /// @ingroup Main
@@ -18,19 +19,96 @@ DisplayDriver OLED(U8G2_R0, U8X8_PIN_NONE, SYS_SCL, SYS_SDA);
 /// @ingroup Main
 RingController<DisplayDriver> controller(OLED);
 
+/**
+ * @defgroup MenuActions Menu Actions
+ * @ingroup Main
+ * @brief Plain functions used by the static menu tables.
+ * @{
+ */
+static Page* showAbout() { return controller.emplacePage<InfoPage>("RingUI  v_Master\nhttps://github.com/\nIntro-iu/RingUI\nDemo: BV1EPbezSETx"); }
+static Page* editScrollKp() { return controller.emplacePage<EditFloatPage>("Scroll Kp", &g_config.scroll_pid_kp, 0.01f, 0.0f, 1.0f); }
+static Page* editScrollKi() { return controller.emplacePage<EditFloatPage>("Scroll Ki", &g_config.scroll_pid_ki, 0.01f, 0.0f, 1.0f); }
+static Page* editScrollKd() { return controller.emplacePage<EditFloatPage>("Scroll Kd", &g_config.scroll_pid_kd, 0.01f, 0.0f, 1.0f); }
+static Page* editAnimKp() { return controller.emplacePage<EditFloatPage>("Anim Kp", &g_config.anim_pid_kp, 0.01f, 0.0f, 1.0f); }
+static Page* editAnimKi() { return controller.emplacePage<EditFloatPage>("Anim Ki", &g_config.anim_pid_ki, 0.001f, 0.0f, 1.0f); }
+static Page* editAnimKd() { return controller.emplacePage<EditFloatPage>("Anim Kd", &g_config.anim_pid_kd, 0.01f, 0.0f, 1.0f); }
+static Page* showReboot() { return controller.emplacePage<RebootPage>(); }
+static void applyPidGains() { controller.update_pid_gains(); }
+static void toggleSerialControl() { g_config.use_serial_control = !g_config.use_serial_control; }
+static bool serialControlEnabled() { return g_config.use_serial_control; }
+#if defined(RINGUI_PROFILER)
+static void togglePerfHud() { g_config.show_profiler_hud = !g_config.show_profiler_hud; }
+static bool perfHudEnabled() { return g_config.show_profiler_hud; }
+#endif
+/** @} */
+
 /**
  * @defgroup Menus Menu Instances
  * @ingroup Main
- * @brief Global instances of the Menu class, forming the application's menu structure.
+ * @brief The application's menu structure, declared as constant tables in flash.
  * @{
  */
-Menu mainMenu("Main Menu");
-Menu settingsMenu("Settings");
-Menu displayMenu("Display");
-Menu systemMenu("System");
-Menu pidMenu("PID Settings");
-Menu scrollPidMenu("Scroll PID");
-Menu animPidMenu("Animation PID");
+extern StaticMenu mainMenu;
+extern StaticMenu settingsMenu;
+extern StaticMenu displayMenu;
+extern StaticMenu systemMenu;
+extern StaticMenu pidMenu;
+extern StaticMenu scrollPidMenu;
+extern StaticMenu animPidMenu;
+
+constexpr StaticMenuItem mainItems[] = {
+    StaticMenuItem::directory("Settings", &settingsMenu),
+    StaticMenuItem::option("About", showAbout),
+    StaticMenuItem::option("Item 3"),
+    StaticMenuItem::option("Item 4"),
+};
+constexpr StaticMenuItem settingsItems[] = {
+    StaticMenuItem::directory("Display", &displayMenu),
+    StaticMenuItem::directory("PID", &pidMenu),
+    StaticMenuItem::directory("System", &systemMenu),
+};
+constexpr StaticMenuItem displayItems[] = {
+    StaticMenuItem::option("Contrast"),
+    StaticMenuItem::option("Timeout"),
+};
+constexpr StaticMenuItem pidItems[] = {
+    StaticMenuItem::directory("Scroll", &scrollPidMenu),
+    StaticMenuItem::directory("Animation", &animPidMenu),
+};
+constexpr StaticMenuItem scrollPidItems[] = {
+    StaticMenuItem::option("Kp", editScrollKp, applyPidGains),
+    StaticMenuItem::option("Ki", editScrollKi, applyPidGains),
+    StaticMenuItem::option("Kd", editScrollKd, applyPidGains),
+};
+constexpr StaticMenuItem animPidItems[] = {
+    StaticMenuItem::option("Kp", editAnimKp, applyPidGains),
+    StaticMenuItem::option("Ki", editAnimKi, applyPidGains),
+    StaticMenuItem::option("Kd", editAnimKd, applyPidGains),
+};
+constexpr StaticMenuItem systemItems[] = {
+    StaticMenuItem::option("Reboot", showReboot),
+    StaticMenuItem::toggle("Serial Control", toggleSerialControl, serialControlEnabled),
+#if defined(RINGUI_PROFILER)
+    StaticMenuItem::toggle("Perf HUD", togglePerfHud, perfHudEnabled),
+#endif
+    StaticMenuItem::option("Reset"),
+};
+
+constexpr StaticMenuTable mainTable = StaticMenuTable::of("Main Menu", mainItems);
+constexpr StaticMenuTable settingsTable = StaticMenuTable::of("Settings", settingsItems, &mainMenu);
+constexpr StaticMenuTable displayTable = StaticMenuTable::of("Display", displayItems, &settingsMenu);
+constexpr StaticMenuTable systemTable = StaticMenuTable::of("System", systemItems, &settingsMenu);
+constexpr StaticMenuTable pidTable = StaticMenuTable::of("PID Settings", pidItems, &settingsMenu);
+constexpr StaticMenuTable scrollPidTable = StaticMenuTable::of("Scroll PID", scrollPidItems, &pidMenu);
+constexpr StaticMenuTable animPidTable = StaticMenuTable::of("Animation PID", animPidItems, &pidMenu);
+
+StaticMenu mainMenu(mainTable);
+StaticMenu settingsMenu(settingsTable);
+StaticMenu displayMenu(displayTable);
+StaticMenu systemMenu(systemTable);
+StaticMenu pidMenu(pidTable);
+StaticMenu scrollPidMenu(scrollPidTable);
+StaticMenu animPidMenu(animPidTable);
 /** @} */
 
 /**
@@ -39,43 +117,18 @@ Menu animPidMenu("Animation PID");
  */
 void setup() {
     // Initialize hardware and software services.
-    pinMode(PIN_CANCEL, INPUT_PULLDOWN);
     Serial.begin(115200);
+    g_remote.begin();
+    // Restore the saved settings before anything reads them, e.g. the animation gains.
+    g_config_store.begin(defaultConfigBackend());
     g_encoder.begin();
+    g_cancel_button.begin();
     controller.setup();
+#if !defined(RINGUI_SIMULATOR)
+    // The simulator transfers frames on the UI thread, so that runs are reproducible.
+    controller.startRenderTask();
+#endif
     
-    // Create the menu structure
-    {
-        mainMenu.addItem(MenuItem("Settings", &settingsMenu));
-        mainMenu.addItem(MenuItem("About", []() { return new InfoPage("RingUI  v_Master\nhttps://github.com/\nIntro-iu/RingUI\nDemo: BV1EPbezSETx"); }));
-        mainMenu.addItem(MenuItem("Item 3", [](){ return nullptr; }));
-        mainMenu.addItem(MenuItem("Item 4", [](){ return nullptr; }));
-
-        settingsMenu.addItem(MenuItem("Display", &displayMenu));
-        settingsMenu.addItem(MenuItem("PID", &pidMenu));
-        settingsMenu.addItem(MenuItem("System", &systemMenu));
-
-        displayMenu.addItem(MenuItem("Contrast", [](){ return nullptr; }));
-        displayMenu.addItem(MenuItem("Timeout", [](){ return nullptr; }));
-
-        pidMenu.addItem(MenuItem("Scroll", &scrollPidMenu));
-        pidMenu.addItem(MenuItem("Animation", &animPidMenu));
-
-        auto callback = []() { controller.update_pid_gains(); };
-
-        scrollPidMenu.addItem(MenuItem("Kp", []() { return new EditFloatPage("Scroll Kp", &g_config.scroll_pid_kp, 0.01f, 0.0f, 1.0f); }, callback));
-        scrollPidMenu.addItem(MenuItem("Ki", []() { return new EditFloatPage("Scroll Ki", &g_config.scroll_pid_ki, 0.01f, 0.0f, 1.0f); }, callback));
-        scrollPidMenu.addItem(MenuItem("Kd", []() { return new EditFloatPage("Scroll Kd", &g_config.scroll_pid_kd, 0.01f, 0.0f, 1.0f); }, callback));
-
-        animPidMenu.addItem(MenuItem("Kp", []() { return new EditFloatPage("Anim Kp", &g_config.anim_pid_kp, 0.01f, 0.0f, 1.0f); }, callback));
-        animPidMenu.addItem(MenuItem("Ki", []() { return new EditFloatPage("Anim Ki", &g_config.anim_pid_ki, 0.001f, 0.0f, 1.0f); }, callback));
-        animPidMenu.addItem(MenuItem("Kd", []() { return new EditFloatPage("Anim Kd", &g_config.anim_pid_kd, 0.01f, 0.0f, 1.0f); }, callback));
-
-        systemMenu.addItem(MenuItem("Reboot", []() { return new RebootPage(); }));
-        systemMenu.addItem(MenuItem("Serial Control", []() { g_config.use_serial_control = !g_config.use_serial_control; }, []() { return g_config.use_serial_control; }));
-        systemMenu.addItem(MenuItem("Reset", [](){ return nullptr; }));
-    }
-
     // Start the UI controller. This is a blocking call that runs the main UI loop.
     controller.handle(&mainMenu);
 }
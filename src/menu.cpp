@@ -1,19 +1,80 @@
 /**
  * @file menu.cpp
- * @brief Implements the Menu and MenuItem classes.
+ * @brief Implements the MenuModel interface, the Menu and CallbackMenu classes, and MenuItem.
  */
 #include "menu.hpp"
 
-MenuItem::MenuItem(String label, std::function<Page*()> action, std::function<void()> on_close_callback)
+MenuItem::MenuItem(StringView label, Delegate<Page*()> action, Delegate<void()> on_close_callback)
     : label(label), type(ItemType::OPTION), subMenu(nullptr), action(action), on_close_callback(on_close_callback) {}
 
-MenuItem::MenuItem(String label, Menu* subMenu)
+MenuItem::MenuItem(StringView label, MenuModel* subMenu)
     : label(label), type(ItemType::DIRECTORY), subMenu(subMenu), action(nullptr) {}
 
-MenuItem::MenuItem(String label, std::function<void()> switch_action, std::function<bool()> get_switch_state)
+MenuItem::MenuItem(StringView label, Delegate<void()> switch_action, Delegate<bool()> get_switch_state)
     : label(label), type(ItemType::SWITCH), subMenu(nullptr), action(nullptr), switch_action(switch_action), get_switch_state(get_switch_state) {}
 
-Menu::Menu(String title) : title(title), parent(nullptr), selected(0) {}
+// --- MenuModel Implementation ---
+
+StringView MenuModel::label(int index) {
+    return getItem(index).label;
+}
+
+MenuItem::ItemType MenuModel::itemType(int index) {
+    return getItem(index).type;
+}
+
+bool MenuModel::switchState(int index) {
+    const MenuItem& item = getItem(index);
+    return item.get_switch_state ? item.get_switch_state() : false;
+}
+
+void MenuModel::updateLayout(const uint8_t* font, const TextMeasure& measure) {
+    if (layout_font == font) return;
+    state_widths[0] = measure(SWITCH_OFF_TEXT);
+    state_widths[1] = measure(SWITCH_ON_TEXT);
+    layout_font = font;
+}
+
+void MenuModel::invalidateLayout() {
+    layout_font = nullptr;
+    layout_version++;
+}
+
+MenuItemLayout MenuModel::itemLayout(int index) const {
+    return MenuItemLayout{rowBaseline(index), -1};
+}
+
+int MenuModel::switchStateWidth(bool on) const {
+    return state_widths[on ? 1 : 0];
+}
+
+/**
+ * @brief Sets the parent menu for this menu, enabling backward navigation.
+ * @param parent A pointer to the parent menu.
+ */
+void MenuModel::setParent(MenuModel* parent) {
+    this->parent = parent;
+}
+
+MenuModel* MenuModel::getParent() const {
+    return parent;
+}
+
+void MenuModel::setAcceleration(const AccelerationCurve* curve) {
+    acceleration = curve;
+}
+
+const AccelerationCurve* MenuModel::getAcceleration() const {
+    return acceleration;
+}
+
+int16_t MenuModel::rowBaseline(int index) {
+    return index * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN;
+}
+
+// --- Menu Implementation ---
+
+Menu::Menu(StringView title) : title(title) {}
 
 /**
  * @brief Adds a new item to the menu's list.
@@ -21,31 +82,82 @@ Menu::Menu(String title) : title(title), parent(nullptr), selected(0) {}
  */
 void Menu::addItem(const MenuItem& item) {
     items.push_back(item);
+    invalidateLayout();
     if (item.type == MenuItem::ItemType::DIRECTORY && item.subMenu != nullptr) {
         item.subMenu->setParent(this);
     }
 }
 
-/**
- * @brief Sets the parent menu for this menu, enabling backward navigation.
- * @param parent A pointer to the parent Menu.
- */
-void Menu::setParent(Menu* parent) {
-    this->parent = parent;
+void Menu::setLabel(int index, StringView label) {
+    items[index].label = label;
+    invalidateLayout();
+}
+
+StringView Menu::getTitle() const {
+    return title;
+}
+
+int Menu::size() const {
+    return items.size();
 }
 
 MenuItem& Menu::getItem(int index) {
     return items[index];
 }
 
-Menu* Menu::getParent() const {
-    return parent;
+/**
+ * @brief Measures every label once per font, in addition to the switch state texts.
+ */
+void Menu::updateLayout(const uint8_t* font, const TextMeasure& measure) {
+    if (layout_font == font) return;
+    MenuModel::updateLayout(font, measure);
+
+    layout.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        layout[i].baseline = rowBaseline(i);
+        layout[i].label_width = measure(items[i].label);
+    }
 }
 
-String Menu::getTitle() const {
-    return title;
+MenuItemLayout Menu::itemLayout(int index) const {
+    return layout[index];
 }
 
-int Menu::size() const {
-    return items.size();
+// --- CallbackMenu Implementation ---
+
+CallbackMenu::CallbackMenu(CountFunction count, ItemFunction item, WidthFunction label_width)
+    : count(count), item(item), label_width(label_width) {}
+
+void CallbackMenu::refresh() {
+    for (Slot& slot : window) {
+        slot.index = -1;
+    }
+    next_victim = 0;
+    invalidateLayout();
+}
+
+int CallbackMenu::size() const {
+    return count ? count() : 0;
+}
+
+/**
+ * @brief Gets an item, producing it if it is not in the window.
+ * @details Slots are reused in the order they were filled, so the oldest produced item
+ * is replaced first.
+ */
+MenuItem& CallbackMenu::getItem(int index) {
+    for (Slot& slot : window) {
+        if (slot.index == index) return slot.item;
+    }
+
+    Slot& slot = window[next_victim];
+    next_victim = (next_victim + 1) % MENU_WINDOW_SIZE;
+    slot.index = index;
+    slot.label[0] = '\0';
+    slot.item = item(index, slot.label, sizeof(slot.label));
+    return slot.item;
+}
+
+MenuItemLayout CallbackMenu::itemLayout(int index) const {
+    return MenuItemLayout{rowBaseline(index), (int16_t)(label_width ? label_width(index) : -1)};
 }
@@ -1,6 +1,6 @@
 /**
  * @file menu.hpp
- * @brief Defines the Menu and MenuItem classes.
+ * @brief Defines the MenuModel interface, its Menu and CallbackMenu implementations, and MenuItem.
  * @defgroup MenuSystem
  * @{
  */
@@ -8,10 +8,12 @@
 
 #include <Arduino.h>
 #include <vector>
-#include <functional>
-#include "pages.hpp" // Required for std::function<Page*()>
+#include "pages.hpp" // Required for Delegate<Page*()>
+#include "delegate.hpp"
+#include "string_view.hpp"
+#include "config.hpp"
 
-class Menu; // Forward declaration
+class MenuModel; // Forward declaration
 
 /**
  * @class MenuItem
@@ -29,18 +31,23 @@ public:
         SWITCH     ///< Toggles a boolean value on and off.
     };
 
-    String label; ///< The text to display for the item.
+    StringView label; ///< The text to display for the item. Not owned by the item.
     ItemType type; ///< The type of the menu item, which determines its behavior.
-    Menu* subMenu; ///< A pointer to the submenu, if this item is a DIRECTORY.
+    MenuModel* subMenu; ///< A pointer to the submenu, if this item is a DIRECTORY.
     
     /// Action to perform for an OPTION item, which returns a new Page to be displayed.
-    std::function<Page*()> action;
+    Delegate<Page*()> action;
     /// Optional callback to execute after the created Page is closed.
-    std::function<void()> on_close_callback;
+    Delegate<void()> on_close_callback;
     /// Action to perform for a SWITCH item.
-    std::function<void()> switch_action;
+    Delegate<void()> switch_action;
     /// Function to get the current state of a SWITCH item for display.
-    std::function<bool()> get_switch_state;
+    Delegate<bool()> get_switch_state;
+
+    /**
+     * @brief Construct an empty OPTION item, e.g. a buffer that a model fills in later.
+     */
+    constexpr MenuItem() : type(ItemType::OPTION), subMenu(nullptr) {}
 
     /**
      * @brief Construct a new MenuItem that functions as an option.
@@ -48,14 +55,14 @@ public:
      * @param action A function that creates and returns a new Page object to be displayed.
      * @param on_close_callback An optional function to call after the page is closed.
      */
-    MenuItem(String label, std::function<Page*()> action, std::function<void()> on_close_callback = nullptr);
+    MenuItem(StringView label, Delegate<Page*()> action, Delegate<void()> on_close_callback = nullptr);
 
     /**
      * @brief Construct a new MenuItem that opens a submenu.
      * @param label The text to display for the item.
      * @param subMenu A pointer to the submenu to open.
      */
-    MenuItem(String label, Menu* subMenu);
+    MenuItem(StringView label, MenuModel* subMenu);
 
     /**
      * @brief Construct a new MenuItem that functions as a switch.
@@ -63,61 +70,251 @@ public:
      * @param switch_action A function to toggle the switch's state.
      * @param get_switch_state A function to get the current state of the switch.
      */
-    MenuItem(String label, std::function<void()> switch_action, std::function<bool()> get_switch_state);
+    MenuItem(StringView label, Delegate<void()> switch_action, Delegate<bool()> get_switch_state);
+};
+
+/**
+ * @struct MenuItemLayout
+ * @brief The pixel metrics of a MenuItem in its menu's font.
+ * @ingroup MenuSystem
+ */
+struct MenuItemLayout {
+    int16_t baseline;    ///< The text baseline of the row, relative to the top of the list.
+    int16_t label_width; ///< The pixel width of the label, or -1 if the model does not know it.
+};
+
+/// A function that returns the pixel width of a text in the current font.
+/// @ingroup MenuSystem
+using TextMeasure = Delegate<int(StringView)>;
+
+/**
+ * @class MenuModel
+ * @brief The interface through which the RingController renders and navigates a menu.
+ * @ingroup MenuSystem
+ *
+ * A model only has to report its size and produce the item at an index, so the
+ * controller never needs every item to exist at once: it only asks for the rows in
+ * the visible window and the selected one. The model also carries the navigation state
+ * (selection and parent) and caches the widths of the switch state texts.
+ */
+class MenuModel {
+public:
+    constexpr MenuModel() {}
+    /// @param parent The parent menu, for models whose hierarchy is known up front.
+    constexpr explicit MenuModel(MenuModel* parent) : parent(parent) {}
+    virtual ~MenuModel() {}
+
+    /**
+     * @brief Gets the number of items in the menu.
+     * @return The number of items.
+     */
+    virtual int size() const = 0;
+
+    /**
+     * @brief Gets a reference to a menu item by its index.
+     * @details Implementations that produce items on demand may reuse the storage of an
+     * item once other items were requested, so callers must not keep the reference.
+     * @param index The index of the item to retrieve.
+     * @return A reference to the MenuItem.
+     */
+    virtual MenuItem& getItem(int index) = 0;
+
+    /**
+     * @brief Gets the label of an item for drawing.
+     * @details The default implementation reads it from getItem(). Models that can
+     * provide a row without building a MenuItem override this and the two functions below.
+     * @param index The index of the item.
+     * @return The label, valid until the next call into the model.
+     */
+    virtual StringView label(int index);
+
+    /**
+     * @brief Gets the type of an item for drawing.
+     * @param index The index of the item.
+     * @return The item's type.
+     */
+    virtual MenuItem::ItemType itemType(int index);
+
+    /**
+     * @brief Gets the state of a SWITCH item for drawing.
+     * @param index The index of the item.
+     * @return The switch state, or false if the item has no state getter.
+     */
+    virtual bool switchState(int index);
+
+    /**
+     * @brief Measures the layout if it is missing or was measured in another font.
+     * @param font The font the measurements are made in.
+     * @param measure The function that measures a string in @p font.
+     */
+    virtual void updateLayout(const uint8_t* font, const TextMeasure& measure);
+
+    /**
+     * @brief Marks the cached layout as stale, e.g. after a label was changed in place.
+     */
+    virtual void invalidateLayout();
+
+    /**
+     * @brief Gets a counter that changes whenever the layout is invalidated.
+     * @details Lets callers tell when measurements they cached for this menu are stale.
+     * @return The number of invalidateLayout() calls so far.
+     */
+    uint32_t layoutVersion() const { return layout_version; }
+
+    /**
+     * @brief Gets the layout of an item. updateLayout() must have been called.
+     * @details The default implementation has no label width hint, so the controller
+     * measures the label itself.
+     * @param index The index of the item.
+     * @return The item's layout.
+     */
+    virtual MenuItemLayout itemLayout(int index) const;
+
+    /**
+     * @brief Gets the cached width of a SWITCH item's state text. updateLayout() must have been called.
+     * @param on The switch state.
+     * @return The pixel width of SWITCH_ON_TEXT or SWITCH_OFF_TEXT.
+     */
+    int switchStateWidth(bool on) const;
+
+    /**
+     * @brief Sets the parent menu for this menu, enabling backward navigation.
+     * @param parent A pointer to the parent menu.
+     */
+    void setParent(MenuModel* parent);
+
+    /**
+     * @brief Gets a pointer to the parent menu.
+     * @return A pointer to the parent menu, or nullptr if it's a root menu.
+     */
+    MenuModel* getParent() const;
+
+    /**
+     * @brief Opts the menu into encoder acceleration, e.g. MENU_ACCELERATION for a long list.
+     * @param curve The curve a fast spin follows, or nullptr to move one item per detent.
+     */
+    void setAcceleration(const AccelerationCurve* curve);
+
+    /**
+     * @brief Gets the encoder acceleration of the menu.
+     * @return The curve, or nullptr if the selection moves one item per detent.
+     */
+    const AccelerationCurve* getAcceleration() const;
+
+    /// The index of the currently selected item in the menu.
+    int selected = 0;
+
+protected:
+    /// Gets the text baseline of a row, relative to the top of the list.
+    static int16_t rowBaseline(int index);
+
+    const uint8_t* layout_font = nullptr; ///< The font the layout was measured in, or nullptr if stale.
+
+private:
+    MenuModel* parent = nullptr; ///< A pointer to the parent menu.
+    const AccelerationCurve* acceleration = nullptr; ///< The encoder acceleration, or nullptr.
+    uint16_t state_widths[2] = {0, 0}; ///< The widths of SWITCH_OFF_TEXT and SWITCH_ON_TEXT.
+    uint32_t layout_version = 0; ///< Incremented by invalidateLayout().
 };
 
 /**
  * @class Menu
  * @brief A container for a list of MenuItem objects, representing a single screen of options.
  * @ingroup MenuSystem
+ *
+ * The menu also caches the layout of its items (label widths and row baselines), so the
+ * renderer does not measure glyph strings on every frame. The cache is rebuilt lazily
+ * after addItem(), setLabel() or a change of font.
  */
-class Menu {
+class Menu : public MenuModel {
 public:
     /**
      * @brief Construct a new Menu object.
      * @param title The title of the menu (not currently displayed, but used for identification).
      */
-    Menu(String title);
+    Menu(StringView title);
 
     /**
      * @brief Adds a new item to the menu's list.
      * @param item The MenuItem object to add.
      */
     void addItem(const MenuItem& item);
-    /**
-     * @brief Sets the parent menu for this menu, enabling backward navigation.
-     * @param parent A pointer to the parent Menu.
-     */
-    void setParent(Menu* parent);
 
     /**
-     * @brief Gets a reference to a menu item by its index.
-     * @param index The index of the item to retrieve.
-     * @return A reference to the MenuItem.
+     * @brief Changes the label of an item and invalidates the cached layout.
+     * @param index The index of the item.
+     * @param label The new label. The text must outlive the menu.
      */
-    MenuItem& getItem(int index);
-    /**
-     * @brief Gets a pointer to the parent menu.
-     * @return A pointer to the parent Menu, or nullptr if it's a root menu.
-     */
-    Menu* getParent() const;
+    void setLabel(int index, StringView label);
+
     /**
      * @brief Gets the title of the menu.
      * @return The menu's title string.
      */
-    String getTitle() const;
+    StringView getTitle() const;
+
+    int size() const override;
+    MenuItem& getItem(int index) override;
+    void updateLayout(const uint8_t* font, const TextMeasure& measure) override;
+    MenuItemLayout itemLayout(int index) const override;
+
+private:
+    StringView title; ///< The title of the menu.
+    std::vector<MenuItem> items; ///< The list of items in this menu.
+    std::vector<MenuItemLayout> layout; ///< The cached layout, one entry per item.
+};
+
+/**
+ * @class CallbackMenu
+ * @brief A menu whose items are produced on demand by callbacks.
+ * @ingroup MenuSystem
+ *
+ * Suited to long or dynamic lists such as directory listings or sensor IDs: only the
+ * items the controller actually draws are created, and at most MENU_WINDOW_SIZE of them
+ * are kept at a time. Each kept item has a label buffer of MENU_LABEL_CAPACITY bytes
+ * that the item callback can format its label into, so labels like "Sensor 12" need no
+ * storage of their own.
+ */
+class CallbackMenu : public MenuModel {
+public:
+    /// Returns the current number of items.
+    using CountFunction = Delegate<int()>;
+    /// Creates the item at an index. The item's label may point into @p label, a buffer of
+    /// @p capacity bytes that stays valid as long as the item is kept.
+    using ItemFunction = Delegate<MenuItem(int index, char* label, size_t capacity)>;
+    /// Returns the pixel width of the label at an index, or -1 if it must be measured.
+    using WidthFunction = Delegate<int(int index)>;
+
     /**
-     * @brief Gets the number of items in the menu.
-     * @return The number of items.
+     * @brief Construct a new CallbackMenu.
+     * @param count A function that returns the number of items.
+     * @param item A function that creates the item at an index.
+     * @param label_width An optional function that returns label widths without creating the item.
      */
-    int size() const;
+    CallbackMenu(CountFunction count, ItemFunction item, WidthFunction label_width = nullptr);
 
-    /// The index of the currently selected item in the menu.
-    int selected = 0;
+    /**
+     * @brief Drops all produced items, e.g. after the underlying data changed.
+     */
+    void refresh();
+
+    int size() const override;
+    MenuItem& getItem(int index) override;
+    MenuItemLayout itemLayout(int index) const override;
 
 private:
-    String title; ///< The title of the menu.
-    Menu* parent; ///< A pointer to the parent menu.
-    std::vector<MenuItem> items; ///< The list of items in this menu.
+    /// A produced item, the index it belongs to and the storage for its label.
+    struct Slot {
+        Slot() : index(-1), item(StringView(), (MenuModel*)nullptr) {}
+        int index;                      ///< The item's index, or -1 if the slot is free.
+        MenuItem item;                  ///< The produced item.
+        char label[MENU_LABEL_CAPACITY]; ///< Storage the item's label may point into.
+    };
+
+    CountFunction count;            ///< Returns the number of items.
+    ItemFunction item;              ///< Creates the item at an index.
+    WidthFunction label_width;      ///< Returns label width hints, or nullptr.
+    Slot window[MENU_WINDOW_SIZE];  ///< The most recently produced items.
+    int next_victim = 0;            ///< The slot replaced next.
 };
 /** @} */
\ No newline at end of file
@@ -0,0 +1,133 @@
+/**
+ * @file mirror.cpp
+ * @brief Implements the FrameMirror class.
+ */
+#include "mirror.hpp"
+#include <string.h>
+#include <algorithm>
+
+FrameMirror g_mirror(Serial);
+
+/// The number of bytes in a single 8x8 pixel tile.
+static constexpr size_t TILE_BYTES = 8;
+/// The most tiles one record holds, so that even their worst-case encoding fits in a frame.
+static constexpr int MAX_RECORD_TILES = (REMOTE_MAX_PAYLOAD - 1 - MIRROR_RECORD_HEADER - 2) / TILE_BYTES;
+static_assert(mirrorRleBound(MAX_RECORD_TILES * TILE_BYTES) <= REMOTE_MAX_PAYLOAD - 1 - MIRROR_RECORD_HEADER,
+              "a record of MAX_RECORD_TILES tiles must fit in a frame");
+
+void MirrorStats::print(Print& out) const {
+    uint32_t mean = calls ? encode_us_total / calls : 0;
+    out.printf("Mirror: %u frames, %u deferred, %u bytes, encode mean %u us, max %u us\n",
+               (unsigned)frames, (unsigned)deferred, (unsigned)bytes, (unsigned)mean, (unsigned)encode_us_max);
+}
+
+void FrameMirror::begin(uint8_t tile_width, uint8_t tile_height) {
+    this->tile_width = tile_width;
+    this->tile_height = tile_height;
+    shadow.assign((size_t)tile_width * tile_height * TILE_BYTES, 0);
+}
+
+void FrameMirror::setEnabled(bool enabled) {
+    if (enabled && !is_enabled) {
+        // The host starts from a blank screen, so everything lit is a change.
+        std::fill(shadow.begin(), shadow.end(), 0);
+        in_progress = false;
+        last_frame_ms = millis() - MIRROR_INTERVAL_MS;
+    }
+    is_enabled = enabled;
+}
+
+/**
+ * @brief Diffs, encodes and writes a frame.
+ * @details A frame that did not fit continues on the next call with the then current
+ * frame, so the host may briefly see rows of two frames; the end record is only sent
+ * once every row matches.
+ */
+void FrameMirror::send(const uint8_t* frame) {
+    if (shadow.empty() || !frame) return;
+    uint32_t now = millis();
+    if (!in_progress && now - last_frame_ms < MIRROR_INTERVAL_MS) return;
+    // Records must not land inside a remote reply that was sent in part.
+    if (g_remote.sending()) {
+        mirror_stats.deferred++;
+        return;
+    }
+
+    uint32_t start_us = micros();
+    int available = port.availableForWrite();
+    size_t budget = available > 0 ? (size_t)available : 0;
+    if (budget > MIRROR_MAX_BYTES) budget = MIRROR_MAX_BYTES;
+
+    const size_t row_bytes = (size_t)tile_width * TILE_BYTES;
+    uint8_t record[REMOTE_MAX_PAYLOAD - 1];
+    size_t sent = 0;
+    bool complete = true;
+
+    for (uint8_t ty = 0; ty < tile_height && complete; ty++) {
+        const uint8_t* row = frame + ty * row_bytes;
+        uint8_t* shadow_row = shadow.data() + ty * row_bytes;
+        int first = -1, last = -1;
+        for (int tx = 0; tx < tile_width; tx++) {
+            if (memcmp(row + tx * TILE_BYTES, shadow_row + tx * TILE_BYTES, TILE_BYTES) != 0) {
+                if (first < 0) first = tx;
+                last = tx;
+            }
+        }
+        // Rows too wide for one record are sent in parts.
+        while (first >= 0 && first <= last) {
+            int count = last - first + 1;
+            if (count > MAX_RECORD_TILES) count = MAX_RECORD_TILES;
+            size_t span = (size_t)count * TILE_BYTES;
+            if (!in_progress) {
+                sequence++;
+                in_progress = true;
+            }
+            record[0] = sequence & 0xFF;
+            record[1] = sequence >> 8;
+            record[2] = ty;
+            record[3] = (uint8_t)first;
+            record[4] = (uint8_t)count;
+            size_t length = MIRROR_RECORD_HEADER +
+                            mirrorRleEncode(row + first * TILE_BYTES, span, record + MIRROR_RECORD_HEADER);
+            size_t framed = length + 1 + REMOTE_FRAME_OVERHEAD;
+            if (sent + framed > budget) {
+                complete = false;
+                break;
+            }
+            writer.reply((uint8_t)RemoteCommand::MIRROR_FRAME, RemoteStatus::OK, record, length);
+            memcpy(shadow_row + first * TILE_BYTES, row + first * TILE_BYTES, span);
+            sent += framed;
+            first += count;
+        }
+    }
+
+    if (complete && in_progress) {
+        size_t framed = MIRROR_END_RECORD + 1 + REMOTE_FRAME_OVERHEAD;
+        if (sent + framed <= budget) {
+            record[0] = sequence & 0xFF;
+            record[1] = sequence >> 8;
+            record[2] = MIRROR_END_OF_FRAME;
+            record[3] = now & 0xFF;
+            record[4] = (now >> 8) & 0xFF;
+            record[5] = (now >> 16) & 0xFF;
+            record[6] = now >> 24;
+            writer.reply((uint8_t)RemoteCommand::MIRROR_FRAME, RemoteStatus::OK, record, MIRROR_END_RECORD);
+            sent += framed;
+            in_progress = false;
+            last_frame_ms = now;
+            mirror_stats.frames++;
+        } else {
+            complete = false;
+        }
+    } else if (complete) {
+        // Nothing changed: check again after the next interval.
+        last_frame_ms = now;
+    }
+    if (!complete) mirror_stats.deferred++;
+
+    uint32_t elapsed = micros() - start_us;
+    mirror_stats.calls++;
+    mirror_stats.bytes += sent;
+    mirror_stats.encode_us_total += elapsed;
+    if (elapsed > mirror_stats.encode_us_max) mirror_stats.encode_us_max = elapsed;
+}
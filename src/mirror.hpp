@@ -0,0 +1,112 @@
+/**
+ * @file mirror.hpp
+ * @brief Defines FrameMirror, which streams the framebuffer over serial for remote viewing.
+ * @ingroup Remote
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <vector>
+#include "remote.hpp"
+#include "mirror_codec.hpp"
+
+/**
+ * @struct MirrorStats
+ * @brief Counts what the mirror sent and what it cost.
+ * @ingroup Remote
+ */
+struct MirrorStats {
+    uint32_t frames = 0;          ///< Frames sent completely.
+    uint32_t deferred = 0;        ///< Calls that ran out of serial buffer space before the frame was complete.
+    uint32_t bytes = 0;           ///< Bytes written to the serial port, framing included.
+    uint32_t encode_us_total = 0; ///< Time spent diffing, encoding and writing.
+    uint32_t encode_us_max = 0;   ///< The longest of those calls.
+    uint32_t calls = 0;           ///< Calls that diffed the frame, i.e. were not rate limited.
+
+    /**
+     * @brief Prints the statistics, e.g. to Serial.
+     * @param out The stream to print to.
+     */
+    void print(Print& out) const;
+};
+
+/**
+ * @class FrameMirror
+ * @brief Sends the tiles that changed since the last mirrored frame, run-length encoded.
+ * @ingroup Remote
+ *
+ * Once enabled (with the MIRROR remote command), the controller passes every presented
+ * frame to mirror(). At most every MIRROR_INTERVAL_MS, the frame is compared with a
+ * shadow copy of what the host has, and for each tile row the span of changed tiles is
+ * sent as one MIRROR_FRAME record, followed by an end record; see mirror_codec.hpp.
+ *
+ * The mirror never waits for the serial port: it only writes what fits in the port's
+ * transmit buffer, and at most MIRROR_MAX_BYTES per call. Rows that do not fit stay
+ * different from the shadow copy and are sent by the next call, so a slow link lowers
+ * the mirror's frame rate instead of the UI's. While g_remote still has replies to
+ * send, the mirror waits for them. The cost of a call is bounded by one
+ * compare of the framebuffer and the encoding of MIRROR_MAX_BYTES; MirrorStats
+ * records what it actually was.
+ */
+class FrameMirror {
+public:
+    /// @param port The serial port to write to.
+    explicit FrameMirror(HardwareSerial& port) : port(port), writer(port) {}
+
+    /**
+     * @brief Allocates the shadow copy for a framebuffer of the given tile dimensions.
+     * @param tile_width The width of the framebuffer in tiles.
+     * @param tile_height The height of the framebuffer in tiles.
+     */
+    void begin(uint8_t tile_width, uint8_t tile_height);
+
+    /**
+     * @brief Starts or stops mirroring.
+     * @details Starting sends the whole screen, as the host begins with a blank frame.
+     * @param enabled true to start.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Checks whether mirroring is on.
+     * @return true while frames are sent.
+     */
+    bool enabled() const { return is_enabled; }
+
+    /**
+     * @brief Sends the changes of a presented frame, if the rate limit and the port allow.
+     * @param frame The framebuffer, in U8g2 tile layout.
+     */
+    void mirror(const uint8_t* frame) {
+        if (is_enabled) send(frame);
+    }
+
+    /**
+     * @brief Gets the statistics since the last resetStats().
+     * @return The statistics.
+     */
+    const MirrorStats& stats() const { return mirror_stats; }
+
+    /// @brief Clears the statistics.
+    void resetStats() { mirror_stats = MirrorStats(); }
+
+private:
+    /// Diffs, encodes and writes a frame. Called by mirror() while enabled.
+    void send(const uint8_t* frame);
+
+    HardwareSerial& port;         ///< The serial port.
+    RemoteWriter writer;          ///< Frames the records.
+    uint8_t tile_width = 0;       ///< The framebuffer width in tiles.
+    uint8_t tile_height = 0;      ///< The framebuffer height in tiles.
+    std::vector<uint8_t> shadow;  ///< The frame as the host has it.
+    bool is_enabled = false;      ///< True while mirroring.
+    bool in_progress = false;     ///< True while a frame has been sent in part.
+    uint16_t sequence = 0;        ///< The sequence number of the current frame.
+    uint32_t last_frame_ms = 0;   ///< When the last complete frame was sent.
+    MirrorStats mirror_stats;     ///< What was sent and what it cost.
+};
+
+/// @brief Global framebuffer mirror on the USB serial port.
+/// @ingroup Remote
+extern FrameMirror g_mirror;
@@ -0,0 +1,123 @@
+/**
+ * @file mirror_codec.cpp
+ * @brief Implements the mirror run-length encoding and MirrorDecoder.
+ */
+#include "mirror_codec.hpp"
+#include <string.h>
+
+/// The number of bytes in a single 8x8 pixel tile.
+static constexpr size_t TILE_BYTES = 8;
+/// The longest literal run a header byte can describe.
+static constexpr size_t MAX_LITERAL = 128;
+/// The longest repeat run a header byte can describe.
+static constexpr size_t MAX_REPEAT = 129;
+
+/**
+ * @brief Run-length encodes bytes.
+ * @details Repeats of two bytes are only split off when the literal run before them is
+ * empty; inside a literal run they would cost one byte more than they save.
+ */
+size_t mirrorRleEncode(const uint8_t* data, size_t length, uint8_t* out) {
+    size_t in = 0, written = 0;
+    size_t literal_start = 0;
+    while (in < length) {
+        size_t run = 1;
+        while (in + run < length && run < MAX_REPEAT && data[in + run] == data[in]) run++;
+        bool literal_open = in > literal_start;
+        if (run >= 3 || (run == 2 && !literal_open)) {
+            while (literal_start < in) {
+                size_t count = in - literal_start < MAX_LITERAL ? in - literal_start : MAX_LITERAL;
+                out[written++] = (uint8_t)(count - 1);
+                memcpy(out + written, data + literal_start, count);
+                written += count;
+                literal_start += count;
+            }
+            out[written++] = (uint8_t)(run + 126);
+            out[written++] = data[in];
+            in += run;
+            literal_start = in;
+        } else {
+            in += run;
+        }
+    }
+    while (literal_start < length) {
+        size_t count = length - literal_start < MAX_LITERAL ? length - literal_start : MAX_LITERAL;
+        out[written++] = (uint8_t)(count - 1);
+        memcpy(out + written, data + literal_start, count);
+        written += count;
+        literal_start += count;
+    }
+    return written;
+}
+
+size_t mirrorRleDecode(const uint8_t* data, size_t length, uint8_t* out, size_t capacity) {
+    size_t in = 0, written = 0;
+    while (in < length) {
+        uint8_t header = data[in++];
+        if (header < MAX_LITERAL) {
+            size_t count = (size_t)header + 1;
+            if (in + count > length || written + count > capacity) return 0;
+            memcpy(out + written, data + in, count);
+            in += count;
+            written += count;
+        } else {
+            size_t count = (size_t)header - 126;
+            if (in >= length || written + count > capacity) return 0;
+            memset(out + written, data[in++], count);
+            written += count;
+        }
+    }
+    return written;
+}
+
+// --- MirrorDecoder ---
+
+MirrorDecoder::MirrorDecoder(uint8_t tile_width, uint8_t tile_height)
+    : tile_width(tile_width), tile_height(tile_height),
+      buffer((size_t)tile_width * tile_height * TILE_BYTES, 0), scratch((size_t)tile_width * TILE_BYTES) {}
+
+bool MirrorDecoder::apply(const uint8_t* payload, size_t length) {
+    // Skip the status byte.
+    if (length < 1 + 3) {
+        error_count++;
+        return false;
+    }
+    payload++;
+    length--;
+    uint16_t sequence = payload[0] | (uint16_t)(payload[1] << 8);
+    uint8_t row = payload[2];
+
+    if (row == MIRROR_END_OF_FRAME) {
+        if (length < MIRROR_END_RECORD) {
+            error_count++;
+            return false;
+        }
+        last_sequence = sequence;
+        time_ms = payload[3] | (uint32_t)payload[4] << 8 | (uint32_t)payload[5] << 16 | (uint32_t)payload[6] << 24;
+        return true;
+    }
+
+    if (length < MIRROR_RECORD_HEADER) {
+        error_count++;
+        return false;
+    }
+    uint8_t first = payload[3];
+    uint8_t count = payload[4];
+    if (row >= tile_height || first + count > tile_width) {
+        error_count++;
+        return false;
+    }
+    // Decoded aside, so a malformed record leaves the frame as it was.
+    size_t span_bytes = (size_t)count * TILE_BYTES;
+    if (mirrorRleDecode(payload + MIRROR_RECORD_HEADER, length - MIRROR_RECORD_HEADER, scratch.data(), span_bytes) != span_bytes) {
+        error_count++;
+        return false;
+    }
+    memcpy(buffer.data() + ((size_t)row * tile_width + first) * TILE_BYTES, scratch.data(), span_bytes);
+    return false;
+}
+
+bool MirrorDecoder::pixel(int x, int y) const {
+    if (x < 0 || y < 0 || x >= tile_width * 8 || y >= tile_height * 8) return false;
+    return (buffer[(size_t)(y / 8) * tile_width * TILE_BYTES + x] >> (y % 8)) & 1;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file mirror_codec.hpp
+ * @brief Defines the encoding of mirrored framebuffer updates and the host-side MirrorDecoder.
+ * @ingroup Remote
+ *
+ * A MIRROR_FRAME payload is the reply status, a 16-bit frame sequence number and one
+ * record. A tile record is the tile row, the first tile column, the number of tiles and
+ * their bytes in U8g2 tile layout, run-length encoded. The end record has the row
+ * MIRROR_END_OF_FRAME followed by the time of the frame in milliseconds (u32): the tile
+ * records with the same sequence number before it make up one complete frame.
+ *
+ * Like remote_protocol.hpp, this has no Arduino dependencies.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/// The row byte of the record that completes a mirrored frame.
+static constexpr uint8_t MIRROR_END_OF_FRAME = 0xFF;
+/// The bytes of a tile record before its encoded tiles: sequence, row, first tile and count.
+static constexpr size_t MIRROR_RECORD_HEADER = 5;
+/// The bytes of an end record: sequence, MIRROR_END_OF_FRAME and the time.
+static constexpr size_t MIRROR_END_RECORD = 7;
+
+/**
+ * @brief Gets the largest size the run-length encoding of some bytes can have.
+ * @param length The number of bytes to encode.
+ * @return The worst case, one header byte per 128 literal bytes.
+ */
+constexpr size_t mirrorRleBound(size_t length) {
+    return length + (length + 127) / 128;
+}
+
+/**
+ * @brief Run-length encodes bytes.
+ * @details A header byte below 128 is followed by header + 1 literal bytes; a header of
+ * 128 or more is followed by one byte repeated header - 126 times (2 to 129).
+ * @param data The bytes to encode.
+ * @param length The number of bytes.
+ * @param out The destination, at least mirrorRleBound(length) bytes.
+ * @return The encoded size.
+ */
+size_t mirrorRleEncode(const uint8_t* data, size_t length, uint8_t* out);
+
+/**
+ * @brief Decodes bytes encoded by mirrorRleEncode().
+ * @param data The encoded bytes.
+ * @param length The number of encoded bytes.
+ * @param out The destination.
+ * @param capacity The size of @p out.
+ * @return The decoded size, or 0 if the input is malformed or does not fit.
+ */
+size_t mirrorRleDecode(const uint8_t* data, size_t length, uint8_t* out, size_t capacity);
+
+/**
+ * @class MirrorDecoder
+ * @brief Rebuilds the mirrored framebuffer from MIRROR_FRAME payloads, e.g. in a host tool.
+ * @ingroup Remote
+ */
+class MirrorDecoder {
+public:
+    /**
+     * @brief Constructs a decoder for a framebuffer of the given tile dimensions.
+     * @param tile_width The width of the framebuffer in tiles.
+     * @param tile_height The height of the framebuffer in tiles.
+     */
+    MirrorDecoder(uint8_t tile_width, uint8_t tile_height);
+
+    /**
+     * @brief Applies one MIRROR_FRAME payload.
+     * @details A malformed record is counted in errors() and leaves the framebuffer unchanged.
+     * @param payload The payload, starting with the status byte.
+     * @param length The payload length.
+     * @return true if the payload was an end record, i.e. frame() now holds a complete frame.
+     */
+    bool apply(const uint8_t* payload, size_t length);
+
+    /**
+     * @brief Gets the framebuffer in U8g2 tile layout.
+     * @return tile_width * tile_height * 8 bytes.
+     */
+    const uint8_t* frame() const { return buffer.data(); }
+
+    /**
+     * @brief Gets a pixel of the framebuffer.
+     * @param x The column.
+     * @param y The row.
+     * @return true if the pixel is lit.
+     */
+    bool pixel(int x, int y) const;
+
+    /// @brief Gets the sequence number of the last completed frame.
+    uint16_t sequence() const { return last_sequence; }
+    /// @brief Gets the device time of the last completed frame in milliseconds.
+    uint32_t timeMs() const { return time_ms; }
+    /// @brief Gets the number of records that could not be decoded.
+    uint32_t errors() const { return error_count; }
+
+private:
+    uint8_t tile_width;           ///< The width in tiles.
+    uint8_t tile_height;          ///< The height in tiles.
+    std::vector<uint8_t> buffer;  ///< The rebuilt framebuffer.
+    std::vector<uint8_t> scratch; ///< One row of tiles, decoded before it is applied.
+    uint16_t last_sequence = 0;   ///< The sequence number of the last completed frame.
+    uint32_t time_ms = 0;         ///< The time of the last completed frame.
+    uint32_t error_count = 0;     ///< The number of malformed records.
+};
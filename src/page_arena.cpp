@@ -0,0 +1,61 @@
+/**
+ * @file page_arena.cpp
+ * @brief Implements the page arena and the page heap report.
+ */
+#include "page_arena.hpp"
+
+/// Gets the current free heap in bytes, or 0 where it cannot be measured.
+static uint32_t freeHeap() {
+#if defined(ARDUINO_ARCH_ESP32)
+    return ESP.getFreeHeap();
+#else
+    return 0;
+#endif
+}
+
+/// Gets the lowest free heap since boot in bytes, or 0 where it cannot be measured.
+static uint32_t minFreeHeap() {
+#if defined(ARDUINO_ARCH_ESP32)
+    return ESP.getMinFreeHeap();
+#else
+    return 0;
+#endif
+}
+
+void PageHeapReport::print(Print& out) const {
+    out.print("page cycles: ");
+    out.println((unsigned long)cycles);
+    out.print("leaking cycles: ");
+    out.println((unsigned long)leaking_cycles);
+    out.print("last delta bytes: ");
+    out.println((long)last_delta);
+    out.print("net delta bytes: ");
+    out.println((long)net_delta);
+    out.print("min free heap: ");
+    out.println((unsigned long)min_free);
+}
+
+void PageArena::release(Page* page) {
+    if (!page) return;
+    if (owns(page)) {
+        page->~Page();
+        current = nullptr;
+    } else {
+        delete page;
+    }
+
+    if (cycle_open) {
+        cycle_open = false;
+        int32_t delta = (int32_t)(freeHeap() - free_at_begin);
+        report.cycles++;
+        if (delta < 0) report.leaking_cycles++;
+        report.last_delta = delta;
+        report.net_delta += delta;
+        report.min_free = minFreeHeap();
+    }
+}
+
+void PageArena::beginCycle() {
+    free_at_begin = freeHeap();
+    cycle_open = true;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file page_arena.hpp
+ * @brief Defines PageArena, a reusable slab that pages are constructed in instead of the heap.
+ * @ingroup Pages
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "config.hpp"
+#include "pages.hpp"
+
+/**
+ * @struct PageHeapReport
+ * @brief Free-heap measurements taken around each page open/close cycle.
+ * @ingroup Pages
+ *
+ * A cycle starts just before a page is created and ends once it was destroyed. A
+ * non-zero delta means the page left memory allocated or freed something it did not
+ * allocate; with arena pages every delta should be zero.
+ */
+struct PageHeapReport {
+    uint32_t cycles = 0;         ///< The number of completed open/close cycles.
+    uint32_t leaking_cycles = 0; ///< The number of cycles that ended with less free heap than they started with.
+    int32_t last_delta = 0;      ///< The free-heap change of the last cycle in bytes.
+    int32_t net_delta = 0;       ///< The free-heap change summed over all cycles in bytes.
+    uint32_t min_free = 0;       ///< The lowest free heap since boot, as of the last cycle.
+
+    /**
+     * @brief Prints the cycle count and the heap deltas.
+     * @param out The stream to print to, e.g. Serial.
+     */
+    void print(Print& out) const;
+};
+
+/**
+ * @class PageArena
+ * @brief Holds the open page in a fixed-size slab, so opening and closing pages never touches the heap.
+ * @ingroup Pages
+ *
+ * The RingController shows one page at a time, so a single slot of PAGE_ARENA_SIZE
+ * bytes is reused for every page. Pages created with `new` are still accepted by
+ * release(), which deletes them.
+ */
+class PageArena {
+public:
+    PageArena() = default;
+    PageArena(const PageArena&) = delete;
+    PageArena& operator=(const PageArena&) = delete;
+
+    /**
+     * @brief Constructs a page in the slab.
+     * @tparam T The page type. Must fit in PAGE_ARENA_SIZE bytes.
+     * @param args The arguments forwarded to the page's constructor.
+     * @return The page, or nullptr if the slab is still occupied by another page.
+     */
+    template <typename T, typename... Args>
+    T* emplace(Args&&... args) {
+        static_assert(std::is_base_of<Page, T>::value, "Only pages can be placed in the page arena");
+        static_assert(sizeof(T) <= PAGE_ARENA_SIZE, "Page type does not fit in PAGE_ARENA_SIZE");
+        static_assert(alignof(T) <= alignof(Slab), "Page type is over-aligned for the page arena");
+        if (current) return nullptr;
+        T* page = ::new (static_cast<void*>(&slab)) T(std::forward<Args>(args)...);
+        current = page;
+        return page;
+    }
+
+    /**
+     * @brief Destroys a page and completes the heap cycle started by beginCycle().
+     * @param page The page to destroy. Pages outside the slab are deleted. nullptr is ignored.
+     */
+    void release(Page* page);
+
+    /**
+     * @brief Checks whether a page lives in the slab.
+     * @param page The page to check.
+     * @return true if @p page is the page constructed in the slab.
+     */
+    bool owns(const Page* page) const { return page && page == current; }
+
+    /**
+     * @brief Records the free heap before a page is created. release() completes the cycle.
+     */
+    void beginCycle();
+
+    /**
+     * @brief Gets the heap measurements of the completed cycles.
+     * @return The report since the last resetReport().
+     */
+    const PageHeapReport& heapReport() const { return report; }
+
+    /**
+     * @brief Clears the heap measurements.
+     */
+    void resetReport() { report = PageHeapReport(); }
+
+private:
+    using Slab = typename std::aligned_storage<PAGE_ARENA_SIZE>::type;
+
+    Slab slab;                   ///< The storage the current page is constructed in.
+    Page* current = nullptr;     ///< The page in the slab, or nullptr if it is free.
+    bool cycle_open = false;     ///< True between beginCycle() and release().
+    uint32_t free_at_begin = 0;  ///< The free heap recorded by beginCycle().
+    PageHeapReport report;       ///< Accumulated heap measurements.
+};
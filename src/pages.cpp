@@ -5,53 +5,155 @@
 #include "pages.hpp"
 #include "config.hpp"
 #include "input.hpp"
+#include "config_store.hpp"
 #include <Arduino.h>
 
 // --- Page Base Class Implementation ---
 
 bool Page::handleInput() {
-    // The cancel button has the highest priority.
-    if (is_button_pressed(PIN_CANCEL)) {
-        return onCancel();
-    }
-
-    // Handle encoder rotation for scrolling.
-    RotaryDirection dir;
-    while ((dir = g_encoder.getDirection()) != RotaryDirection::NOROTATION) {
-        if (dir == RotaryDirection::CLOCKWISE) {
+    bool close = false;
+
+    // Events are handled in the order they happened. Draining stops at the event
+    // that closes the page, so later events are left for the menu underneath.
+    drainInput([&](const InputEvent& event) {
+        switch (event.type) {
+        case InputEventType::DETENT_CW:
+            scroll_steps = accelerator.steps(event);
             onScrollDown();
-        } else if (dir == RotaryDirection::COUNTERCLOCKWISE) {
+            break;
+        case InputEventType::DETENT_CCW:
+            scroll_steps = -accelerator.steps(event);
             onScrollUp();
+            break;
+        case InputEventType::PRESS:
+            close = onConfirm();
+            break;
+        case InputEventType::CANCEL:
+            close = onCancel();
+            break;
+        default:
+            return false;
         }
-    }
-
-    // Handle encoder button press for confirmation.
-    if (g_encoder.isPressed()) {
-        return onConfirm();
-    }
+        invalidate();
+        return close;
+    });
 
     // By default, the page does not exit and continues to be displayed.
-    return false;
+    return close;
 }
 
 // --- InfoPage Implementation ---
 
-InfoPage::InfoPage(String content)
+InfoPage::InfoPage(StringView content)
     : Page(),
       content(content), 
       total_lines(0), 
       target_scroll_offset(0),
-      current_scroll_y(0.0),
-      velocity_y(0.0),
-      scroll_pid(g_config.scroll_pid_kp, g_config.scroll_pid_ki, g_config.scroll_pid_kd)
+      scroll_y(AnimationGains::SCROLL, 0.0f)
 {
     entry_time = millis();
-    total_lines = 1;
-    for (unsigned int i = 0; i < content.length(); i++) {
-        if (content.charAt(i) == '\n') {
-            total_lines++;
+    OLED.setFont(u8g2_font_6x12_me);
+    buildLines();
+    OLED.setFont(DEFAULT_TEXT_FONT);
+    total_lines = lines.size();
+}
+
+/// The width available to InfoPage text, leaving room for the scrollbar.
+static constexpr int INFO_TEXT_WIDTH = SCREEN_WIDTH - 4;
+
+/**
+ * @brief Measures a text in the current font.
+ * @details A text longer than MAX_MEASURED_TEXT bytes is treated as too wide, which
+ * cannot happen for text that fits on the screen.
+ */
+static int measureText(StringView text) {
+    if (text.size() > MAX_MEASURED_TEXT) return INT16_MAX;
+    char buffer[MAX_MEASURED_TEXT + 1];
+    text.copyTo(buffer, sizeof(buffer));
+    return OLED.getUTF8Width(buffer);
+}
+
+/**
+ * @brief Finds the first display line of a paragraph, wrapped to the text width.
+ * @details Greedy word wrap: the line takes as many words as fit, and the spaces at a
+ * wrap are left for the caller to drop. A word wider than the screen is broken at the
+ * last character that fits, never inside a UTF-8 sequence.
+ * @param paragraph The text, without newlines.
+ * @return The length of the line, which is at least one character unless the paragraph is empty.
+ */
+static size_t fitLine(StringView paragraph) {
+    size_t end = paragraph.size();
+    size_t line_end = 0;
+    while (line_end < end) {
+        size_t word_end = line_end;
+        while (word_end < end && paragraph[word_end] == ' ') word_end++;
+        while (word_end < end && paragraph[word_end] != ' ') word_end++;
+        if (measureText(paragraph.substr(0, word_end)) > INFO_TEXT_WIDTH) break;
+        line_end = word_end;
+    }
+
+    if (line_end == 0) {
+        // The first word alone is too wide. The first character is always taken so
+        // that wrapping makes progress.
+        while (line_end < end) {
+            size_t next = line_end + 1;
+            while (next < end && (paragraph[next] & 0xC0) == 0x80) next++;
+            if (line_end > 0 && measureText(paragraph.substr(0, next)) > INFO_TEXT_WIDTH) break;
+            line_end = next;
         }
     }
+    return line_end;
+}
+
+/**
+ * @brief Splits the content into display lines.
+ * @details Wraps the content twice: once to count the lines and once to store them, so
+ * the table is allocated exactly once instead of growing line by line.
+ */
+void InfoPage::buildLines() {
+    size_t count = 0;
+    auto countLine = [&count](size_t, size_t) { count++; };
+    forEachLine(countLine);
+
+    lines.reserve(count);
+    auto storeLine = [this](size_t offset, size_t length) { lines.push_back(Line{(uint32_t)offset, (uint16_t)length}); };
+    forEachLine(storeLine);
+}
+
+/**
+ * @brief Calls emit(offset, length) for each display line of the content.
+ * @details Every newline starts a new line, so an empty content or a trailing newline
+ * still produces an (empty) line, as before.
+ */
+template <typename Emit>
+void InfoPage::forEachLine(Emit& emit) const {
+    size_t begin = 0;
+    while (true) {
+        size_t newline = content.find('\n', begin);
+        size_t end = newline == StringView::npos ? content.size() : newline;
+        wrapParagraph(begin, end, emit);
+        if (newline == StringView::npos) break;
+        begin = newline + 1;
+    }
+}
+
+/**
+ * @brief Calls emit(offset, length) for each display line of one paragraph.
+ */
+template <typename Emit>
+void InfoPage::wrapParagraph(size_t begin, size_t end, Emit& emit) const {
+    if (begin == end) {
+        emit(begin, 0);
+        return;
+    }
+
+    size_t line_start = begin;
+    while (line_start < end) {
+        size_t length = fitLine(content.substr(line_start, end - line_start));
+        emit(line_start, length);
+        line_start += length;
+        while (line_start < end && content[line_start] == ' ') line_start++;
+    }
 }
 
 void InfoPage::onScrollUp() {
@@ -68,49 +170,24 @@ void InfoPage::constrainScroll() {
     int visible_lines = SCREEN_HEIGHT / DEFAULT_TEXT_HEIGHT;
     int max_scroll = max(0, total_lines - visible_lines);
     target_scroll_offset = constrain(target_scroll_offset, 0, max_scroll);
+    scroll_y.animateTo(target_scroll_offset * DEFAULT_TEXT_HEIGHT);
 }
 
 void InfoPage::draw(int y_offset) {
-    // Animate the scroll position for a smooth effect.
-    double target_y = target_scroll_offset * DEFAULT_TEXT_HEIGHT;
-    if (abs(target_y - current_scroll_y) > 0.1 || abs(velocity_y) > 0.1) {
-        velocity_y = scroll_pid.update(target_y, current_scroll_y);
-        current_scroll_y += velocity_y;
-    } else {
-        current_scroll_y = target_y;
-    }
-
-    // Drawing
     OLED.setDrawColor(0);
     OLED.drawBox(0, y_offset, SCREEN_WIDTH, SCREEN_HEIGHT);
     OLED.setDrawColor(1);
     OLED.setFont(u8g2_font_6x12_me);
 
-    int start_pos = 0;
-    int newline_pos;
-    int line_num = 0;
-
-    while (start_pos < (int)content.length()) {
-        newline_pos = content.indexOf('\n', start_pos);
-        String line;
-        if (newline_pos == -1) {
-            line = content.substring(start_pos);
-            start_pos = content.length();
-        } else {
-            line = content.substring(start_pos, newline_pos);
-            start_pos = newline_pos + 1;
-        }
-
-        // Calculate y position for the line, considering the animated scroll.
-        int line_y_pos = DEFAULT_TEXT_HEIGHT * (line_num + 1) - round(current_scroll_y);
-        
-        // Culling: Only draw lines that are actually visible on screen.
-        if (line_y_pos > -DEFAULT_TEXT_HEIGHT && line_y_pos < SCREEN_HEIGHT + DEFAULT_TEXT_HEIGHT) {
-            OLED.setCursor(0, line_y_pos + y_offset);
-            OLED.print(line);
-        }
-        
-        line_num++;
+    // Only the lines that intersect the screen are drawn. Line i has its baseline at
+    // DEFAULT_TEXT_HEIGHT * (i + 1), minus the animated scroll position.
+    int scroll = scroll_y.rounded();
+    int first_line = max(0, scroll / DEFAULT_TEXT_HEIGHT);
+    int last_line = min(total_lines - 1, (scroll + SCREEN_HEIGHT) / DEFAULT_TEXT_HEIGHT);
+    for (int line_num = first_line; line_num <= last_line; line_num++) {
+        int line_y_pos = DEFAULT_TEXT_HEIGHT * (line_num + 1) - scroll;
+        OLED.setCursor(0, line_y_pos + y_offset);
+        content.substr(lines[line_num].offset, lines[line_num].length).printTo(OLED);
     }
     
     // Scrollbar
@@ -120,7 +197,7 @@ void InfoPage::draw(int y_offset) {
 
         int slider_height = 5;
         int max_scroll_pixels = (total_lines - visible_lines) * DEFAULT_TEXT_HEIGHT;
-        float scroll_percentage = max_scroll_pixels > 0 ? current_scroll_y / max_scroll_pixels : 0;
+        float scroll_percentage = max_scroll_pixels > 0 ? toFloat(scroll_y.value()) / max_scroll_pixels : 0;
         
         int travel_distance = SCREEN_HEIGHT - slider_height;
         int slider_y = scroll_percentage * travel_distance;
@@ -132,10 +209,173 @@ void InfoPage::draw(int y_offset) {
 }
 
 
+// --- StreamInfoPage Implementation ---
+
+StreamInfoPage::StreamInfoPage(TextSource& source)
+    : Page(),
+      source(source),
+      cache(source),
+      top(0),
+      above(NO_LINE),
+      top_line(0),
+      scroll_y(AnimationGains::SCROLL, 0.0f)
+{}
+
+/**
+ * @brief Reads and wraps the display line that starts at a byte offset.
+ * @details Reads at most MAX_MEASURED_TEXT + 1 bytes, which is always more than fits
+ * on the screen, so fitLine() never accepts a word cut off by the end of the buffer.
+ * The spaces at a wrap and the newline, LF or CRLF, that ends a paragraph belong to no line.
+ */
+size_t StreamInfoPage::readLine(size_t start, char* buffer, size_t& length) {
+    size_t count = cache.copy(start, buffer, LINE_BUFFER_SIZE);
+    StringView paragraph(buffer, count);
+    size_t newline = paragraph.find('\n');
+    if (newline != StringView::npos) {
+        if (newline > 0 && paragraph[newline - 1] == '\r') newline--;
+        paragraph = paragraph.substr(0, newline);
+    }
+
+    length = fitLine(paragraph);
+    size_t next = start + length;
+    while (cache.at(next) == ' ') next++;
+    if (cache.at(next) == '\r' && cache.at(next + 1) == '\n') next++;
+    if (cache.at(next) == '\n') next++;
+    return next;
+}
+
+size_t StreamInfoPage::nextLine(size_t start) {
+    char buffer[LINE_BUFFER_SIZE];
+    size_t length;
+    return readLine(start, buffer, length);
+}
+
+/**
+ * @brief Finds the start of the display line before the one at @p start.
+ * @details Scans back to the beginning of the paragraph, at most STREAM_MAX_BACKSCAN
+ * bytes, then wraps forward from there: wrapping only works from the start of a paragraph.
+ * In a longer paragraph the wrap from the scan limit can step over @p start; then the
+ * longest line that ends exactly at @p start is taken, so that scrolling up neither
+ * repeats nor skips text.
+ */
+size_t StreamInfoPage::prevLine(size_t start) {
+    size_t limit = start > STREAM_MAX_BACKSCAN ? start - STREAM_MAX_BACKSCAN : 0;
+    // Skip the newline that ends the previous paragraph, if @p start begins a new one.
+    size_t begin = start - 1;
+    while (begin > limit && cache.at(begin - 1) != '\n') begin--;
+
+    size_t line = begin;
+    size_t next = nextLine(line);
+    while (next < start) {
+        line = next;
+        next = nextLine(line);
+    }
+    if (next == start || begin == 0 || cache.at(begin - 1) == '\n') return line;
+
+    size_t candidate = start > LINE_BUFFER_SIZE ? start - LINE_BUFFER_SIZE : 0;
+    for (; candidate < start; candidate++) {
+        if (nextLine(candidate) == start) return candidate;
+    }
+    return line;
+}
+
+/**
+ * @brief Checks whether a full screen of lines follows the line at @p start.
+ */
+bool StreamInfoPage::fillsScreen(size_t start) {
+    for (int i = 0; i < VISIBLE_LINES; i++) {
+        if (start >= cache.size()) return false;
+        start = nextLine(start);
+    }
+    return true;
+}
+
+/**
+ * @brief Moves the top line down by one, if a full screen of text remains.
+ * @details The scroll animation is shifted by one line so that the text stays in place
+ * and then slides up to the new top line. Only one line above the top is kept, so the
+ * shift is limited to one line when scrolling faster than the animation.
+ */
+void StreamInfoPage::onScrollDown() {
+    OLED.setFont(u8g2_font_6x12_me);
+    size_t next = nextLine(top);
+    if (fillsScreen(next)) {
+        above = top;
+        top = next;
+        top_line++;
+        scroll_y.jumpTo(max(-DEFAULT_TEXT_HEIGHT, scroll_y.rounded() - DEFAULT_TEXT_HEIGHT));
+        scroll_y.animateTo(0);
+    }
+    OLED.setFont(DEFAULT_TEXT_FONT);
+}
+
+void StreamInfoPage::onScrollUp() {
+    if (top == 0) return;
+
+    OLED.setFont(u8g2_font_6x12_me);
+    top = above != NO_LINE ? above : prevLine(top);
+    above = top > 0 ? prevLine(top) : NO_LINE;
+    top_line--;
+    scroll_y.jumpTo(min(DEFAULT_TEXT_HEIGHT, scroll_y.rounded() + DEFAULT_TEXT_HEIGHT));
+    scroll_y.animateTo(0);
+    OLED.setFont(DEFAULT_TEXT_FONT);
+}
+
+void StreamInfoPage::draw(int y_offset) {
+    OLED.setDrawColor(0);
+    OLED.drawBox(0, y_offset, SCREEN_WIDTH, SCREEN_HEIGHT);
+    OLED.setDrawColor(1);
+    OLED.setFont(u8g2_font_6x12_me);
+
+    // The top line has its baseline at DEFAULT_TEXT_HEIGHT minus the animated scroll
+    // position, which is nonzero only while a scroll step is animating.
+    char buffer[LINE_BUFFER_SIZE];
+    size_t length;
+    int scroll = scroll_y.rounded();
+    if (scroll < 0 && above != NO_LINE) {
+        readLine(above, buffer, length);
+        OLED.setCursor(0, -scroll + y_offset);
+        StringView(buffer, length).printTo(OLED);
+    }
+
+    size_t line = top;
+    for (int line_y_pos = DEFAULT_TEXT_HEIGHT - scroll;
+         line_y_pos - DEFAULT_TEXT_HEIGHT < SCREEN_HEIGHT && line < cache.size();
+         line_y_pos += DEFAULT_TEXT_HEIGHT) {
+        line = readLine(line, buffer, length);
+        OLED.setCursor(0, line_y_pos + y_offset);
+        StringView(buffer, length).printTo(OLED);
+    }
+
+    // Scrollbar. Without a line count from the source, the byte position of the top
+    // line stands in for its line index.
+    if (top > 0 || line < cache.size()) {
+        OLED.drawVLine(SCREEN_WIDTH - 2, y_offset, SCREEN_HEIGHT);
+
+        int slider_height = 5;
+        int line_count = source.lineCount();
+        float scroll_percentage;
+        if (line_count > VISIBLE_LINES) {
+            scroll_percentage = (float)top_line / (line_count - VISIBLE_LINES);
+        } else {
+            scroll_percentage = cache.size() > 0 ? (float)top / cache.size() : 0;
+        }
+        scroll_percentage = constrain(scroll_percentage, 0.0f, 1.0f);
+
+        int travel_distance = SCREEN_HEIGHT - slider_height;
+        int slider_y = scroll_percentage * travel_distance;
+
+        OLED.drawBox(SCREEN_WIDTH - 3, y_offset + slider_y, 2, slider_height);
+    }
+
+    OLED.setFont(DEFAULT_TEXT_FONT);
+}
+
 
 // --- EditFloatPage Implementation ---
 
-EditFloatPage::EditFloatPage(const char* title, float* value, float step, float min, float max)
+EditFloatPage::EditFloatPage(const char* title, float* value, float step, float min, float max,
+                             const AccelerationCurve* acceleration)
     : Page(),
       title(title), 
       value_ptr(value), 
@@ -143,17 +383,19 @@ EditFloatPage::EditFloatPage(const char* title, float* value, float step, float
       step(step), min(min), max(max),
       show_progress(min != max),
       progress_bar(0, DEFAULT_TEXT_HEIGHT * 2 + 2, SCREEN_WIDTH, DEFAULT_PROGRESS_HEIGHT) 
-{}
+{
+    setAcceleration(acceleration);
+}
 
 void EditFloatPage::onScrollUp() {
-    current_value -= step;
+    current_value -= step * scrollSteps();
     if (show_progress) {
         current_value = constrain(current_value, min, max);
     }
 }
 
 void EditFloatPage::onScrollDown() {
-    current_value += step;
+    current_value += step * scrollSteps();
     if (show_progress) {
         current_value = constrain(current_value, min, max);
     }
@@ -191,6 +433,11 @@ RebootPage::RebootPage()
     entry_time = millis();
 }
 
+bool RebootPage::needsRedraw() const {
+    // The reboot timeout is checked in draw(), so the page must keep drawing.
+    return true;
+}
+
 bool RebootPage::onCancel() {
     // Allow canceling the reboot only within the time limit.
     return (millis() - entry_time < 3000);
@@ -199,6 +446,7 @@ bool RebootPage::onCancel() {
 void RebootPage::draw(int y_offset) {
     // If the timeout is reached, reboot. This is checked on every frame draw.
     if (millis() - entry_time >= 3000) {
+        g_config_store.flush();
         ESP.restart();
     }
 
@@ -6,9 +6,14 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include <vector>
 #include "config.hpp"
 #include "ui_components.hpp"
-#include "pid.hpp"
+#include "input.hpp"
+#include "animation.hpp"
+#include "string_view.hpp"
+#include "text_source.hpp"
 
 /**
  * @class Page
@@ -28,8 +33,8 @@ public:
     /**
      * @brief Handles all user input for the page.
      * 
-     * This method is called repeatedly by the RingController's main loop. It checks for
-     * rotary encoder and button inputs and calls the corresponding virtual methods.
+     * This method is called repeatedly by the RingController's main loop. It drains the
+     * queued input events in order and calls the corresponding virtual methods.
      * @return true if the page should be closed, false otherwise.
      */
     bool handleInput();
@@ -41,6 +46,33 @@ public:
      */
     virtual void draw(int y_offset) = 0;
 
+    /**
+     * @brief Advances the page's own animations. Called once per frame before draw().
+     * @param dt The elapsed time since the last frame in animation steps of ANIMATION_REFERENCE_MS.
+     */
+    virtual void animate(AnimValue /*dt*/) {}
+
+    /**
+     * @brief Checks whether the page content changed since it was last drawn.
+     *
+     * The RingController only redraws a page while this returns true, so a static page
+     * costs no rendering or display traffic. Pages whose animations use the global
+     * animation engine are redrawn while those move; subclasses that change over time
+     * in other ways should override this and return true while they do.
+     * @return true if the page must be redrawn on the next frame.
+     */
+    virtual bool needsRedraw() const { return redraw_pending; }
+
+    /**
+     * @brief Marks the page content as changed so that it is redrawn on the next frame.
+     */
+    void invalidate() { redraw_pending = true; }
+
+    /**
+     * @brief Clears the pending redraw flag. Called by the RingController before drawing.
+     */
+    void markDrawn() { redraw_pending = false; }
+
 protected:
     /// @brief Called when a scroll-up input is detected.
     /// @details Subclasses should override this to handle upward scrolling or value decrementing.
@@ -61,6 +93,23 @@ protected:
      * @return true if the page should close after cancellation. Defaults to true.
      */
     virtual bool onCancel() { return true; }
+
+    /**
+     * @brief Opts the page into encoder acceleration.
+     * @param curve The curve that scrollSteps() follows, or nullptr for one step per detent.
+     */
+    void setAcceleration(const AccelerationCurve* curve) { accelerator.setCurve(curve); }
+
+    /**
+     * @brief Gets the steps the detent being handled stands for. Valid in onScrollUp() and onScrollDown().
+     * @return 1 unless the page set an acceleration curve and the encoder is spun fast.
+     */
+    int scrollSteps() const { return scroll_steps; }
+
+private:
+    bool redraw_pending = true; ///< True if the content changed since the last draw.
+    DetentAccelerator accelerator; ///< Measures the spin speed for scrollSteps().
+    int scroll_steps = 1; ///< The steps of the detent being handled.
 };
 
 /// @brief Global U8g2 display driver object, used by pages for drawing.
@@ -71,14 +120,21 @@ extern DisplayDriver OLED;
  * @class InfoPage
  * @brief A page that displays multi-line, scrollable text content.
  * @ingroup Pages
+ *
+ * The content is split into display lines once, at construction: at each newline, and
+ * word-wrapped wherever a line would run past the screen width in the page's font. The
+ * lines are counted first, so the line table is allocated once at its final size.
+ * Drawing then starts directly at the first visible line, so long texts cost no more
+ * per frame than short ones.
  */
 class InfoPage : public Page {
 public:
     /**
      * @brief Construct a new Info Page object
-     * @param content The multi-line string content to display.
+     * @param content The multi-line string content to display. The text is not copied
+     * and must outlive the page, e.g. a string literal.
      */
-    InfoPage(String content);
+    InfoPage(StringView content);
     void draw(int y_offset) override;
 
 protected:
@@ -86,17 +142,84 @@ protected:
     void onScrollDown() override;
 
 private:
+    /// A display line: a slice of the content.
+    struct Line {
+        uint32_t offset; ///< The index of the line's first character in the content.
+        uint16_t length; ///< The number of characters in the line.
+    };
+
     /// @brief Constrains the target scroll offset to be within the valid range.
     void constrainScroll();
-    String content; ///< The text content displayed on the page.
+    /// @brief Splits the content into display lines. Uses the current font.
+    void buildLines();
+    /// @brief Calls emit(offset, length) for each display line of the content.
+    template <typename Emit>
+    void forEachLine(Emit& emit) const;
+    /// @brief Calls emit(offset, length) for each display line of one paragraph.
+    template <typename Emit>
+    void wrapParagraph(size_t begin, size_t end, Emit& emit) const;
+
+    StringView content; ///< The text content displayed on the page.
+    std::vector<Line> lines; ///< The display lines, in order.
     unsigned long entry_time; ///< The time when the page was created.
-    int total_lines; ///< The total number of lines in the content string.
+    int total_lines; ///< The total number of display lines.
 
     // Scrolling animation variables
     int target_scroll_offset; ///< Target line index for scrolling.
-    double current_scroll_y;  ///< Current scroll position in pixels for smooth animation.
-    double velocity_y; ///< Current scroll velocity.
-    PIDController scroll_pid; ///< PID controller for smooth scrolling animation.
+    Animation scroll_y; ///< Animated scroll position in pixels for smooth scrolling.
+};
+
+/**
+ * @class StreamInfoPage
+ * @brief A scrollable text page that reads its content on demand from a TextSource.
+ * @ingroup Pages
+ *
+ * Shows texts too large for RAM, such as log files, with the same wrapping as InfoPage.
+ * Instead of a line table, the page only knows the byte offset of its top line and of
+ * the line above it; lines are wrapped as they are drawn, from a ChunkCache holding the
+ * text around the scroll position. The scrollbar uses the source's line count if it
+ * has one, and the byte position otherwise.
+ */
+class StreamInfoPage : public Page {
+public:
+    /**
+     * @brief Construct a new Stream Info Page object
+     * @param source The text to display. It must outlive the page.
+     */
+    StreamInfoPage(TextSource& source);
+    void draw(int y_offset) override;
+
+protected:
+    void onScrollUp() override;
+    void onScrollDown() override;
+
+    /// @brief Gets the byte offset of the top line.
+    size_t topOffset() const { return top; }
+    /// @brief Gets the byte offset of the line after the one at @p start. Uses the current font.
+    size_t nextLine(size_t start);
+    /// @brief Gets the byte offset of the line before the one at @p start, which must not be 0.
+    size_t prevLine(size_t start);
+
+private:
+    /// Marks that there is no line above the top line.
+    static constexpr size_t NO_LINE = (size_t)-1;
+    /// The number of lines that fit on the screen.
+    static constexpr int VISIBLE_LINES = SCREEN_HEIGHT / DEFAULT_TEXT_HEIGHT;
+    /// Room for more than one display line of text.
+    static constexpr size_t LINE_BUFFER_SIZE = MAX_MEASURED_TEXT + 1;
+
+    /// @brief Reads the display line at a byte offset. Uses the current font.
+    /// @return The byte offset of the next line.
+    size_t readLine(size_t start, char* buffer, size_t& length);
+    /// @brief Checks whether a full screen of lines starts at @p start.
+    bool fillsScreen(size_t start);
+
+    TextSource& source; ///< The text displayed on the page.
+    ChunkCache cache;   ///< The text around the scroll position.
+    size_t top;         ///< The byte offset of the top line.
+    size_t above;       ///< The byte offset of the line above the top line, or NO_LINE.
+    int top_line;       ///< The index of the top line.
+    Animation scroll_y; ///< Animated pixel offset from the top line, for smooth scrolling.
 };
 
 /**
@@ -110,11 +233,13 @@ public:
      * @brief Construct a new Edit Float Page object
      * @param title The title displayed at the top of the page.
      * @param value A pointer to the float value to be edited.
-     * @param step The increment/decrement amount for each scroll event.
+     * @param step The increment/decrement amount for each scroll event, multiplied when the encoder is spun fast.
      * @param min The minimum allowed value. If min and max are different, a progress bar is shown.
      * @param max The maximum allowed value. If min and max are different, a progress bar is shown.
+     * @param acceleration The encoder acceleration, or nullptr for exactly one step per detent.
      */
-    EditFloatPage(const char* title, float* value, float step, float min = 0.0f, float max = 0.0f);
+    EditFloatPage(const char* title, float* value, float step, float min = 0.0f, float max = 0.0f,
+                  const AccelerationCurve* acceleration = &VALUE_ACCELERATION);
     void draw(int y_offset) override;
 
 protected:
@@ -140,6 +265,7 @@ class RebootPage : public Page {
 public:
     RebootPage();
     void draw(int y_offset) override;
+    bool needsRedraw() const override;
 
 protected:
     bool onCancel() override;
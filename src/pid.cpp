@@ -1,17 +1,19 @@
 /**
  * @file pid.cpp
- * @brief Implements the PIDController class.
+ * @brief Implements the PIDController class template.
  */
 #include "pid.hpp"
 #include <Arduino.h>
 
-PIDController::PIDController(float kp, float ki, float kd, float integral_limit)
-    : kp(kp), ki(ki), kd(kd), integral(0.0f), last_error(0.0f), integral_limit(integral_limit) {}
+template <typename T>
+BasicPIDController<T>::BasicPIDController(T kp, T ki, T kd, T integral_limit)
+    : kp(kp), ki(ki), kd(kd), integral(T(0)), last_error(T(0)), integral_limit(integral_limit) {}
 
 /**
  * @brief Sets new gain values for the controller.
  */
-void PIDController::set_gains(float kp, float ki, float kd) {
+template <typename T>
+void BasicPIDController<T>::set_gains(T kp, T ki, T kd) {
     this->kp = kp;
     this->ki = ki;
     this->kd = kd;
@@ -19,23 +21,33 @@ void PIDController::set_gains(float kp, float ki, float kd) {
 
 /**
  * @brief Calculates the PID output for a given target and current value.
+ * @details The integral and derivative terms are scaled by the elapsed time, so a dt of 1
+ * reproduces the classic per-frame controller the gains were tuned with.
  */
-float PIDController::update(float target, float current) {
-    float error = target - current;
-    
-    integral += error;
+template <typename T>
+T BasicPIDController<T>::update(T target, T current, T dt) {
+    T error = target - current;
+
+    integral += error * dt;
     integral = constrain(integral, -integral_limit, integral_limit);
-    
-    float derivative = error - last_error;
+
+    T derivative = dt > T(0) ? (error - last_error) / dt : T(0);
     last_error = error;
-    
+
     return kp * error + ki * integral + kd * derivative;
 }
 
 /**
  * @brief Resets the controller's internal state.
  */
-void PIDController::reset() {
-    integral = 0.0f;
-    last_error = 0.0f;
-}
\ No newline at end of file
+template <typename T>
+void BasicPIDController<T>::reset() {
+    integral = T(0);
+    last_error = T(0);
+}
+
+// The float and double paths are kept alongside the configured AnimValue so the
+// animation math can be compared across number types.
+template class BasicPIDController<float>;
+template class BasicPIDController<double>;
+template class BasicPIDController<Fixed16>;
@@ -1,20 +1,38 @@
 /**
  * @file pid.hpp
- * @brief Defines the PIDController class.
+ * @brief Defines the PIDController class template and the animation number type.
  * @defgroup PID
  * @{
  */
 #pragma once
 
+#include "fixed.hpp"
+
+/**
+ * @brief The number type used for all animation state and PID math.
+ * @ingroup PID
+ *
+ * Defaults to float. Build with `-DRINGUI_FIXED_POINT` to use Q16.16 fixed point
+ * instead, which avoids floating-point math in the per-frame animation path entirely.
+ */
+#if defined(RINGUI_FIXED_POINT)
+using AnimValue = Fixed16;
+#else
+using AnimValue = float;
+#endif
+
 /**
- * @class PIDController
+ * @class BasicPIDController
  * @brief A simple Proportional-Integral-Derivative (PID) controller.
  * @ingroup PID
- * 
+ *
  * Used for creating smooth, organic-looking animations for UI elements
  * by calculating an "effort" value to move a current value towards a target.
+ * It is instantiated for float, double and Fixed16.
+ * @tparam T The number type of the controller state.
  */
-class PIDController {
+template <typename T>
+class BasicPIDController {
 public:
     /**
      * @brief Constructs a new PIDController.
@@ -23,7 +41,7 @@ public:
      * @param kd Derivative gain.
      * @param integral_limit The maximum absolute value for the integral term to prevent windup.
      */
-    PIDController(float kp, float ki, float kd, float integral_limit = 20.0f);
+    BasicPIDController(T kp, T ki, T kd, T integral_limit = T(20));
 
     /**
      * @brief Sets new gain values for the controller.
@@ -31,15 +49,17 @@ public:
      * @param ki New integral gain.
      * @param kd New derivative gain.
      */
-    void set_gains(float kp, float ki, float kd);
+    void set_gains(T kp, T ki, T kd);
 
     /**
      * @brief Calculates the PID output for a given target and current value.
      * @param target The desired value.
      * @param current The current value.
-     * @return The calculated output (e.g., velocity) to apply to the current value.
+     * @param dt The elapsed time in animation steps of ANIMATION_REFERENCE_MS.
+     * @return The calculated output (e.g., velocity) per animation step. Apply it to the
+     * current value scaled by @p dt.
      */
-    float update(float target, float current);
+    T update(T target, T current, T dt = T(1));
 
     /**
      * @brief Resets the controller's internal state (integral and last error).
@@ -47,9 +67,13 @@ public:
     void reset();
 
 private:
-    float kp, ki, kd; ///< PID gain values.
-    float integral; ///< The accumulated integral term.
-    float last_error; ///< The error from the previous update cycle.
-    float integral_limit; ///< The limit for the integral term to prevent windup.
+    T kp, ki, kd; ///< PID gain values.
+    T integral; ///< The accumulated integral term.
+    T last_error; ///< The error from the previous update cycle.
+    T integral_limit; ///< The limit for the integral term to prevent windup.
 };
-/** @} */
\ No newline at end of file
+
+/// @brief The PID controller used by the animation engine, on the configured AnimValue type.
+/// @ingroup PID
+using PIDController = BasicPIDController<AnimValue>;
+/** @} */
@@ -0,0 +1,85 @@
+/**
+ * @file profiler.cpp
+ * @brief Implements the FrameProfiler class.
+ */
+#include "profiler.hpp"
+
+#if defined(RINGUI_PROFILER)
+
+void FrameProfiler::beginFrame() {
+    uint32_t now = micros();
+    current = FrameSample();
+    current.start_us = now;
+    last_mark = now;
+    active = true;
+}
+
+void FrameProfiler::mark(FramePhase phase) {
+    if (!active) return;
+    uint32_t now = micros();
+    uint32_t total = current.phase_us[(int)phase] + (now - last_mark);
+    current.phase_us[(int)phase] = total > UINT16_MAX ? UINT16_MAX : total;
+    if (phase == FramePhase::TRANSFER) current.drawn = true;
+    last_mark = now;
+}
+
+void FrameProfiler::endFrame() {
+    if (!active) return;
+    mark(FramePhase::SLEEP);
+    samples[head] = current;
+    head = (head + 1) % PROFILER_SAMPLES;
+    if (count < PROFILER_SAMPLES) count++;
+    active = false;
+}
+
+const FrameSample& FrameProfiler::sample(int index) const {
+    int oldest = (head - count + PROFILER_SAMPLES) % PROFILER_SAMPLES;
+    return samples[(oldest + index) % PROFILER_SAMPLES];
+}
+
+/**
+ * @brief Gets the number of frames drawn in the last second of recorded frames.
+ * @details Counts back from the newest frame. If the recorded frames cover less than a
+ * second, the rate is extrapolated from the time they do cover.
+ */
+uint32_t FrameProfiler::fps() const {
+    if (count == 0) return 0;
+    const FrameSample& newest = sample(count - 1);
+    uint32_t end_us = newest.start_us;
+    for (int p = 0; p < FRAME_PHASE_COUNT; p++) end_us += newest.phase_us[p];
+    uint32_t drawn = 0;
+    uint32_t span = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        const FrameSample& s = sample(i);
+        if (end_us - s.start_us > 1000000UL) return drawn;
+        if (s.drawn) drawn++;
+        span = end_us - s.start_us;
+    }
+    if (span == 0) return drawn;
+    return (uint32_t)((uint64_t)drawn * 1000000ULL / span);
+}
+
+uint32_t FrameProfiler::worstFrameUs() const {
+    uint32_t worst = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t busy = sample(i).busyUs();
+        if (busy > worst) worst = busy;
+    }
+    return worst;
+}
+
+void FrameProfiler::dump(Print& out) const {
+    out.println("start_us,input_us,animate_us,draw_us,transfer_us,sleep_us,drawn");
+    for (int i = 0; i < count; i++) {
+        const FrameSample& s = sample(i);
+        out.print((unsigned long)s.start_us);
+        for (int p = 0; p < FRAME_PHASE_COUNT; p++) {
+            out.print(',');
+            out.print((unsigned long)s.phase_us[p]);
+        }
+        out.print(',');
+        out.println(s.drawn ? "1" : "0");
+    }
+}
+
+#endif
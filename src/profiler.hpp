@@ -0,0 +1,135 @@
+/**
+ * @file profiler.hpp
+ * @brief Defines FrameProfiler, which records how long each phase of a UI frame takes.
+ * @ingroup UI
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "config.hpp"
+
+/**
+ * @enum FramePhase
+ * @brief The parts of a UI frame that the profiler times separately.
+ * @ingroup UI
+ */
+enum class FramePhase : uint8_t {
+    HANDLE_INPUT, ///< Draining input events and running the actions they trigger.
+    ANIMATE,      ///< Advancing animations.
+    DRAW,         ///< Rendering into the framebuffer, including label and switch state callbacks.
+    TRANSFER,     ///< Handing the frame to the display, i.e. the bus transfer or the render task fence.
+    SLEEP         ///< Waiting for the next frame period.
+};
+
+/// The number of FramePhase values.
+/// @ingroup UI
+static constexpr int FRAME_PHASE_COUNT = 5;
+
+/**
+ * @struct FrameSample
+ * @brief The phase timings of one UI loop iteration.
+ * @ingroup UI
+ */
+struct FrameSample {
+    uint32_t start_us;                    ///< The value of micros() at the start of the frame.
+    uint16_t phase_us[FRAME_PHASE_COUNT]; ///< The time spent in each phase, saturated at 65535.
+    bool drawn;                           ///< True if the frame was rendered and presented.
+
+    /**
+     * @brief Gets the time the frame took without sleeping.
+     * @return The sum of all phases but SLEEP, in microseconds.
+     */
+    uint32_t busyUs() const {
+        uint32_t busy = 0;
+        for (int i = 0; i < FRAME_PHASE_COUNT; i++) {
+            if (i != (int)FramePhase::SLEEP) busy += phase_us[i];
+        }
+        return busy;
+    }
+};
+
+#if defined(RINGUI_PROFILER)
+
+/**
+ * @class FrameProfiler
+ * @brief Timestamps the phases of each UI frame into a fixed ring buffer.
+ * @ingroup UI
+ *
+ * The controller calls beginFrame() at the start of every loop iteration, mark() at the
+ * end of each phase and endFrame() after the frame's sleep. The time since the previous
+ * call is added to the phase given, so phases that a loop skips stay zero. Only the last
+ * PROFILER_SAMPLES frames are kept; nothing is allocated.
+ *
+ * Enabled with the RINGUI_PROFILER build flag. Without it, FrameProfiler is an empty
+ * class whose functions are inline no-ops, so the instrumentation costs nothing.
+ */
+class FrameProfiler {
+public:
+    /// @brief Starts a frame. A frame that was not ended is discarded.
+    void beginFrame();
+
+    /**
+     * @brief Ends a phase of the current frame.
+     * @param phase The phase the time since the previous mark is added to.
+     */
+    void mark(FramePhase phase);
+
+    /// @brief Ends the current frame. The time since the last mark counts as SLEEP.
+    void endFrame();
+
+    /**
+     * @brief Gets the number of recorded frames.
+     * @return At most PROFILER_SAMPLES.
+     */
+    int sampleCount() const { return count; }
+
+    /**
+     * @brief Gets a recorded frame.
+     * @param index 0 for the oldest frame, up to sampleCount() - 1 for the newest.
+     * @return The frame's sample.
+     */
+    const FrameSample& sample(int index) const;
+
+    /**
+     * @brief Gets the number of frames drawn in the last second of recorded frames.
+     * @return The frame rate.
+     */
+    uint32_t fps() const;
+
+    /**
+     * @brief Gets the longest busy time of the recorded frames.
+     * @return The worst frame time in microseconds.
+     */
+    uint32_t worstFrameUs() const;
+
+    /**
+     * @brief Writes the recorded frames as CSV, oldest first.
+     * @param out The stream to print to, e.g. Serial.
+     */
+    void dump(Print& out) const;
+
+private:
+    FrameSample samples[PROFILER_SAMPLES]; ///< The ring buffer of recorded frames.
+    int head = 0;                          ///< The slot the next frame is stored in.
+    int count = 0;                         ///< The number of recorded frames.
+    FrameSample current;                   ///< The frame being measured.
+    uint32_t last_mark = 0;                ///< micros() at the previous mark.
+    bool active = false;                   ///< True between beginFrame() and endFrame().
+};
+
+#else
+
+/// The profiler with RINGUI_PROFILER undefined: every call compiles to nothing.
+class FrameProfiler {
+public:
+    void beginFrame() {}
+    void mark(FramePhase) {}
+    void endFrame() {}
+    int sampleCount() const { return 0; }
+    uint32_t fps() const { return 0; }
+    uint32_t worstFrameUs() const { return 0; }
+    void dump(Print&) const {}
+};
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file quadrature.cpp
+ * @brief Implements the quadrature decoder.
+ */
+#include "quadrature.hpp"
+
+/// The pulse from a state to the next, indexed by `(previous << 2) | next`. Clockwise
+/// runs 11, 10, 00, 01, 11. Kept in RAM because it is read from the encoder ISR.
+static const int8_t DRAM_ATTR PULSE_TABLE[16] = {
+     0, +1, -1,  0,
+    -1,  0,  0, +1,
+    +1,  0,  0, -1,
+     0, -1, +1,  0,
+};
+
+void QuadratureDecoder::reset(uint8_t state) {
+    rest_state = state;
+    this->state = state;
+    pending = false;
+    position = 0;
+}
+
+int IRAM_ATTR QuadratureDecoder::update(uint8_t state, uint32_t now_us) {
+    int detents = poll(now_us);
+    if (glitch_filter_us == 0) {
+        return detents + commit(state, now_us);
+    }
+    if (state == this->state) {
+        // Back where it was before the filter time passed: the change was a glitch.
+        pending = false;
+    } else if (!pending || state != pending_state) {
+        if (pending) {
+            // A third state: the pending one was a step on the way, not a glitch.
+            detents += commit(pending_state, pending_us);
+        }
+        pending_state = state;
+        pending_us = now_us;
+        pending = true;
+    }
+    return detents;
+}
+
+int IRAM_ATTR QuadratureDecoder::poll(uint32_t now_us) {
+    if (!pending || now_us - pending_us < glitch_filter_us) return 0;
+    return commit(pending_state, pending_us);
+}
+
+int IRAM_ATTR QuadratureDecoder::commit(uint8_t state, uint32_t since_us) {
+    position += PULSE_TABLE[(this->state << 2) | state];
+    this->state = state;
+    pending = false;
+
+    int detents = 0;
+    if (pulses_per_detent == 4) {
+        if (state != rest_state) return 0;
+        // Rounded, so one missed pulse still counts the detent.
+        if (position >= 2) {
+            detents = 1;
+        } else if (position <= -2) {
+            detents = -1;
+        }
+        position = 0;
+    } else if (position >= pulses_per_detent) {
+        position -= pulses_per_detent;
+        detents = 1;
+    } else if (position <= -pulses_per_detent) {
+        position += pulses_per_detent;
+        detents = -1;
+    }
+    if (detents) detent_us = since_us;
+    return detents;
+}
+
+// --- CounterDetents ---
+
+void CounterDetents::reset(int count) {
+    last_count = count;
+    pulses = 0;
+}
+
+int CounterDetents::update(int count) {
+    int delta = count - last_count;
+    if (delta > limit / 2) {
+        delta -= limit;
+    } else if (delta < -limit / 2) {
+        delta += limit;
+    }
+    last_count = count;
+    pulses += delta;
+
+    int detents = pulses / pulses_per_detent;
+    pulses -= detents * pulses_per_detent;
+    return detents;
+}
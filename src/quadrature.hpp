@@ -0,0 +1,136 @@
+/**
+ * @file quadrature.hpp
+ * @brief Defines QuadratureDecoder, which turns the pin states of a rotary encoder into detents.
+ * @ingroup Input
+ *
+ * Like remote_protocol.hpp, this has no Arduino dependencies, so recorded pin traces can
+ * be replayed through the decoder on the host.
+ */
+#pragma once
+
+#include <stdint.h>
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#endif
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+#ifndef DRAM_ATTR
+#define DRAM_ATTR
+#endif
+
+/**
+ * @class QuadratureDecoder
+ * @brief Decodes quadrature pin states with a lookup table and a glitch filter.
+ * @ingroup Input
+ *
+ * A state is `(A << 1) | B`. The table maps the previous and the new state to one pulse
+ * clockwise (+1), counter-clockwise (-1) or none, which includes the impossible change
+ * of both pins at once. Pulses are never thrown away: a turn back cancels the pulses of
+ * the turn, so the position always matches the shaft.
+ *
+ * A new state only counts once it was held for the glitch filter time; a state that
+ * changes back before that was contact bounce and is dropped. A change on to a third
+ * state counts the pending one right away, so a turn faster than the filter time loses
+ * no pulses. The held time is known when the next pin change or poll() arrives, so the
+ * last change of a turn is counted by the next poll().
+ *
+ * With four pulses per detent, every detent ends in the same state, the rest state read
+ * by reset(). A detent is counted when the encoder reaches it, from the pulses seen since
+ * the last one, so a missed pulse does not shift the detent boundaries. Other encoders
+ * count a detent every pulses_per_detent pulses.
+ */
+class QuadratureDecoder {
+public:
+    /**
+     * @param pulses_per_detent The number of pulses per detent of the encoder.
+     * @param glitch_filter_us How long a state must be held to count, or 0 to count every change.
+     */
+    QuadratureDecoder(int pulses_per_detent, uint32_t glitch_filter_us)
+        : pulses_per_detent(pulses_per_detent), glitch_filter_us(glitch_filter_us) {}
+
+    /**
+     * @brief Starts decoding from the current state, the encoder at rest.
+     * @param state The pin state.
+     */
+    void reset(uint8_t state);
+
+    /**
+     * @brief Processes a pin change.
+     * @param state The new pin state.
+     * @param now_us The time of the change in microseconds.
+     * @return The detents completed by the state before, positive clockwise.
+     */
+    int update(uint8_t state, uint32_t now_us);
+
+    /**
+     * @brief Counts a pending state that has now been held long enough.
+     * @param now_us The current time in microseconds.
+     * @return The detents completed, positive clockwise.
+     */
+    int poll(uint32_t now_us);
+
+    /**
+     * @brief Gets when the state that completed the last detent was reached.
+     * @return The time in microseconds.
+     */
+    uint32_t detentTimeUs() const { return detent_us; }
+
+    /**
+     * @brief Checks whether a changed state is waiting to be counted by poll().
+     * @return true until the state was counted or dropped as a glitch.
+     */
+    bool waiting() const { return pending; }
+
+private:
+    /// Counts the pulse to a state and returns the detents it completes.
+    int commit(uint8_t state, uint32_t since_us);
+
+    int pulses_per_detent;     ///< The pulses per detent.
+    uint32_t glitch_filter_us; ///< How long a state must be held.
+    uint8_t rest_state = 0b11; ///< The state between detents.
+    uint8_t state = 0b11;      ///< The last counted state.
+    uint8_t pending_state = 0; ///< A changed state not yet held long enough.
+    bool pending = false;      ///< True while pending_state is waiting.
+    uint32_t pending_us = 0;   ///< When pending_state was reached.
+    int position = 0;          ///< The pulses since the last detent.
+    uint32_t detent_us = 0;    ///< When the last detent was completed.
+};
+
+/**
+ * @class CounterDetents
+ * @brief Turns the readings of a hardware pulse counter into detents, e.g. the ESP32's PCNT.
+ * @ingroup Input
+ *
+ * The counter restarts at 0 when it reaches +limit or -limit, so the change between two
+ * readings is taken modulo the limit, which is exact as long as it is read before the
+ * shaft turned half the limit. Pulses that do not make up a whole detent are kept for
+ * the next reading, so the limit need not be a multiple of the pulses per detent.
+ */
+class CounterDetents {
+public:
+    /**
+     * @param pulses_per_detent The number of pulses per detent of the encoder.
+     * @param limit The count at which the counter restarts from 0.
+     */
+    CounterDetents(int pulses_per_detent, int limit) : pulses_per_detent(pulses_per_detent), limit(limit) {}
+
+    /**
+     * @brief Starts counting from a reading, dropping any partial detent.
+     * @param count The counter value.
+     */
+    void reset(int count);
+
+    /**
+     * @brief Takes a new reading.
+     * @param count The counter value.
+     * @return The whole detents since the last reading, positive clockwise.
+     */
+    int update(int count);
+
+private:
+    int pulses_per_detent; ///< The pulses per detent.
+    int limit;             ///< The count at which the counter restarts.
+    int last_count = 0;    ///< The previous reading.
+    int pulses = 0;        ///< Pulses counted but not yet a whole detent.
+};
@@ -0,0 +1,263 @@
+/**
+ * @file remote.cpp
+ * @brief Implements the remote-control protocol.
+ */
+#include "remote.hpp"
+#include <string.h>
+#include "input.hpp"
+#include "profiler.hpp"
+#include "mirror.hpp"
+
+RemoteControl g_remote(Serial);
+
+/// The bytes of one sample in a PROFILE reply.
+static constexpr size_t PROFILE_SAMPLE_BYTES = 4 + 2 * FRAME_PHASE_COUNT + 1;
+/// The samples of a full PROFILE reply, after the status and the two counts.
+static constexpr int PROFILE_SAMPLES_PER_REPLY = (REMOTE_MAX_PAYLOAD - 1 - 4) / PROFILE_SAMPLE_BYTES;
+/// The bytes of the replies to one PROFILE command with a full profiler.
+static constexpr size_t PROFILE_REPLY_BYTES = (PROFILER_SAMPLES / PROFILE_SAMPLES_PER_REPLY + 1) * (REMOTE_FRAME_OVERHEAD + 1 + 4) +
+                                              PROFILER_SAMPLES * PROFILE_SAMPLE_BYTES;
+static_assert(PROFILE_REPLY_BYTES + 2 * (REMOTE_MAX_PAYLOAD + REMOTE_FRAME_OVERHEAD) <= REMOTE_TX_BUFFER_SIZE,
+              "the reply queue must hold the PROFILE reply and two more full frames");
+
+// --- RemoteTxQueue ---
+
+size_t RemoteTxQueue::write(const uint8_t* data, size_t size) {
+    if (size > REMOTE_TX_BUFFER_SIZE - count) {
+        dropped++;
+        return 0;
+    }
+    for (size_t i = 0; i < size; i++) {
+        buffer[head] = data[i];
+        head = (head + 1) % REMOTE_TX_BUFFER_SIZE;
+    }
+    count += size;
+    return size;
+}
+
+void RemoteTxQueue::drain(Print& out, size_t budget) {
+    while (count > 0 && budget > 0) {
+        size_t tail = (head + REMOTE_TX_BUFFER_SIZE - count) % REMOTE_TX_BUFFER_SIZE;
+        size_t chunk = REMOTE_TX_BUFFER_SIZE - tail;
+        if (chunk > count) chunk = count;
+        if (chunk > budget) chunk = budget;
+        size_t written = out.write(buffer + tail, chunk);
+        count -= written;
+        budget -= written;
+        if (written < chunk) break;
+    }
+}
+
+// --- RemoteWriter ---
+
+void RemoteWriter::send(uint8_t command, const uint8_t* payload, size_t length) {
+    if (length > REMOTE_MAX_PAYLOAD) length = REMOTE_MAX_PAYLOAD;
+    uint8_t frame[REMOTE_MAX_PAYLOAD + REMOTE_FRAME_OVERHEAD];
+    frame[0] = REMOTE_FRAME_START;
+    frame[1] = (uint8_t)length;
+    frame[2] = command;
+    if (length) memcpy(frame + 3, payload, length);
+    uint16_t crc = remoteCrc(frame + 1, length + 2);
+    frame[3 + length] = crc & 0xFF;
+    frame[4 + length] = crc >> 8;
+    out.write(frame, length + REMOTE_FRAME_OVERHEAD);
+}
+
+void RemoteWriter::reply(uint8_t command, RemoteStatus status, const uint8_t* data, size_t length) {
+    uint8_t payload[REMOTE_MAX_PAYLOAD];
+    if (length > REMOTE_MAX_PAYLOAD - 1) length = REMOTE_MAX_PAYLOAD - 1;
+    payload[0] = (uint8_t)status;
+    if (length) memcpy(payload + 1, data, length);
+    send(command | REMOTE_REPLY_FLAG, payload, length + 1);
+}
+
+// --- RemoteControl ---
+
+/**
+ * @brief Handles the commands received since the last call and sends what replies fit.
+ * @details Reads at most what the port has already buffered and writes at most what its
+ * transmit buffer has room for, so it never blocks.
+ */
+/**
+ * @brief Makes received bytes give g_input_signal.
+ * @details The callback runs on the serial driver's task, not in an interrupt handler.
+ */
+void RemoteControl::begin() {
+    port.onReceive([]() { g_input_signal.give(); });
+}
+
+void RemoteControl::poll(RemoteTarget& target) {
+    int available = port.available();
+    if (available > 0) {
+        size_t space;
+        uint8_t* buffer = frame_parser.reserve(space);
+        size_t count = (size_t)available < space ? (size_t)available : space;
+        frame_parser.commit(port.readBytes(buffer, count));
+    }
+
+    RemoteFrame frame;
+    while (frame_parser.next(frame)) {
+        handle(frame, target);
+    }
+
+    int room = port.availableForWrite();
+    if (room > 0) replies.drain(port, (size_t)room);
+}
+
+/**
+ * @brief Handles one frame.
+ * @details Replies are ignored rather than answered, so a port looped back onto itself
+ * does not keep replying to its own replies.
+ */
+void RemoteControl::handle(const RemoteFrame& frame, RemoteTarget& target) {
+    if (frame.command & REMOTE_REPLY_FLAG) return;
+    switch ((RemoteCommand)frame.command) {
+    case RemoteCommand::PING:
+        writer.reply(frame.command, RemoteStatus::OK, frame.payload, frame.length);
+        break;
+    case RemoteCommand::INPUT_EVENTS:
+        writer.reply(frame.command, injectInput(frame.payload, frame.length));
+        break;
+    case RemoteCommand::NAVIGATE:
+        if (frame.length == 0 || frame.length > REMOTE_MAX_PATH) {
+            writer.reply(frame.command, RemoteStatus::BAD_PAYLOAD);
+        } else {
+            writer.reply(frame.command, target.navigate(frame.payload, frame.length));
+        }
+        break;
+    case RemoteCommand::GET_CONFIG:
+        getConfig(frame);
+        break;
+    case RemoteCommand::SET_CONFIG: {
+        RemoteStatus status = setConfig(frame.payload, frame.length);
+        if (status == RemoteStatus::OK) target.configChanged();
+        writer.reply(frame.command, status);
+        break;
+    }
+    case RemoteCommand::PROFILE:
+        sendProfile(target.frameProfiler());
+        break;
+    case RemoteCommand::MIRROR:
+        if (frame.length > 1) {
+            writer.reply(frame.command, RemoteStatus::BAD_PAYLOAD);
+        } else {
+            if (frame.length == 1) g_mirror.setEnabled(frame.payload[0] != 0);
+            sendMirrorStats();
+        }
+        break;
+    default:
+        writer.reply(frame.command, RemoteStatus::UNKNOWN_COMMAND);
+        break;
+    }
+}
+
+/**
+ * @brief Queues the events of INPUT_EVENTS.
+ * @details poll() runs on the UI task, the only producer of g_ui_input, so the events
+ * never touch g_input, which belongs to the interrupt handlers.
+ */
+RemoteStatus RemoteControl::injectInput(const uint8_t* events, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (events[i] == (uint8_t)InputEventType::NONE || events[i] > (uint8_t)InputEventType::CANCEL) {
+            return RemoteStatus::BAD_PAYLOAD;
+        }
+    }
+    uint32_t now = millis();
+    for (size_t i = 0; i < count; i++) {
+        if (!g_ui_input.push({ (InputEventType)events[i], now })) return RemoteStatus::QUEUE_FULL;
+    }
+    return RemoteStatus::OK;
+}
+
+void RemoteControl::getConfig(const RemoteFrame& frame) {
+    uint8_t values[REMOTE_MAX_PAYLOAD - 1];
+    size_t length = 0;
+    for (size_t i = 0; i < frame.length; i++) {
+        uint8_t id = frame.payload[i];
+        size_t size = configFieldSize(id);
+        if (!size || length + 1 + size > sizeof(values)) {
+            writer.reply(frame.command, RemoteStatus::BAD_PAYLOAD);
+            return;
+        }
+        values[length++] = id;
+        readConfigField(id, values + length);
+        length += size;
+    }
+    writer.reply(frame.command, RemoteStatus::OK, values, length);
+}
+
+/**
+ * @brief Handles SET_CONFIG.
+ * @details The whole payload is checked before anything is written, so a malformed
+ * command changes nothing.
+ */
+RemoteStatus RemoteControl::setConfig(const uint8_t* payload, size_t length) {
+    for (size_t i = 0; i < length;) {
+        size_t size = configFieldSize(payload[i]);
+        if (!size || i + 1 + size > length) return RemoteStatus::BAD_PAYLOAD;
+        i += 1 + size;
+    }
+    for (size_t i = 0; i < length;) {
+        size_t size = configFieldSize(payload[i]);
+        writeConfigField(payload[i], payload + i + 1);
+        i += 1 + size;
+    }
+    return RemoteStatus::OK;
+}
+
+/**
+ * @brief Replies to MIRROR with the mirror's statistics.
+ * @details The data is the enabled flag followed by the frames, deferred calls, bytes,
+ * mean and maximum encode time in microseconds, each a u32.
+ */
+void RemoteControl::sendMirrorStats() {
+    const MirrorStats& stats = g_mirror.stats();
+    uint32_t values[] = {
+        stats.frames, stats.deferred, stats.bytes,
+        stats.calls ? stats.encode_us_total / stats.calls : 0, stats.encode_us_max,
+    };
+    uint8_t data[1 + sizeof(values)];
+    data[0] = g_mirror.enabled() ? 1 : 0;
+    memcpy(data + 1, values, sizeof(values));
+    writer.reply((uint8_t)RemoteCommand::MIRROR, RemoteStatus::OK, data, sizeof(data));
+}
+
+/**
+ * @brief Replies to PROFILE with the recorded samples, oldest first.
+ * @details Each reply holds the total sample count (u16), the index of its first sample
+ * (u16) and up to 16 samples of 15 bytes: start_us (u32), the five phase times (u16
+ * each) and the drawn flag. A reply with fewer than 16 samples is the last one. The
+ * replies are queued whole and reach the port over the next frames.
+ */
+void RemoteControl::sendProfile(const FrameProfiler* profiler) {
+    uint8_t command = (uint8_t)RemoteCommand::PROFILE;
+#if defined(RINGUI_PROFILER)
+    if (profiler) {
+        uint8_t data[REMOTE_MAX_PAYLOAD - 1];
+        int total = profiler->sampleCount();
+        int first = 0;
+        while (true) {
+            int count = total - first < PROFILE_SAMPLES_PER_REPLY ? total - first : PROFILE_SAMPLES_PER_REPLY;
+            uint8_t* p = data;
+            *p++ = total & 0xFF;
+            *p++ = total >> 8;
+            *p++ = first & 0xFF;
+            *p++ = first >> 8;
+            for (int i = first; i < first + count; i++) {
+                const FrameSample& sample = profiler->sample(i);
+                memcpy(p, &sample.start_us, 4);
+                p += 4;
+                memcpy(p, sample.phase_us, 2 * FRAME_PHASE_COUNT);
+                p += 2 * FRAME_PHASE_COUNT;
+                *p++ = sample.drawn ? 1 : 0;
+            }
+            writer.reply(command, RemoteStatus::OK, data, p - data);
+            first += count;
+            if (count < PROFILE_SAMPLES_PER_REPLY) break;
+        }
+        return;
+    }
+#endif
+    (void)profiler;
+    writer.reply(command, RemoteStatus::UNAVAILABLE);
+}
@@ -0,0 +1,185 @@
+/**
+ * @file remote.hpp
+ * @brief Defines the binary serial remote-control protocol's command handler and frame writer.
+ * @defgroup Remote Remote Control
+ * @{
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.hpp"
+#include "remote_protocol.hpp"
+
+class FrameProfiler;
+
+/**
+ * @class RemoteTxQueue
+ * @brief Holds written bytes until the serial port has room for them.
+ *
+ * Every write is taken whole or not at all, so with RemoteWriter, which writes each
+ * frame at once, only complete frames are queued. A frame that does not fit is dropped
+ * and counted.
+ */
+class RemoteTxQueue : public Print {
+public:
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    /**
+     * @brief Writes queued bytes to a port.
+     * @param out The port.
+     * @param budget The most bytes to write, e.g. the port's availableForWrite().
+     */
+    void drain(Print& out, size_t budget);
+
+    /// @brief Checks whether bytes are waiting to be written.
+    bool empty() const { return count == 0; }
+
+    /// @brief Gets the number of writes dropped because the queue was full.
+    uint32_t droppedCount() const { return dropped; }
+
+private:
+    uint8_t buffer[REMOTE_TX_BUFFER_SIZE]; ///< The ring buffer of queued bytes.
+    size_t head = 0;                       ///< Where the next byte is written.
+    size_t count = 0;                      ///< The number of queued bytes.
+    uint32_t dropped = 0;                  ///< The number of writes that did not fit.
+};
+
+/**
+ * @class RemoteWriter
+ * @brief Sends frames, computing the CRC on the fly.
+ */
+class RemoteWriter {
+public:
+    /// @param out The stream frames are written to.
+    explicit RemoteWriter(Print& out) : out(out) {}
+
+    /**
+     * @brief Sends a frame, with a single write to the stream.
+     * @param command The command byte.
+     * @param payload The payload.
+     * @param length The payload length, at most REMOTE_MAX_PAYLOAD.
+     */
+    void send(uint8_t command, const uint8_t* payload, size_t length);
+
+    /**
+     * @brief Sends a reply: the command with REMOTE_REPLY_FLAG, a status and data.
+     * @param command The command answered.
+     * @param status The outcome.
+     * @param data The data following the status.
+     * @param length The data length, at most REMOTE_MAX_PAYLOAD - 1.
+     */
+    void reply(uint8_t command, RemoteStatus status, const uint8_t* data = nullptr, size_t length = 0);
+
+private:
+    Print& out; ///< The stream frames are written to.
+};
+
+/**
+ * @class RemoteTarget
+ * @brief The part of the UI that remote commands act on, implemented by RingController.
+ */
+class RemoteTarget {
+public:
+    virtual ~RemoteTarget() {}
+
+    /**
+     * @brief Checks a menu path and, if it is valid, shows its menu with the last item selected.
+     * @details The switch happens on the next frame of the menu loop; an open page is closed first.
+     * @param path The item indices from the root menu.
+     * @param depth The number of indices, at least 1.
+     * @return OK, or BAD_PATH if the path does not lead to an item.
+     */
+    virtual RemoteStatus navigate(const uint8_t* path, size_t depth) = 0;
+
+    /// @brief Called after SET_CONFIG changed g_config, e.g. to apply new gains.
+    virtual void configChanged() = 0;
+
+    /**
+     * @brief Gets the frame profiler for PROFILE.
+     * @return The profiler, or nullptr if the build has none.
+     */
+    virtual const FrameProfiler* frameProfiler() const { return nullptr; }
+};
+
+/**
+ * @class RemoteControl
+ * @brief Reads remote commands from a serial port and carries them out, once per frame.
+ *
+ * poll() never waits: it takes only the bytes that have already arrived and handles
+ * every complete frame among them, so a host can batch any number of commands per UI
+ * frame without adding latency to the render loop. Input events are queued in g_ui_input,
+ * which the UI drains together with g_input, so it handles them exactly like hardware input.
+ *
+ * Replies do not wait for the port either. They are queued, and each poll() writes only
+ * as much of the queue as the port's transmit buffer has room for, so a large reply such
+ * as the PROFILE dump goes out over several frames.
+ */
+class RemoteControl {
+public:
+    /// @param port The serial port commands arrive on and replies are sent to.
+    explicit RemoteControl(HardwareSerial& port) : port(port), writer(replies) {}
+
+    /**
+     * @brief Makes received bytes give g_input_signal, so they wake a settled UI.
+     * @details Call once after the port was begun.
+     */
+    void begin();
+
+    /**
+     * @brief Handles the commands received since the last call and sends what replies fit.
+     * @param target The UI the commands act on.
+     */
+    void poll(RemoteTarget& target);
+
+    /**
+     * @brief Checks whether replies are still waiting for the port.
+     * @details Other writers to the port must wait until this is false, or their bytes
+     * would land inside a reply that was sent in part.
+     * @return true while replies are queued.
+     */
+    bool sending() const { return !replies.empty(); }
+
+    /**
+     * @brief Handles one frame, e.g. from a host harness.
+     * @param frame The command.
+     * @param target The UI the command acts on.
+     */
+    void handle(const RemoteFrame& frame, RemoteTarget& target);
+
+    /**
+     * @brief Gets the parser, e.g. for its error count.
+     * @return The frame parser.
+     */
+    const RemoteParser& parser() const { return frame_parser; }
+
+    /**
+     * @brief Gets the number of replies dropped because the reply queue was full.
+     * @return The count since startup.
+     */
+    uint32_t droppedReplies() const { return replies.droppedCount(); }
+
+private:
+    /// Queues the events of INPUT_EVENTS.
+    RemoteStatus injectInput(const uint8_t* events, size_t count);
+    /// Handles GET_CONFIG, replying with the values.
+    void getConfig(const RemoteFrame& frame);
+    /// Handles SET_CONFIG.
+    RemoteStatus setConfig(const uint8_t* payload, size_t length);
+    /// Replies to PROFILE with the recorded samples.
+    void sendProfile(const FrameProfiler* profiler);
+    /// Replies to MIRROR with the mirror's state and statistics.
+    void sendMirrorStats();
+
+    HardwareSerial& port;      ///< The serial port.
+    RemoteTxQueue replies;     ///< The replies not yet written to the port.
+    RemoteWriter writer;       ///< Queues the replies.
+    RemoteParser frame_parser; ///< Splits the received bytes into frames.
+};
+
+/// @brief Global remote control on the USB serial port, polled by the UI while use_serial_control is set.
+extern RemoteControl g_remote;
+/** @} */
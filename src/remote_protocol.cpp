@@ -0,0 +1,78 @@
+/**
+ * @file remote_protocol.cpp
+ * @brief Implements the remote-control frame CRC and parser.
+ */
+#include "remote_protocol.hpp"
+#include <string.h>
+
+uint16_t remoteCrc(const uint8_t* data, size_t length, uint16_t crc) {
+    while (length--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// --- RemoteParser ---
+
+uint8_t* RemoteParser::reserve(size_t& space) {
+    if (start > 0) {
+        memmove(buffer, buffer + start, end - start);
+        end -= start;
+        start = 0;
+    }
+    space = sizeof(buffer) - end;
+    return buffer + end;
+}
+
+void RemoteParser::commit(size_t count) {
+    end += count;
+    if (end > sizeof(buffer)) end = sizeof(buffer);
+}
+
+size_t RemoteParser::receive(const uint8_t* data, size_t length) {
+    size_t space;
+    uint8_t* target = reserve(space);
+    if (length > space) length = space;
+    memcpy(target, data, length);
+    commit(length);
+    return length;
+}
+
+/**
+ * @brief Gets the next complete frame.
+ * @details Bytes before a start byte are skipped. A frame with a bad CRC only drops its
+ * start byte, so a real frame that began inside it is still found.
+ */
+bool RemoteParser::next(RemoteFrame& frame) {
+    while (start < end) {
+        if (buffer[start] != REMOTE_FRAME_START) {
+            const void* found = memchr(buffer + start, REMOTE_FRAME_START, end - start);
+            start = found ? (size_t)(static_cast<const uint8_t*>(found) - buffer) : end;
+            continue;
+        }
+        if (end - start < 2) return false;
+        size_t length = buffer[start + 1];
+        size_t total = length + REMOTE_FRAME_OVERHEAD;
+        if (end - start < total) {
+            // A frame longer than the buffer can never complete; its length byte is corrupt.
+            if (total > sizeof(buffer)) start++;
+            return false;
+        }
+        const uint8_t* body = buffer + start + 1;
+        uint16_t expected = body[length + 2] | (uint16_t)(body[length + 3] << 8);
+        if (remoteCrc(body, length + 2) != expected) {
+            crc_errors++;
+            start++;
+            continue;
+        }
+        frame.command = body[1];
+        frame.payload = body + 2;
+        frame.length = (uint8_t)length;
+        start += total;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file remote_protocol.hpp
+ * @brief Defines the wire format of the remote-control protocol: framing, command ids and the frame parser.
+ * @ingroup Remote
+ *
+ * Nothing here depends on Arduino, so host tools can decode the device's output with
+ * the same parser the firmware uses.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.hpp"
+
+/**
+ * @brief The first byte of every frame, in both directions.
+ *
+ * A frame is `REMOTE_FRAME_START, length, command, payload[length], crc_low, crc_high`.
+ * The CRC is CRC-16/CCITT-FALSE over the length, command and payload bytes. Multi-byte
+ * values in payloads are little-endian.
+ */
+static constexpr uint8_t REMOTE_FRAME_START = 0xA5;
+/// The bytes of a frame besides its payload: start, length, command and the two CRC bytes.
+static constexpr size_t REMOTE_FRAME_OVERHEAD = 5;
+/// The largest payload a frame can carry.
+static constexpr size_t REMOTE_MAX_PAYLOAD = 255;
+/// Set in the command byte of a reply, which otherwise repeats the command it answers.
+static constexpr uint8_t REMOTE_REPLY_FLAG = 0x80;
+
+/**
+ * @enum RemoteCommand
+ * @brief The commands a host can send. Every command is answered by one reply frame
+ * whose payload starts with a RemoteStatus, unless noted otherwise.
+ */
+enum class RemoteCommand : uint8_t {
+    PING = 0x01,       ///< Replies with the payload unchanged, to check the link.
+    INPUT_EVENTS = 0x02, ///< Payload: InputEventType bytes, queued in order as if from the hardware.
+    NAVIGATE = 0x03,   ///< Payload: item indices from the root menu; all but the last must be directories.
+    GET_CONFIG = 0x04, ///< Payload: ConfigField ids. Reply: each id followed by its value.
+    SET_CONFIG = 0x05, ///< Payload: ConfigField ids, each followed by its new value.
+    PROFILE = 0x06,    ///< Replies with the recorded frame samples, in several frames. Needs RINGUI_PROFILER.
+    MIRROR = 0x07,     ///< Payload: nothing, or 1 to start and 0 to stop mirroring. Reply: MirrorStats.
+    MIRROR_FRAME = 0x08 ///< Never sent by the host: the device's unsolicited framebuffer updates.
+};
+
+/**
+ * @enum RemoteStatus
+ * @brief The first payload byte of every reply.
+ */
+enum class RemoteStatus : uint8_t {
+    OK = 0,              ///< The command was carried out.
+    UNKNOWN_COMMAND = 1, ///< The command byte is not a RemoteCommand.
+    BAD_PAYLOAD = 2,     ///< The payload is malformed, e.g. an unknown field or a wrong length.
+    BAD_PATH = 3,        ///< A NAVIGATE path does not lead to an item.
+    QUEUE_FULL = 4,      ///< Not all INPUT_EVENTS fit in the input queue; the rest were dropped.
+    UNAVAILABLE = 5      ///< The command is not supported by this build.
+};
+
+/**
+ * @brief Computes the frame CRC, CRC-16/CCITT-FALSE.
+ * @param data The bytes to checksum.
+ * @param length The number of bytes.
+ * @param crc The CRC of the preceding bytes, to checksum a frame in parts.
+ * @return The updated CRC.
+ */
+uint16_t remoteCrc(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * @struct RemoteFrame
+ * @brief A received frame. The payload points into the parser's receive buffer.
+ */
+struct RemoteFrame {
+    uint8_t command;        ///< The command byte.
+    const uint8_t* payload; ///< The payload, valid until the parser receives more bytes.
+    uint8_t length;         ///< The payload length.
+};
+
+/**
+ * @class RemoteParser
+ * @brief Splits a byte stream into CRC-checked frames, in place in a fixed buffer.
+ *
+ * Bytes are read straight into the buffer (see reserve() and commit()), and next()
+ * returns frames whose payloads point into it, so nothing is copied or allocated. After
+ * a CRC error or a stray byte the parser skips ahead to the next start byte, so a
+ * corrupted frame costs at most that frame.
+ */
+class RemoteParser {
+public:
+    /**
+     * @brief Makes room for new bytes and gets where to write them.
+     * @details Frames returned by next() are invalidated: the unread rest of the buffer is
+     * moved to its start.
+     * @param space Receives the number of bytes that may be written.
+     * @return The write position.
+     */
+    uint8_t* reserve(size_t& space);
+
+    /**
+     * @brief Adds bytes written at the position returned by reserve().
+     * @param count The number of bytes written.
+     */
+    void commit(size_t count);
+
+    /**
+     * @brief Copies bytes into the buffer, e.g. from a host harness.
+     * @param data The bytes.
+     * @param length The number of bytes.
+     * @return The number of bytes taken, less than @p length if the buffer is full.
+     */
+    size_t receive(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Gets the next complete frame.
+     * @param frame Receives the frame.
+     * @return false if no complete frame is buffered.
+     */
+    bool next(RemoteFrame& frame);
+
+    /**
+     * @brief Gets the number of frames dropped because of a CRC mismatch.
+     * @return The error count since construction.
+     */
+    uint32_t crcErrors() const { return crc_errors; }
+
+private:
+    uint8_t buffer[REMOTE_BUFFER_SIZE]; ///< The received bytes.
+    size_t start = 0;                   ///< The first unparsed byte.
+    size_t end = 0;                     ///< One past the last received byte.
+    uint32_t crc_errors = 0;            ///< The number of frames with a bad CRC.
+};
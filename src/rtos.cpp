@@ -0,0 +1,114 @@
+/**
+ * @file rtos.cpp
+ * @brief Implements the threading layer for FreeRTOS and for std::thread hosts.
+ */
+#include "rtos.hpp"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <esp_attr.h>
+
+// --- FreeRTOS Implementation ---
+
+bool Task::start(Entry entry, void* arg, const char* name, int core, unsigned priority, size_t stack_size) {
+    if (started) return false;
+    BaseType_t result;
+    if (core < 0) {
+        result = xTaskCreate(entry, name, stack_size, arg, priority, &handle);
+    } else {
+        result = xTaskCreatePinnedToCore(entry, name, stack_size, arg, priority, &handle, core);
+    }
+    started = (result == pdPASS);
+    return started;
+}
+
+Mutex::Mutex() : handle(xSemaphoreCreateMutex()) {}
+
+Mutex::~Mutex() {
+    vSemaphoreDelete(handle);
+}
+
+void Mutex::lock() {
+    xSemaphoreTake(handle, portMAX_DELAY);
+}
+
+void Mutex::unlock() {
+    xSemaphoreGive(handle);
+}
+
+Signal::Signal() : handle(xSemaphoreCreateBinary()) {}
+
+Signal::~Signal() {
+    vSemaphoreDelete(handle);
+}
+
+void Signal::give() {
+    xSemaphoreGive(handle);
+}
+
+void IRAM_ATTR Signal::giveFromIsr() {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(handle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+bool Signal::take(uint32_t timeout_ms) {
+    TickType_t ticks = (timeout_ms == WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return xSemaphoreTake(handle, ticks) == pdTRUE;
+}
+
+#else
+
+// --- std::thread Implementation ---
+
+#include <chrono>
+
+bool Task::start(Entry entry, void* arg, const char* name, int core, unsigned priority, size_t stack_size) {
+    (void)name; (void)core; (void)priority; (void)stack_size;
+    if (started) return false;
+    thread = std::thread(entry, arg);
+    thread.detach();
+    started = true;
+    return started;
+}
+
+Mutex::Mutex() {}
+
+Mutex::~Mutex() {}
+
+void Mutex::lock() {
+    mutex.lock();
+}
+
+void Mutex::unlock() {
+    mutex.unlock();
+}
+
+Signal::Signal() {}
+
+Signal::~Signal() {}
+
+void Signal::give() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        given = true;
+    }
+    cond.notify_one();
+}
+
+void Signal::giveFromIsr() {
+    give();
+}
+
+bool Signal::take(uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (timeout_ms == WAIT_FOREVER) {
+        cond.wait(lock, [this] { return given; });
+    } else if (!cond.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return given; })) {
+        return false;
+    }
+    given = false;
+    return true;
+}
+
+#endif
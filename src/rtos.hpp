@@ -0,0 +1,201 @@
+/**
+ * @file rtos.hpp
+ * @brief Defines a minimal threading layer with FreeRTOS and std::thread backends.
+ * @defgroup RTOS Threading
+ * @{
+ *
+ * On ESP32 targets the classes map directly onto FreeRTOS tasks and semaphores. On any
+ * other platform they are implemented with the C++ standard library, so code built on
+ * top of them (e.g. FramePipeline) also runs on a desktop host.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @class Task
+ * @brief A thread of execution, optionally pinned to a CPU core.
+ * @ingroup RTOS
+ */
+class Task {
+public:
+    /// The signature of a task entry function.
+    using Entry = void (*)(void* arg);
+
+    Task() = default;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    /**
+     * @brief Creates and starts the task.
+     * @param entry The function the task runs. It must never return.
+     * @param arg The argument passed to the entry function.
+     * @param name A short name for debugging.
+     * @param core The CPU core to pin the task to, or -1 for any core. Ignored on hosts.
+     * @param priority The task priority. Ignored on hosts.
+     * @param stack_size The stack size in bytes. Ignored on hosts.
+     * @return true if the task was created.
+     */
+    bool start(Entry entry, void* arg, const char* name, int core, unsigned priority, size_t stack_size);
+
+    /**
+     * @brief Checks whether start() succeeded.
+     * @return true if the task is running.
+     */
+    bool running() const { return started; }
+
+private:
+    bool started = false; ///< True once the task has been created.
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t handle = nullptr; ///< The FreeRTOS task handle.
+#else
+    std::thread thread; ///< The host thread, detached after creation.
+#endif
+};
+
+/**
+ * @class Mutex
+ * @brief A non-recursive mutual exclusion lock.
+ * @ingroup RTOS
+ */
+class Mutex {
+public:
+    Mutex();
+    ~Mutex();
+    Mutex(const Mutex&) = delete;
+    Mutex& operator=(const Mutex&) = delete;
+
+    /// @brief Blocks until the lock is acquired.
+    void lock();
+    /// @brief Releases the lock.
+    void unlock();
+
+private:
+#if defined(ARDUINO_ARCH_ESP32)
+    SemaphoreHandle_t handle; ///< The FreeRTOS mutex handle.
+#else
+    std::mutex mutex; ///< The host mutex.
+#endif
+};
+
+/**
+ * @class LockGuard
+ * @brief Holds a Mutex for the lifetime of the guard.
+ * @ingroup RTOS
+ */
+class LockGuard {
+public:
+    explicit LockGuard(Mutex& mutex) : mutex(mutex) { mutex.lock(); }
+    ~LockGuard() { mutex.unlock(); }
+    LockGuard(const LockGuard&) = delete;
+    LockGuard& operator=(const LockGuard&) = delete;
+
+private:
+    Mutex& mutex; ///< The held mutex.
+};
+
+/**
+ * @class SpinLock
+ * @brief A short critical section shared by a task and an interrupt handler.
+ * @ingroup RTOS
+ *
+ * On ESP32 targets this is a FreeRTOS spinlock: while it is held, interrupts are masked
+ * on the holding core and the other core spins, so it also guards against an interrupt
+ * handler running on the other core, which noInterrupts() does not. Hold it only for a
+ * few instructions. The task side uses lock(), interrupt handlers lockFromIsr().
+ */
+class SpinLock {
+public:
+#if defined(ARDUINO_ARCH_ESP32)
+    SpinLock() = default;
+#else
+    SpinLock() { flag.clear(); }
+#endif
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    /// @brief Enters the critical section from a task.
+    void lock() { portENTER_CRITICAL(&mux); }
+    /// @brief Leaves the critical section entered with lock().
+    void unlock() { portEXIT_CRITICAL(&mux); }
+    /// @brief Enters the critical section from an interrupt handler. Always inlined, so it stays in IRAM.
+    __attribute__((always_inline)) void lockFromIsr() { portENTER_CRITICAL_ISR(&mux); }
+    /// @brief Leaves the critical section entered with lockFromIsr().
+    __attribute__((always_inline)) void unlockFromIsr() { portEXIT_CRITICAL_ISR(&mux); }
+#else
+    /// @brief Enters the critical section from a task.
+    void lock() { while (flag.test_and_set(std::memory_order_acquire)) {} }
+    /// @brief Leaves the critical section entered with lock().
+    void unlock() { flag.clear(std::memory_order_release); }
+    /// @brief Enters the critical section from an interrupt handler.
+    void lockFromIsr() { lock(); }
+    /// @brief Leaves the critical section entered with lockFromIsr().
+    void unlockFromIsr() { unlock(); }
+#endif
+
+private:
+#if defined(ARDUINO_ARCH_ESP32)
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED; ///< The FreeRTOS spinlock.
+#else
+    std::atomic_flag flag; ///< Set while the lock is held.
+#endif
+};
+
+/**
+ * @class Signal
+ * @brief A binary semaphore used to wake a waiting task.
+ * @ingroup RTOS
+ *
+ * Several give() calls before a take() are coalesced into a single wake-up. Interrupt
+ * handlers use giveFromIsr().
+ */
+class Signal {
+public:
+    Signal();
+    ~Signal();
+    Signal(const Signal&) = delete;
+    Signal& operator=(const Signal&) = delete;
+
+    /// @brief Wakes the waiting task, or makes the next take() return immediately.
+    void give();
+
+    /**
+     * @brief Like give(), from an interrupt handler.
+     * @details If the woken task has a higher priority than the interrupted one, the
+     * handler returns straight into it.
+     */
+    void giveFromIsr();
+
+    /**
+     * @brief Waits until the signal is given.
+     * @param timeout_ms The maximum time to wait in milliseconds, or WAIT_FOREVER.
+     * @return true if the signal was taken, false on timeout.
+     */
+    bool take(uint32_t timeout_ms = WAIT_FOREVER);
+
+    /// Passed to take() to wait without a timeout.
+    static constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFF;
+
+private:
+#if defined(ARDUINO_ARCH_ESP32)
+    SemaphoreHandle_t handle; ///< The FreeRTOS binary semaphore handle.
+#else
+    std::mutex mutex;             ///< Protects the flag.
+    std::condition_variable cond; ///< Wakes waiters.
+    bool given = false;           ///< True if the signal is pending.
+#endif
+};
+/** @} */
@@ -0,0 +1,163 @@
+/**
+ * @file Arduino.h
+ * @brief Host replacement for the parts of the Arduino API that RingUI and U8g2 use.
+ * @ingroup Simulator
+ *
+ * Only on the include path of the `native` environment. Time and GPIO are backed by
+ * g_simulator: time is virtual and only advances in delay(), and pin levels are set by
+ * the simulator's input script, which also runs the attached interrupt handlers.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include "Print.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p) (p)
+
+using std::abs;
+using std::max;
+using std::min;
+
+// --- Time ---
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// --- GPIO ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+void noInterrupts();
+void interrupts();
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+/**
+ * @class String
+ * @brief A minimal Arduino String over std::string.
+ * @ingroup Simulator
+ */
+class String {
+public:
+    String(const char* text = "") : text(text ? text : "") {}
+    explicit String(int value) : text(std::to_string(value)) {}
+    explicit String(unsigned int value) : text(std::to_string(value)) {}
+    explicit String(long value) : text(std::to_string(value)) {}
+    explicit String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    char charAt(unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t found = text.find(c, from);
+        return found == std::string::npos ? -1 : (int)found;
+    }
+    String substring(unsigned int begin) const { return substring(begin, text.size()); }
+    String substring(unsigned int begin, unsigned int end) const {
+        if (begin > text.size()) begin = text.size();
+        if (end < begin) end = begin;
+        return String(text.substr(begin, end - begin).c_str());
+    }
+    long toInt() const { return strtol(text.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(text.c_str(), nullptr); }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    friend String operator+(String lhs, const String& rhs) { return lhs += rhs; }
+    friend String operator+(String lhs, const char* rhs) { return lhs += rhs; }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator!=(const String& other) const { return text != other.text; }
+
+private:
+    std::string text; ///< The characters.
+};
+
+/// The callback type of HardwareSerial::onReceive(), as in the ESP32 core.
+typedef std::function<void(void)> OnReceiveCb;
+
+/**
+ * @class HardwareSerial
+ * @brief The serial port: reads the bytes the script sends, writes to the host's stdout.
+ * @ingroup Simulator
+ */
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long /*baud*/) {}
+    void end() {}
+    int available();
+    int read();
+    int peek();
+    size_t readBytes(uint8_t* buffer, size_t length);
+    int availableForWrite() { return 256; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+    operator bool() const { return true; }
+    /// @brief Sets the function called when bytes arrive.
+    void onReceive(OnReceiveCb function, bool /*onlyOnTimeout*/ = false) { on_receive = function; }
+    /// @brief Calls the onReceive() function. Called by the simulator when scripted bytes arrive.
+    void received() {
+        if (on_receive) on_receive();
+    }
+
+private:
+    OnReceiveCb on_receive; ///< The function set with onReceive(), or empty.
+};
+
+/// @brief The serial port, printed to stdout.
+/// @ingroup Simulator
+extern HardwareSerial Serial;
+
+/**
+ * @class EspClass
+ * @brief The ESP system functions that RingUI calls.
+ * @ingroup Simulator
+ */
+class EspClass {
+public:
+    /// @brief Ends the simulation, as there is nothing to restart into.
+    [[noreturn]] void restart();
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMinFreeHeap() { return 0; }
+    uint32_t getMaxAllocHeap() { return 0; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount() { return micros() * getCpuFreqMHz(); }
+};
+
+/// @brief The ESP system functions.
+/// @ingroup Simulator
+extern EspClass ESP;
@@ -0,0 +1,55 @@
+/**
+ * @file Print.h
+ * @brief Host replacement for the Arduino Print class, used by the simulator build.
+ * @ingroup Simulator
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String;
+
+/**
+ * @class Print
+ * @brief The Arduino text output base class, with the same overloads as the ESP32 core.
+ * @ingroup Simulator
+ */
+class Print {
+public:
+    virtual ~Print() {}
+
+    /// @brief Writes one byte. Implemented by the output, e.g. a display driver or Serial.
+    virtual size_t write(uint8_t c) = 0;
+    /// @brief Writes a run of bytes. The default writes them one by one.
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    /// @brief Flushes buffered output, if any.
+    virtual void flush() {}
+
+    size_t write(const char* str) { return str ? write(reinterpret_cast<const uint8_t*>(str), strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str);
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+};
@@ -0,0 +1,49 @@
+/**
+ * @file allocation_counter.cpp
+ * @brief Replaces the global operator new to count heap allocations for the benchmark report.
+ */
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include "simulator.hpp"
+
+static std::atomic<uint64_t> allocation_count(0);
+
+uint64_t Simulator::allocationCount() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
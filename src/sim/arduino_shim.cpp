@@ -0,0 +1,145 @@
+/**
+ * @file arduino_shim.cpp
+ * @brief Implements the host Arduino API on top of the Simulator.
+ */
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "simulator.hpp"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// --- Time ---
+
+unsigned long millis() {
+    return (unsigned long)(g_simulator.nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)g_simulator.nowUs();
+}
+
+void delay(uint32_t ms) {
+    g_simulator.sleep(ms * 1000ULL);
+}
+
+void delayMicroseconds(uint32_t us) {
+    g_simulator.sleep(us);
+}
+
+void yield() {}
+
+// --- GPIO ---
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    g_simulator.setPinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    g_simulator.writePin(pin, level);
+}
+
+int digitalRead(uint8_t pin) {
+    return g_simulator.readPin(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    g_simulator.attachInterrupt(pin, handler, mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    g_simulator.attachInterrupt(pin, Delegate<void()>(handler, arg), mode);
+}
+
+void detachInterrupt(uint8_t pin) {
+    g_simulator.detachInterrupt(pin);
+}
+
+// Interrupt handlers only run inside delay(), so there is nothing to mask.
+void noInterrupts() {}
+void interrupts() {}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// --- Print ---
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write(buffer, (size_t)length < sizeof(buffer) ? (size_t)length : sizeof(buffer) - 1);
+}
+
+size_t Print::print(const String& str) {
+    return write(str.c_str(), str.length());
+}
+
+size_t Print::print(long value, int base) {
+    if (base == DEC) return printf("%ld", value);
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    if (base < 2 || base > 16) base = DEC;
+    char buffer[8 * sizeof(long) + 1];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    do {
+        *--p = "0123456789ABCDEF"[value % base];
+        value /= base;
+    } while (value);
+    return write(p, end - p);
+}
+
+size_t Print::print(double value, int digits) {
+    return printf("%.*f", digits, value);
+}
+
+// --- Serial and ESP ---
+
+int HardwareSerial::available() {
+    return (int)g_simulator.serialAvailable();
+}
+
+int HardwareSerial::read() {
+    uint8_t c;
+    return g_simulator.serialRead(&c, 1) ? c : -1;
+}
+
+int HardwareSerial::peek() {
+    return g_simulator.serialPeek();
+}
+
+size_t HardwareSerial::readBytes(uint8_t* buffer, size_t length) {
+    return g_simulator.serialRead(buffer, length);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return g_simulator.serialWrite(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return g_simulator.serialWrite(buffer, size);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+void EspClass::restart() {
+    g_simulator.finish("ESP.restart()");
+}
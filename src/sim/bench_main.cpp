@@ -0,0 +1,298 @@
+/**
+ * @file bench_main.cpp
+ * @brief Entry point of the frame-time benchmark, built by the `native_bench` environment.
+ *
+ * Usage: `program [-o REPORT]`
+ *
+ * Drives fixed scenarios through RingController::handle() on the simulator: scrolling
+ * menus of 5, 10, 100, 1000 and 5000 items, the forward and backward menu transitions, page entry
+ * and exit, and scrolling an InfoPage and a StreamInfoPage over 64 KB of text. Each
+ * scenario is a benchmark phase of the script below; the JSON report (stdout by default)
+ * has the frame count, time to settle, host draw time, bytes sent and allocations of
+ * each. Frame content is reproducible, so only the host timings vary between runs.
+ *
+ * Before the scenarios, microbenchmarks time the PID animation step with float, double
+ * and Q16.16 fixed point, and measure how far the rounded positions of float and fixed
+ * point stray from double, and compare calling and copying a Delegate with a
+ * std::function. They are listed under "results".
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include "simulator.hpp"
+#include "../config.hpp"
+#include "../delegate.hpp"
+#include "../input.hpp"
+#include "../menu.hpp"
+#include "../pages.hpp"
+#include "../pid.hpp"
+#include "../static_menu.hpp"
+#include "../text_source.hpp"
+#include "../ui.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+RingController<DisplayDriver> controller(OLED);
+
+/// The size of the generated text shown by the page scenarios.
+static constexpr size_t BENCH_TEXT_SIZE = 64 * 1024;
+
+/// The benchmark scenarios, one phase each. Unnamed marks end a phase.
+static const char* const BENCH_SCRIPT[] = {
+    "mark enter_list_5", "click", "wait 600",
+    "mark scroll_list_5", "cw 4", "wait 600",
+    "mark leave_list_5", "cancel", "wait 600",
+    "mark", "cw", "wait 400",
+    "mark enter_list_10", "click", "wait 600",
+    "mark scroll_list_10", "cw 9", "wait 600",
+    "mark leave_list_10", "cancel", "wait 600",
+    "mark", "cw", "wait 400",
+    "mark enter_list_100", "click", "wait 600",
+    "mark scroll_list_100", "cw 99", "wait 600",
+    "mark leave_list_100", "cancel", "wait 600",
+    "mark", "cw", "wait 400",
+    "mark enter_list_1000", "click", "wait 600",
+    "mark scroll_list_1000", "cw 999", "wait 600",
+    "mark leave_list_1000", "cancel", "wait 600",
+    "mark", "cw", "wait 400",
+    "mark enter_list_5000", "click", "wait 600",
+    "mark scroll_list_5000", "cw 4999", "wait 600",
+    "mark leave_list_5000", "cancel", "wait 600",
+    "mark", "cw", "wait 400",
+    "mark info_page_entry", "click", "wait 600",
+    "mark info_page_scroll", "cw 300", "wait 600",
+    "mark info_page_exit", "cancel", "wait 600",
+    "mark", "cw", "wait 400",
+    "mark stream_page_entry", "click", "wait 600",
+    "mark stream_page_scroll", "cw 300", "wait 600",
+    "mark stream_page_exit", "cancel", "wait 600",
+    "mark", "quit",
+};
+
+static std::string bench_text;
+static MemoryTextSource bench_source{StringView()};
+
+static MenuItem listItem(int index, char* label, size_t capacity) {
+    snprintf(label, capacity, "Item %d", index + 1);
+    return MenuItem(label, Delegate<Page*()>());
+}
+
+static CallbackMenu list5([] { return 5; }, listItem);
+static CallbackMenu list10([] { return 10; }, listItem);
+static CallbackMenu list100([] { return 100; }, listItem);
+static CallbackMenu list1000([] { return 1000; }, listItem);
+static CallbackMenu list5000([] { return 5000; }, listItem);
+
+static Page* showInfo() { return controller.emplacePage<InfoPage>(StringView(bench_text.data(), bench_text.size())); }
+static Page* showStream() { return controller.emplacePage<StreamInfoPage>(bench_source); }
+
+constexpr StaticMenuItem benchItems[] = {
+    StaticMenuItem::directory("List 5", &list5),
+    StaticMenuItem::directory("List 10", &list10),
+    StaticMenuItem::directory("List 100", &list100),
+    StaticMenuItem::directory("List 1000", &list1000),
+    StaticMenuItem::directory("List 5000", &list5000),
+    StaticMenuItem::option("Info page", showInfo),
+    StaticMenuItem::option("Stream page", showStream),
+};
+constexpr StaticMenuTable benchTable = StaticMenuTable::of("Benchmark", benchItems);
+StaticMenu benchMenu(benchTable);
+
+/// Generates paragraphs of words of varying length, so the text wraps like prose.
+static void generateText() {
+    static const char* const words[] = {"lorem", "ipsum", "dolor", "sit", "amet", "consectetur",
+                                        "adipiscing", "elit", "sed", "do", "eiusmod", "tempor"};
+    uint32_t seed = 1;
+    bench_text.reserve(BENCH_TEXT_SIZE + 16);
+    while (bench_text.size() < BENCH_TEXT_SIZE) {
+        seed = seed * 1103515245 + 12345;
+        bench_text += words[(seed >> 16) % 12];
+        bench_text += ((seed >> 8) % 9 == 0) ? '\n' : ' ';
+    }
+    bench_source = MemoryTextSource(StringView(bench_text.data(), bench_text.size()));
+}
+
+/// The number of PID updates each number type is timed with.
+static constexpr int PID_BENCH_UPDATES = 1000000;
+/// The number of PID updates whose positions are compared across number types.
+static constexpr int PID_COMPARE_UPDATES = 4000;
+/// Keeps the optimizer from dropping the benchmark loops.
+static volatile int bench_sink;
+
+/**
+ * @brief Animates a value back and forth across the screen with the scroll gains, at 60 fps.
+ * @tparam T The number type of the controller and the animation state.
+ * @param updates The number of PID updates.
+ * @param positions Receives the rounded position after every update, or nullptr.
+ */
+template <typename T>
+static void animateWith(int updates, int* positions) {
+    BasicPIDController<T> pid(T(g_config.scroll_pid_kp), T(g_config.scroll_pid_ki), T(g_config.scroll_pid_kd));
+    const T dt = fromRatio<T>(1000000 / 60, (uint32_t)(ANIMATION_REFERENCE_MS * 1000));
+    T value = T(0);
+    for (int i = 0; i < updates; i++) {
+        T target = T((i / 48) % 2 ? 0 : 96);
+        value += pid.update(target, value, dt) * dt;
+        int position = roundToInt(value);
+        if (positions) positions[i] = position;
+        bench_sink = position;
+    }
+}
+
+/// Times animateWith() and returns the host time per update in nanoseconds.
+template <typename T>
+static double pidUpdateNs() {
+    auto start = std::chrono::steady_clock::now();
+    animateWith<T>(PID_BENCH_UPDATES, nullptr);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / PID_BENCH_UPDATES;
+}
+
+/// Gets the largest difference between two runs of rounded positions.
+static int maxPixelError(const int* positions, const int* reference) {
+    int error = 0;
+    for (int i = 0; i < PID_COMPARE_UPDATES; i++) {
+        int difference = abs(positions[i] - reference[i]);
+        if (difference > error) error = difference;
+    }
+    return error;
+}
+
+/**
+ * @brief Compares the animation math in float, double and Q16.16.
+ * @details The host times are only relative: an ESP32 has a float unit but does double
+ * in software, so there the gap to double is far wider than on the host.
+ */
+static void benchmarkAnimationMath() {
+    g_simulator.addResult("pid_update_float", pidUpdateNs<float>(), "ns");
+    g_simulator.addResult("pid_update_double", pidUpdateNs<double>(), "ns");
+    g_simulator.addResult("pid_update_fixed16", pidUpdateNs<Fixed16>(), "ns");
+
+    static int reference[PID_COMPARE_UPDATES];
+    static int positions[PID_COMPARE_UPDATES];
+    animateWith<double>(PID_COMPARE_UPDATES, reference);
+    animateWith<float>(PID_COMPARE_UPDATES, positions);
+    g_simulator.addResult("pid_float_max_error", maxPixelError(positions, reference), "px");
+    animateWith<Fixed16>(PID_COMPARE_UPDATES, positions);
+    g_simulator.addResult("pid_fixed16_max_error", maxPixelError(positions, reference), "px");
+}
+
+/// The number of calls and copies each callback type is timed with.
+static constexpr int CALLBACK_BENCH_ROUNDS = 1000000;
+
+/// Hides a pointer's target from the optimizer, so the callback is called through it.
+static void escape(const void* pointer) { asm volatile("" : : "g"(pointer) : "memory"); }
+
+/// The state a menu callback typically reaches: an object and a few values.
+struct CallbackState {
+    int* counter;
+    int* step;
+    int* limit;
+    int* wraps;
+};
+
+static int countUp(void* context) {
+    CallbackState& state = *static_cast<CallbackState*>(context);
+    *state.counter += *state.step;
+    if (*state.counter > *state.limit) {
+        *state.counter = 0;
+        (*state.wraps)++;
+    }
+    return *state.counter;
+}
+
+/// Times calls through a callback and returns the host time per call in nanoseconds.
+template <typename Callback>
+static double callNs(const Callback& callback) {
+    int sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLBACK_BENCH_ROUNDS; i++) {
+        escape(&callback);
+        sum += callback();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    bench_sink = sum;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / CALLBACK_BENCH_ROUNDS;
+}
+
+/**
+ * @brief Times copies of a callback, as a menu item is copied out of its menu.
+ * @param callback The callback to copy.
+ * @param[out] allocations Receives the heap allocations per copy.
+ * @return The host time per copy in nanoseconds.
+ */
+template <typename Callback>
+static double copyNs(const Callback& callback, double& allocations) {
+    uint64_t allocations_before = Simulator::allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLBACK_BENCH_ROUNDS; i++) {
+        escape(&callback);
+        Callback copy(callback);
+        escape(&copy);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    allocations = (double)(Simulator::allocationCount() - allocations_before) / CALLBACK_BENCH_ROUNDS;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / CALLBACK_BENCH_ROUNDS;
+}
+
+/**
+ * @brief Compares Delegate with the std::function it replaced.
+ * @details Both reach the same four values. The std::function captures them, which
+ * overflows its small-buffer storage; the Delegate gets them through a context pointer.
+ */
+static void benchmarkCallbacks() {
+    static int counter = 0, step = 3, limit = 1000, wraps = 0;
+    static CallbackState state{&counter, &step, &limit, &wraps};
+    Delegate<int()> delegate(countUp, &state);
+    int *c = &counter, *s = &step, *l = &limit, *w = &wraps;
+    std::function<int()> function([c, s, l, w] {
+        CallbackState captured{c, s, l, w};
+        return countUp(&captured);
+    });
+
+    double allocations;
+    g_simulator.addResult("delegate_call", callNs(delegate), "ns");
+    g_simulator.addResult("function_call", callNs(function), "ns");
+    g_simulator.addResult("delegate_copy", copyNs(delegate, allocations), "ns");
+    g_simulator.addResult("delegate_copy_allocations", allocations, "allocations");
+    g_simulator.addResult("function_copy", copyNs(function, allocations), "ns");
+    g_simulator.addResult("function_copy_allocations", allocations, "allocations");
+}
+
+int main(int argc, char** argv) {
+    FILE* report = stdout;
+    if (argc == 3 && strcmp(argv[1], "-o") == 0) {
+        report = fopen(argv[2], "w");
+        if (!report) {
+            perror(argv[2]);
+            return 1;
+        }
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-o REPORT]\n", argv[0]);
+        return 2;
+    }
+
+    generateText();
+    benchmarkAnimationMath();
+    benchmarkCallbacks();
+    list5.setParent(&benchMenu);
+    list10.setParent(&benchMenu);
+    list100.setParent(&benchMenu);
+    list1000.setParent(&benchMenu);
+    list5000.setParent(&benchMenu);
+
+    for (const char* line : BENCH_SCRIPT) {
+        g_simulator.schedule(line);
+    }
+    g_simulator.setReport(report);
+    g_simulator.attachDisplay(OLED, nullptr);
+
+    g_encoder.begin();
+    g_cancel_button.begin();
+    controller.setup();
+
+    // Does not return: the simulator writes the report and ends the process once the
+    // script is done.
+    controller.handle(&benchMenu);
+}
@@ -0,0 +1,225 @@
+/**
+ * @file mirror_main.cpp
+ * @brief Host tool that turns a capture of the device's framebuffer mirror into an animated GIF.
+ *
+ * Usage: `program [--scale N] CAPTURE OUTPUT.gif`
+ *
+ * CAPTURE is the raw serial output of a device (or the simulator) with mirroring
+ * started by the MIRROR remote command, e.g. saved with `pio device monitor --raw`, or
+ * `-` for stdin. Anything that is not a MIRROR_FRAME reply is skipped. Every completed
+ * frame becomes a GIF frame shown for as long as the device showed it, scaled up by
+ * N (default 2). Only the Arduino-free protocol and codec sources are linked.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "../config.hpp"
+#include "../remote_protocol.hpp"
+#include "../mirror_codec.hpp"
+
+/**
+ * @class GifWriter
+ * @brief Writes a looping two-color animated GIF, one frame at a time.
+ * @ingroup Simulator
+ */
+class GifWriter {
+public:
+    /**
+     * @brief Creates the file and writes the header.
+     * @param path The output file.
+     * @param width The image width in pixels.
+     * @param height The image height in pixels.
+     * @return false if the file cannot be created.
+     */
+    bool open(const char* path, int width, int height) {
+        file = fopen(path, "wb");
+        if (!file) return false;
+        this->width = width;
+        this->height = height;
+        fwrite("GIF89a", 1, 6, file);
+        writeWord(width);
+        writeWord(height);
+        // A global color table of two entries: off and on.
+        static const uint8_t screen[] = {0x80, 0, 0, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF};
+        fwrite(screen, 1, sizeof(screen), file);
+        // Loop forever.
+        static const uint8_t loop[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E',
+                                       '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+        fwrite(loop, 1, sizeof(loop), file);
+        return true;
+    }
+
+    /**
+     * @brief Appends a frame.
+     * @param pixels width * height bytes, 0 or 1.
+     * @param delay_cs How long the frame is shown, in hundredths of a second.
+     */
+    void addFrame(const std::vector<uint8_t>& pixels, int delay_cs) {
+        const uint8_t control[] = {0x21, 0xF9, 0x04, 0x00, (uint8_t)(delay_cs & 0xFF), (uint8_t)(delay_cs >> 8), 0x00, 0x00};
+        fwrite(control, 1, sizeof(control), file);
+        fputc(0x2C, file);
+        writeWord(0);
+        writeWord(0);
+        writeWord(width);
+        writeWord(height);
+        fputc(0x00, file);
+        writeImageData(pixels);
+    }
+
+    /// @brief Writes the trailer and closes the file.
+    void close() {
+        fputc(0x3B, file);
+        fclose(file);
+    }
+
+private:
+    /// The smallest LZW code size GIF allows; two colors still need four root codes.
+    static constexpr int MIN_CODE_SIZE = 2;
+
+    void writeWord(int value) {
+        fputc(value & 0xFF, file);
+        fputc((value >> 8) & 0xFF, file);
+    }
+
+    /// Adds a code to the bit stream, least significant bit first.
+    void writeCode(uint32_t code, int size) {
+        bits |= code << bit_count;
+        bit_count += size;
+        while (bit_count >= 8) {
+            block.push_back(bits & 0xFF);
+            bits >>= 8;
+            bit_count -= 8;
+        }
+    }
+
+    /// LZW-compresses the pixels into data sub-blocks.
+    void writeImageData(const std::vector<uint8_t>& pixels) {
+        const uint32_t clear_code = 1u << MIN_CODE_SIZE;
+        std::vector<uint16_t> next(4096 * 4, 0);
+        int code_size = MIN_CODE_SIZE + 1;
+        uint32_t max_code = clear_code + 1;
+        bits = 0;
+        bit_count = 0;
+        block.clear();
+
+        writeCode(clear_code, code_size);
+        uint32_t current = pixels[0];
+        for (size_t i = 1; i < pixels.size(); i++) {
+            uint8_t value = pixels[i];
+            uint16_t& child = next[current * 4 + value];
+            if (child) {
+                current = child;
+                continue;
+            }
+            writeCode(current, code_size);
+            child = (uint16_t)++max_code;
+            if (max_code >= (1u << code_size)) code_size++;
+            if (max_code == 4095) {
+                writeCode(clear_code, code_size);
+                std::fill(next.begin(), next.end(), 0);
+                code_size = MIN_CODE_SIZE + 1;
+                max_code = clear_code + 1;
+            }
+            current = value;
+        }
+        writeCode(current, code_size);
+        writeCode(clear_code, code_size);
+        writeCode(clear_code + 1, MIN_CODE_SIZE + 1);
+        if (bit_count > 0) block.push_back(bits & 0xFF);
+
+        fputc(MIN_CODE_SIZE, file);
+        for (size_t offset = 0; offset < block.size(); offset += 255) {
+            size_t length = block.size() - offset < 255 ? block.size() - offset : 255;
+            fputc((int)length, file);
+            fwrite(block.data() + offset, 1, length, file);
+        }
+        fputc(0, file);
+    }
+
+    FILE* file = nullptr;       ///< The output file.
+    int width = 0;              ///< The image width.
+    int height = 0;             ///< The image height.
+    uint32_t bits = 0;          ///< Bits not yet written to block.
+    int bit_count = 0;          ///< The number of bits in bits.
+    std::vector<uint8_t> block; ///< The compressed image data.
+};
+
+int main(int argc, char** argv) {
+    int scale = 2;
+    const char* paths[2] = {nullptr, nullptr};
+    int path_count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = atoi(argv[++i]);
+        } else if (path_count < 2) {
+            paths[path_count++] = argv[i];
+        } else {
+            path_count = 3;
+        }
+    }
+    if (path_count != 2 || scale < 1) {
+        fprintf(stderr, "usage: %s [--scale N] CAPTURE OUTPUT.gif\n", argv[0]);
+        return 2;
+    }
+
+    bool from_stdin = strcmp(paths[0], "-") == 0;
+    FILE* capture = from_stdin ? stdin : fopen(paths[0], "rb");
+    if (!capture) {
+        perror(paths[0]);
+        return 1;
+    }
+    GifWriter gif;
+    const int width = SCREEN_WIDTH * scale;
+    const int height = SCREEN_HEIGHT * scale;
+    if (!gif.open(paths[1], width, height)) {
+        perror(paths[1]);
+        return 1;
+    }
+
+    RemoteParser parser;
+    MirrorDecoder decoder(SCREEN_WIDTH / 8, SCREEN_HEIGHT / 8);
+    std::vector<uint8_t> pending(width * height);
+    bool have_pending = false;
+    uint32_t pending_ms = 0;
+    unsigned frames = 0;
+
+    while (true) {
+        size_t space;
+        uint8_t* buffer = parser.reserve(space);
+        size_t count = fread(buffer, 1, space, capture);
+        parser.commit(count);
+
+        RemoteFrame frame;
+        while (parser.next(frame)) {
+            if (frame.command != ((uint8_t)RemoteCommand::MIRROR_FRAME | REMOTE_REPLY_FLAG)) continue;
+            if (!decoder.apply(frame.payload, frame.length)) continue;
+
+            // A frame is shown until the next one arrives, so it is written one frame late.
+            if (have_pending) {
+                int delay_cs = (int)((decoder.timeMs() - pending_ms) / 10);
+                gif.addFrame(pending, delay_cs < 2 ? 2 : delay_cs);
+                frames++;
+            }
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    pending[y * width + x] = decoder.pixel(x / scale, y / scale) ? 1 : 0;
+                }
+            }
+            pending_ms = decoder.timeMs();
+            have_pending = true;
+        }
+        if (count == 0) break;
+    }
+    if (have_pending) {
+        gif.addFrame(pending, 100);
+        frames++;
+    }
+    gif.close();
+    if (!from_stdin) fclose(capture);
+
+    fprintf(stderr, "mirror: %u frames, %u bad records, %u CRC errors\n",
+            frames, (unsigned)decoder.errors(), (unsigned)parser.crcErrors());
+    return 0;
+}
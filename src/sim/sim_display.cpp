@@ -0,0 +1,91 @@
+/**
+ * @file sim_display.cpp
+ * @brief Implements the SimDisplay driver.
+ */
+#include "sim_display.hpp"
+#include <stdio.h>
+#include <string.h>
+
+SimDisplay* SimDisplay::instance = nullptr;
+
+SimDisplay::SimDisplay(const u8g2_cb_t* rotation, uint8_t /*reset*/, uint8_t /*clock*/, uint8_t /*data*/) : U8G2() {
+    instance = this;
+    memset(buffer, 0, sizeof(buffer));
+    memset(panel_memory, 0, sizeof(panel_memory));
+    // The same setup as u8g2_Setup_ssd1306_128x32_univision_f(), with the display
+    // callback replaced and no bus behind it.
+    u8g2_SetupDisplay(getU8g2(), displayCallback, u8x8_cad_empty, u8x8_byte_empty, u8x8_dummy_cb);
+    u8g2_SetupBuffer(getU8g2(), buffer, TILE_HEIGHT, u8g2_ll_hvline_vertical_top_lsb, rotation);
+}
+
+void SimDisplay::clearBuffer() {
+    frames_drawn++;
+    frame_start = std::chrono::steady_clock::now();
+    U8G2::clearBuffer();
+}
+
+bool SimDisplay::pixel(int x, int y) const {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return false;
+    return (panel_memory[(y / 8) * WIDTH + x] >> (y % 8)) & 1;
+}
+
+bool SimDisplay::writePbm(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    fprintf(file, "P4\n%d %d\n", WIDTH, HEIGHT);
+    for (int y = 0; y < HEIGHT; y++) {
+        uint8_t row[WIDTH / 8] = {0};
+        for (int x = 0; x < WIDTH; x++) {
+            if (pixel(x, y)) row[x / 8] |= 0x80 >> (x % 8);
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+    return fclose(file) == 0;
+}
+
+/**
+ * @brief The U8x8 display callback.
+ * @details A DRAW_TILE message carries @p arg_int repetitions of `cnt` tiles from the
+ * same source, placed side by side starting at the tile's position.
+ */
+uint8_t SimDisplay::displayCallback(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+    static u8x8_display_info_t info;
+    switch (msg) {
+    case U8X8_MSG_DISPLAY_SETUP_MEMORY:
+        memset(&info, 0, sizeof(info));
+        info.i2c_bus_clock_100kHz = 4;
+        info.tile_width = TILE_WIDTH;
+        info.tile_height = TILE_HEIGHT;
+        info.pixel_width = WIDTH;
+        info.pixel_height = HEIGHT;
+        u8x8_d_helper_display_setup_memory(u8x8, &info);
+        return 1;
+    case U8X8_MSG_DISPLAY_INIT:
+        u8x8_d_helper_display_init(u8x8);
+        return 1;
+    case U8X8_MSG_DISPLAY_SET_POWER_SAVE:
+    case U8X8_MSG_DISPLAY_SET_CONTRAST:
+    case U8X8_MSG_DISPLAY_SET_FLIP_MODE:
+        return 1;
+    case U8X8_MSG_DISPLAY_DRAW_TILE: {
+        const u8x8_tile_t* tile = static_cast<const u8x8_tile_t*>(arg_ptr);
+        if (!instance || tile->y_pos >= TILE_HEIGHT) return 1;
+        int x = tile->x_pos;
+        for (int repeat = 0; repeat < arg_int; repeat++) {
+            for (int i = 0; i < tile->cnt && x < TILE_WIDTH; i++, x++) {
+                memcpy(&instance->panel_memory[tile->y_pos * WIDTH + x * 8], tile->tile_ptr + i * 8, 8);
+                instance->bytes_sent += 8;
+            }
+        }
+        return 1;
+    }
+    case U8X8_MSG_DISPLAY_REFRESH:
+        if (instance) {
+            instance->refresh_count++;
+            if (instance->refresh_handler) instance->refresh_handler(*instance);
+        }
+        return 1;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file sim_display.hpp
+ * @brief Defines SimDisplay, a U8g2 driver whose panel is a framebuffer in host memory.
+ * @ingroup Simulator
+ */
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <U8g2lib.h>
+#include "../delegate.hpp"
+
+/**
+ * @class SimDisplay
+ * @brief A 128x32 U8g2 full-buffer driver that "sends" tiles into an emulated panel.
+ * @ingroup Simulator
+ *
+ * Drawing goes through the unmodified U8g2 core, and the driver receives the same tile
+ * transfers and refreshes as the SSD1306 would, so the panel memory shows exactly what
+ * the OLED would show, including the effect of partial updates. Each refresh is reported
+ * to a handler, e.g. the simulator's frame dump. The driver also counts the frames drawn
+ * and the bytes sent, for the simulator's benchmark report. The constructor has the same
+ * signature as the hardware driver it replaces; the pins are ignored.
+ */
+class SimDisplay : public U8G2 {
+public:
+    /// Called after every display refresh, i.e. every transferred frame.
+    using RefreshHandler = Delegate<void(const SimDisplay& display)>;
+
+    static constexpr int WIDTH = 128;               ///< The panel width in pixels.
+    static constexpr int HEIGHT = 32;               ///< The panel height in pixels.
+    static constexpr int TILE_WIDTH = WIDTH / 8;    ///< The panel width in 8x8 tiles.
+    static constexpr int TILE_HEIGHT = HEIGHT / 8;  ///< The panel height in 8x8 tiles.
+
+    /**
+     * @brief Construct a new SimDisplay.
+     * @param rotation The U8g2 rotation, e.g. U8G2_R0.
+     * @param reset Ignored.
+     * @param clock Ignored.
+     * @param data Ignored.
+     */
+    SimDisplay(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+               uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE);
+
+    /**
+     * @brief Clears the framebuffer and marks the start of a frame.
+     * @details Hides U8G2::clearBuffer(). Every UI loop starts a frame with it, and the
+     * controller calls it on the concrete driver type, so this sees every drawn frame.
+     */
+    void clearBuffer();
+
+    /**
+     * @brief Gets the number of frames started with clearBuffer().
+     * @return The number of drawn frames.
+     */
+    uint32_t framesDrawn() const { return frames_drawn; }
+
+    /**
+     * @brief Gets the host time at which the last frame was started.
+     * @return The time of the last clearBuffer().
+     */
+    std::chrono::steady_clock::time_point frameStart() const { return frame_start; }
+
+    /**
+     * @brief Gets the number of bytes sent to the panel since construction.
+     * @return The tile bytes of all transfers, i.e. what the I2C bus would carry as data.
+     */
+    uint64_t bytesSent() const { return bytes_sent; }
+
+    /**
+     * @brief Reads a pixel of the panel, i.e. of the last transferred frame.
+     * @param x The column, 0 to WIDTH - 1.
+     * @param y The row, 0 to HEIGHT - 1.
+     * @return true if the pixel is lit.
+     */
+    bool pixel(int x, int y) const;
+
+    /**
+     * @brief Gets the panel memory, in U8g2 tile layout.
+     * @return WIDTH * HEIGHT / 8 bytes.
+     */
+    const uint8_t* panel() const { return panel_memory; }
+
+    /**
+     * @brief Gets the number of refreshes since construction.
+     * @return The number of transferred frames.
+     */
+    uint32_t refreshCount() const { return refresh_count; }
+
+    /**
+     * @brief Sets the function called after every refresh.
+     * @param handler The handler, or nullptr.
+     */
+    void setRefreshHandler(RefreshHandler handler) { refresh_handler = handler; }
+
+    /**
+     * @brief Writes the panel as a binary PBM image, lit pixels black.
+     * @param path The file to write.
+     * @return true if the file was written.
+     */
+    bool writePbm(const char* path) const;
+
+private:
+    /// The U8x8 display callback: accepts tile transfers into the panel memory.
+    static uint8_t displayCallback(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr);
+    /// The instance the display callback writes to.
+    static SimDisplay* instance;
+
+    uint8_t buffer[WIDTH * HEIGHT / 8];       ///< The U8g2 framebuffer that is drawn into.
+    uint8_t panel_memory[WIDTH * HEIGHT / 8]; ///< The emulated display RAM.
+    uint32_t refresh_count = 0;               ///< The number of refreshes.
+    uint32_t frames_drawn = 0;                ///< The number of clearBuffer() calls.
+    uint64_t bytes_sent = 0;                  ///< The number of tile bytes transferred.
+    std::chrono::steady_clock::time_point frame_start; ///< The host time of the last clearBuffer().
+    RefreshHandler refresh_handler;           ///< Called after every refresh.
+};
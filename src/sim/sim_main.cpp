@@ -0,0 +1,85 @@
+/**
+ * @file sim_main.cpp
+ * @brief Entry point of the host simulator: runs the firmware's setup() against a script.
+ *
+ * Usage: `program [-o DIRECTORY] [--report FILE] [--replies FILE] [--config FILE] [--host-time] [SCRIPT | -]`
+ *
+ * Runs the same setup() as the device, with the menus and pages of main.cpp. The script
+ * is read from a file, or from stdin for `-`; without a script the UI idles until
+ * Simulator::SETTLE_MS have passed. With `-o`, every frame sent to the display is
+ * written to DIRECTORY as a PBM image, which any image tool converts to PNG. With
+ * `--report`, the phases the script marks are measured and reported as JSON. With
+ * `--replies`, the remote-control replies to the script's `send` commands are decoded
+ * and logged one per line instead of writing serial output to stdout. With `--config`,
+ * the saved settings are kept in FILE, so they survive into the next run like they
+ * survive a reboot on the device; the summary counts the flash writes either way.
+ *
+ * The scripts in the sim/ directory of the repository exercise the menus, the remote
+ * protocol, the encoder decoding and the settings store.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "simulator.hpp"
+#include "sim_storage.hpp"
+#include "../config.hpp"
+
+extern DisplayDriver OLED;
+void setup();
+void loop();
+
+int main(int argc, char** argv) {
+    const char* frame_directory = nullptr;
+    const char* script = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            frame_directory = argv[++i];
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            FILE* report = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+            if (!report) {
+                perror(path);
+                return 1;
+            }
+            g_simulator.setReport(report);
+        } else if (strcmp(argv[i], "--replies") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            FILE* replies = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+            if (!replies) {
+                perror(path);
+                return 1;
+            }
+            g_simulator.setReplyLog(replies);
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            g_sim_config_backend.setFile(argv[++i]);
+        } else if (strcmp(argv[i], "--host-time") == 0) {
+            g_simulator.setHostTime(true);
+        } else if (!script && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            script = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-o DIRECTORY] [--report FILE] [--replies FILE] [--config FILE] [--host-time] [SCRIPT | -]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (script) {
+        bool from_stdin = strcmp(script, "-") == 0;
+        FILE* file = from_stdin ? stdin : fopen(script, "r");
+        if (!file) {
+            perror(script);
+            return 1;
+        }
+        bool loaded = g_simulator.loadScript(file, script);
+        if (!from_stdin) fclose(file);
+        if (!loaded) return 1;
+    }
+
+    g_simulator.attachDisplay(OLED, frame_directory);
+
+    // setup() runs the UI loop and does not return; the simulator ends the process
+    // once the script is done.
+    setup();
+    while (true) {
+        loop();
+        delay(1);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file sim_storage.cpp
+ * @brief Implements the simulator's settings backend.
+ */
+#include "sim_storage.hpp"
+#include <stdio.h>
+#include <string.h>
+
+SimConfigBackend g_sim_config_backend;
+
+ConfigBackend& defaultConfigBackend() {
+    return g_sim_config_backend;
+}
+
+void SimConfigBackend::setFile(const char* path) {
+    this->path = path;
+    record.clear();
+    FILE* file = fopen(path, "rb");
+    if (!file) return;
+    uint8_t buffer[256];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        record.insert(record.end(), buffer, buffer + count);
+    }
+    fclose(file);
+}
+
+size_t SimConfigBackend::read(uint8_t* data, size_t capacity) {
+    // Like Preferences::getBytes(), a record that does not fit is not read at all.
+    if (record.empty() || record.size() > capacity) return 0;
+    memcpy(data, record.data(), record.size());
+    return record.size();
+}
+
+bool SimConfigBackend::write(const uint8_t* data, size_t length) {
+    write_count++;
+    record.assign(data, data + length);
+    if (!path) return true;
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "sim: cannot write %s\n", path);
+        return false;
+    }
+    bool written = fwrite(data, 1, length, file) == length;
+    fclose(file);
+    return written;
+}
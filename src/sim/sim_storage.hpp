@@ -0,0 +1,44 @@
+/**
+ * @file sim_storage.hpp
+ * @brief Defines the simulator's stand-in for the NVS settings backend.
+ * @ingroup Simulator
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "../config_store.hpp"
+
+/**
+ * @class SimConfigBackend
+ * @brief Keeps the settings record in memory, or in a file to survive between runs, and counts the writes.
+ * @ingroup Simulator
+ *
+ * Every write() stands for one flash write on the device, so the count shows how well
+ * the ConfigStore coalesces edits.
+ */
+class SimConfigBackend : public ConfigBackend {
+public:
+    /**
+     * @brief Keeps the record in a file. A record already in the file is loaded.
+     * @param path The file, which must outlive the backend.
+     */
+    void setFile(const char* path);
+
+    size_t read(uint8_t* data, size_t capacity) override;
+    bool write(const uint8_t* data, size_t length) override;
+
+    /**
+     * @brief Gets the number of writes.
+     * @return The write count.
+     */
+    uint32_t writes() const { return write_count; }
+
+private:
+    std::vector<uint8_t> record; ///< The stored record, empty if none.
+    const char* path = nullptr;  ///< The file the record is kept in, or nullptr.
+    uint32_t write_count = 0;    ///< The calls to write().
+};
+
+/// @brief The backend returned by defaultConfigBackend() in the simulator.
+extern SimConfigBackend g_sim_config_backend;
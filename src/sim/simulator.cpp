@@ -0,0 +1,458 @@
+/**
+ * @file simulator.cpp
+ * @brief Implements the Simulator.
+ */
+#include "simulator.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include "../config.hpp"
+#include "sim_storage.hpp"
+
+Simulator g_simulator;
+
+/// The time between the edges of one encoder detent.
+static constexpr uint32_t QUADRATURE_EDGE_MS = 2;
+/// The time between repeated detents, clicks and cancels.
+static constexpr uint32_t REPEAT_INTERVAL_MS = 40;
+/// How long scripted button presses are held. Longer than the debounce time.
+static constexpr uint32_t BUTTON_HOLD_MS = BUTTON_DEBOUNCE_MS + 30;
+/// The time between two script commands.
+static constexpr uint32_t COMMAND_GAP_MS = 100;
+
+/// The encoder pin states of one detent, `(A << 1) | B`, starting from the idle state 0b11.
+static const uint8_t CW_STATES[] = {0b10, 0b00, 0b01, 0b11};
+static const uint8_t CCW_STATES[] = {0b01, 0b00, 0b10, 0b11};
+
+/// The names `send` accepts for the remote commands.
+static const struct {
+    const char* name;
+    RemoteCommand command;
+} COMMAND_NAMES[] = {
+    {"ping", RemoteCommand::PING},
+    {"input", RemoteCommand::INPUT_EVENTS},
+    {"navigate", RemoteCommand::NAVIGATE},
+    {"get", RemoteCommand::GET_CONFIG},
+    {"set", RemoteCommand::SET_CONFIG},
+    {"profile", RemoteCommand::PROFILE},
+    {"mirror", RemoteCommand::MIRROR},
+};
+
+/// A Print that appends to a byte vector, to build scripted frames with RemoteWriter.
+class VectorPrint : public Print {
+public:
+    explicit VectorPrint(std::vector<uint8_t>& bytes) : bytes(bytes) {}
+    size_t write(uint8_t c) override {
+        bytes.push_back(c);
+        return 1;
+    }
+    using Print::write;
+
+private:
+    std::vector<uint8_t>& bytes;
+};
+
+Simulator::Simulator() : last_sleep(std::chrono::steady_clock::now()) {}
+
+// --- Time ---
+
+uint64_t Simulator::nowUs() const {
+    if (!host_time) return now_us;
+    auto elapsed = std::chrono::steady_clock::now() - last_sleep;
+    return now_us + std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+/**
+ * @brief Advances the simulated time, applying the scripted events that fall due.
+ * @details Every UI loop iteration ends in a sleep, so the frame drawn since the last
+ * sleep is complete here and is measured first. Edges and marks are applied in time order.
+ */
+void Simulator::sleep(uint64_t us) {
+    recordFrame();
+    uint64_t target = nowUs() + us;
+    last_sleep = std::chrono::steady_clock::now();
+
+    size_t first_chunk = next_chunk;
+    while (next_chunk < serial_chunks.size() && serial_chunks[next_chunk].time_us <= target) {
+        size_t begin = next_chunk > 0 ? serial_chunks[next_chunk - 1].end : 0;
+        serial_rx.insert(serial_rx.end(), serial_script.begin() + begin,
+                         serial_script.begin() + serial_chunks[next_chunk].end);
+        next_chunk++;
+    }
+    if (next_chunk != first_chunk) Serial.received();
+
+    while (true) {
+        bool edge_due = next_edge < edges.size() && edges[next_edge].time_us <= target;
+        bool mark_due = next_mark < marks.size() && marks[next_mark].time_us <= target;
+        if (!edge_due && !mark_due) break;
+
+        if (mark_due && (!edge_due || marks[next_mark].time_us <= edges[next_edge].time_us)) {
+            const Mark& mark = marks[next_mark++];
+            if (mark.time_us > now_us) now_us = mark.time_us;
+            Phase phase;
+            memcpy(phase.name, mark.name, sizeof(phase.name));
+            phase.start_us = now_us;
+            phases.push_back(phase);
+        } else {
+            const PinEdge& edge = edges[next_edge++];
+            if (edge.time_us > now_us) now_us = edge.time_us;
+            writePin(edge.pin, edge.level);
+        }
+    }
+    now_us = target;
+
+    if (next_edge == edges.size() && next_mark == marks.size() && next_chunk == serial_chunks.size() &&
+        now_us >= cursor_us + settle_us) {
+        finish("script done");
+    }
+}
+
+void Simulator::setHostTime(bool enabled) {
+    host_time = enabled;
+    last_sleep = std::chrono::steady_clock::now();
+}
+
+// --- GPIO ---
+
+void Simulator::setPinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= PIN_COUNT) return;
+    if (mode & PULLUP) {
+        pins[pin].level = HIGH;
+    } else if (mode & PULLDOWN) {
+        pins[pin].level = LOW;
+    }
+}
+
+int Simulator::readPin(uint8_t pin) const {
+    return pin < PIN_COUNT ? pins[pin].level : LOW;
+}
+
+void Simulator::writePin(uint8_t pin, uint8_t level) {
+    if (pin >= PIN_COUNT || pins[pin].level == level) return;
+    Pin& p = pins[pin];
+    p.level = level;
+    bool fires = p.mode == CHANGE || (p.mode == RISING && level == HIGH) || (p.mode == FALLING && level == LOW);
+    if (fires && p.handler) p.handler();
+}
+
+void Simulator::attachInterrupt(uint8_t pin, Delegate<void()> handler, int mode) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = handler;
+    pins[pin].mode = mode;
+}
+
+void Simulator::detachInterrupt(uint8_t pin) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = nullptr;
+    pins[pin].mode = 0;
+}
+
+// --- Script ---
+
+bool Simulator::loadScript(FILE* file, const char* name) {
+    char line[128];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        if (!schedule(line)) {
+            fprintf(stderr, "%s:%d: unknown command: %s\n", name, line_number, line);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Schedules one script command.
+ * @details Blank lines are accepted and do nothing.
+ */
+bool Simulator::schedule(const char* line) {
+    char command[16] = "";
+    long count = 1;
+    long interval_ms = 0;
+    int fields = sscanf(line, "%15s %ld %ld", command, &count, &interval_ms);
+    if (fields <= 0) return true;
+    if (strcmp(command, "send") == 0 || strcmp(command, "serial") == 0) {
+        int consumed = 0;
+        sscanf(line, "%*s%n", &consumed);
+        if (!scheduleSerial(command, line + consumed)) return false;
+        cursor_us += COMMAND_GAP_MS * 1000ULL;
+        return true;
+    }
+    if (count < 0) return false;
+
+    if (strcmp(command, "cw") == 0 || strcmp(command, "ccw") == 0) {
+        // With an interval, detents start that far apart, e.g. to test encoder acceleration.
+        const uint64_t detent_us = 4 * QUADRATURE_EDGE_MS * 1000ULL;
+        uint64_t gap_us = REPEAT_INTERVAL_MS * 1000ULL;
+        if (fields >= 3) {
+            if (interval_ms < 0 || (uint64_t)interval_ms * 1000ULL < detent_us) return false;
+            gap_us = interval_ms * 1000ULL - detent_us;
+        }
+        for (long i = 0; i < count; i++) {
+            if (i > 0) cursor_us += gap_us;
+            scheduleDetent(command[1] == 'w');
+        }
+    } else if (strcmp(command, "click") == 0) {
+        for (long i = 0; i < count; i++) {
+            if (i > 0) cursor_us += REPEAT_INTERVAL_MS * 1000ULL;
+            scheduleEdge(PIN_ENCODER_BUTTON, LOW);
+            cursor_us += BUTTON_HOLD_MS * 1000ULL;
+            scheduleEdge(PIN_ENCODER_BUTTON, HIGH);
+        }
+    } else if (strcmp(command, "press") == 0) {
+        scheduleEdge(PIN_ENCODER_BUTTON, LOW);
+    } else if (strcmp(command, "release") == 0) {
+        scheduleEdge(PIN_ENCODER_BUTTON, HIGH);
+    } else if (strcmp(command, "cancel") == 0) {
+        for (long i = 0; i < count; i++) {
+            if (i > 0) cursor_us += REPEAT_INTERVAL_MS * 1000ULL;
+            scheduleEdge(PIN_CANCEL, HIGH);
+            cursor_us += BUTTON_HOLD_MS * 1000ULL;
+            scheduleEdge(PIN_CANCEL, LOW);
+        }
+    } else if (strcmp(command, "quad") == 0) {
+        char state[3] = "";
+        long wait_us = QUADRATURE_EDGE_MS * 1000;
+        if (sscanf(line, "%*s %2[01] %ld", state, &wait_us) < 1 || strlen(state) != 2 || wait_us < 0) return false;
+        uint8_t next = (uint8_t)(((state[0] - '0') << 1) | (state[1] - '0'));
+        // Both pins may change at once, e.g. to replay a missed edge.
+        if ((next ^ encoder_state) & 0b10) scheduleEdge(PIN_ENCODER_A, (next >> 1) & 1);
+        if ((next ^ encoder_state) & 0b01) scheduleEdge(PIN_ENCODER_B, next & 1);
+        encoder_state = next;
+        cursor_us += wait_us;
+        return true;
+    } else if (strcmp(command, "wait") == 0) {
+        if (fields < 2) return false;
+        cursor_us += count * 1000ULL;
+        return true;
+    } else if (strcmp(command, "mark") == 0) {
+        char name[32] = "";
+        sscanf(line, "%*s %31s", name);
+        Mark mark;
+        mark.time_us = cursor_us;
+        memcpy(mark.name, name, sizeof(name));
+        marks.push_back(mark);
+        // Reserved now, so that starting a phase in sleep() does not count as an
+        // allocation of the phase before.
+        phases.reserve(marks.size());
+        return true;
+    } else if (strcmp(command, "quit") == 0) {
+        settle_us = 0;
+        return true;
+    } else {
+        return false;
+    }
+    cursor_us += COMMAND_GAP_MS * 1000ULL;
+    return true;
+}
+
+/**
+ * @brief Parses the arguments of `send` and `serial` and schedules the bytes.
+ * @details Bytes are numbers in C syntax (`12`, `0x0C`); a token with a `.` is a float.
+ */
+bool Simulator::scheduleSerial(const char* command, const char* arguments) {
+    bool framed = strcmp(command, "send") == 0;
+    int frame_command = -1;
+    uint8_t bytes[REMOTE_MAX_PAYLOAD];
+    size_t length = 0;
+    char token[32];
+    int consumed;
+    while (sscanf(arguments, "%31s%n", token, &consumed) == 1) {
+        arguments += consumed;
+        char* end;
+        if (framed && frame_command < 0) {
+            for (size_t i = 0; i < sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]); i++) {
+                if (strcmp(token, COMMAND_NAMES[i].name) == 0) frame_command = (int)COMMAND_NAMES[i].command;
+            }
+            if (frame_command < 0) {
+                long value = strtol(token, &end, 0);
+                if (*end || value < 0 || value > 255) return false;
+                frame_command = (int)value;
+            }
+        } else if (strchr(token, '.')) {
+            float value = strtof(token, &end);
+            if (*end || length + sizeof(value) > sizeof(bytes)) return false;
+            memcpy(bytes + length, &value, sizeof(value));
+            length += sizeof(value);
+        } else {
+            long value = strtol(token, &end, 0);
+            if (*end || value < 0 || value > 255 || length == sizeof(bytes)) return false;
+            bytes[length++] = (uint8_t)value;
+        }
+    }
+
+    if (framed) {
+        if (frame_command < 0) return false;
+        VectorPrint out(serial_script);
+        RemoteWriter(out).send((uint8_t)frame_command, bytes, length);
+    } else {
+        serial_script.insert(serial_script.end(), bytes, bytes + length);
+    }
+    serial_chunks.push_back(SerialChunk{cursor_us, serial_script.size()});
+    return true;
+}
+
+void Simulator::scheduleEdge(uint8_t pin, uint8_t level) {
+    edges.push_back(PinEdge{cursor_us, pin, level});
+}
+
+/**
+ * @brief Schedules one encoder detent: a full quadrature cycle, one pin edge at a time.
+ */
+void Simulator::scheduleDetent(bool clockwise) {
+    const uint8_t* states = clockwise ? CW_STATES : CCW_STATES;
+    uint8_t previous = 0b11;
+    for (int i = 0; i < 4; i++) {
+        uint8_t changed = previous ^ states[i];
+        if (changed & 0b10) scheduleEdge(PIN_ENCODER_A, (states[i] >> 1) & 1);
+        if (changed & 0b01) scheduleEdge(PIN_ENCODER_B, states[i] & 1);
+        previous = states[i];
+        cursor_us += QUADRATURE_EDGE_MS * 1000ULL;
+    }
+}
+
+// --- Serial ---
+
+size_t Simulator::serialRead(uint8_t* buffer, size_t length) {
+    size_t available = serialAvailable();
+    if (length > available) length = available;
+    memcpy(buffer, serial_rx.data() + serial_read, length);
+    serial_read += length;
+    if (serial_read == serial_rx.size()) {
+        serial_rx.clear();
+        serial_read = 0;
+    }
+    return length;
+}
+
+/**
+ * @brief Handles bytes the firmware writes to the serial port.
+ * @details With a reply log, each complete frame is written as one line: the simulated
+ * time in milliseconds, the command byte, the status and the rest of the payload in hex.
+ * Anything that is not a frame, e.g. text printed by the firmware, is dropped.
+ */
+size_t Simulator::serialWrite(const uint8_t* buffer, size_t length) {
+    if (!reply_log) return fwrite(buffer, 1, length, stdout);
+
+    size_t taken = 0;
+    while (taken < length) {
+        size_t count = reply_parser.receive(buffer + taken, length - taken);
+        taken += count;
+        RemoteFrame frame;
+        while (reply_parser.next(frame)) {
+            fprintf(reply_log, "%llu reply 0x%02X", (unsigned long long)(now_us / 1000), frame.command);
+            if (frame.length > 0) fprintf(reply_log, " status %u:", frame.payload[0]);
+            for (size_t i = 1; i < frame.length; i++) fprintf(reply_log, " %02X", frame.payload[i]);
+            fprintf(reply_log, "\n");
+        }
+        if (count == 0) break;
+    }
+    return length;
+}
+
+// --- Output ---
+
+void Simulator::attachDisplay(SimDisplay& display, const char* directory) {
+    frame_directory = directory;
+    this->display = &display;
+    display.setRefreshHandler(SimDisplay::RefreshHandler(onRefresh, this));
+}
+
+void Simulator::onRefresh(void* context, const SimDisplay& display) {
+    Simulator* simulator = static_cast<Simulator*>(context);
+    simulator->frames++;
+    if (!simulator->frame_directory) return;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05u.pbm", simulator->frame_directory, (unsigned)simulator->frames);
+    if (!display.writePbm(path)) {
+        fprintf(stderr, "sim: cannot write %s\n", path);
+    }
+}
+
+void Simulator::recordFrame() {
+    if (!display || display->framesDrawn() == frames_seen) return;
+
+    uint64_t allocations = allocationCount();
+    if (!phases.empty()) {
+        auto elapsed = std::chrono::steady_clock::now() - display->frameStart();
+        uint32_t draw_us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        Phase& phase = phases.back();
+        phase.frames += display->framesDrawn() - frames_seen;
+        phase.last_frame_us = now_us;
+        phase.draw_us += draw_us;
+        if (draw_us > phase.max_draw_us) phase.max_draw_us = draw_us;
+        phase.bytes += display->bytesSent() - bytes_seen;
+        phase.allocations += allocations - allocations_seen;
+    }
+    frames_seen = display->framesDrawn();
+    bytes_seen = display->bytesSent();
+    allocations_seen = allocations;
+}
+
+void Simulator::addResult(const char* name, double value, const char* unit) {
+    results.push_back(Result{name, value, unit});
+}
+
+const Simulator::Phase* Simulator::findPhase(const char* name) const {
+    for (const Phase& phase : phases) {
+        if (strcmp(phase.name, name) == 0) return &phase;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Writes the benchmark report as one JSON object.
+ * @details settle_ms is the time from the start of a phase to its last drawn frame, i.e.
+ * how long the UI took to come to rest after the input of the phase.
+ */
+void Simulator::writeReport() const {
+    fprintf(report, "{\"phases\": [");
+    bool first = true;
+    for (size_t i = 0; i < phases.size(); i++) {
+        const Phase& phase = phases[i];
+        if (phase.name[0] == '\0') continue;
+        uint32_t frames = phase.frames ? phase.frames : 1;
+        fprintf(report,
+                "%s\n  {\"name\": \"%s\", \"frames\": %u, \"settle_ms\": %llu, "
+                "\"draw_us_mean\": %.1f, \"draw_us_max\": %u, "
+                "\"bytes\": %llu, \"bytes_per_frame\": %.1f, \"allocations\": %llu}",
+                first ? "" : ",", phase.name, (unsigned)phase.frames,
+                (unsigned long long)(phase.frames ? (phase.last_frame_us - phase.start_us) / 1000 : 0),
+                (double)phase.draw_us / frames, (unsigned)phase.max_draw_us,
+                (unsigned long long)phase.bytes, (double)phase.bytes / frames,
+                (unsigned long long)phase.allocations);
+        first = false;
+    }
+    fprintf(report, "\n]");
+    if (!results.empty()) {
+        fprintf(report, ",\n\"results\": [");
+        for (size_t i = 0; i < results.size(); i++) {
+            fprintf(report, "%s\n  {\"name\": \"%s\", \"value\": %.2f, \"unit\": \"%s\"}",
+                    i ? "," : "", results[i].name, results[i].value, results[i].unit);
+        }
+        fprintf(report, "\n]");
+    }
+    fprintf(report, "}\n");
+    fflush(report);
+}
+
+/**
+ * @brief Prints a summary and ends the process.
+ * @details The UI loop never returns, so the process is ended from inside it, with the
+ * status the finish handler returns. Static destructors are skipped on purpose: the
+ * controller and its pages are still in use.
+ */
+void Simulator::finish(const char* reason) {
+    Serial.flush();
+    if (reply_log) fflush(reply_log);
+    fprintf(stderr, "sim: %s after %llu ms, %u frames, %u config writes\n", reason,
+            (unsigned long long)(now_us / 1000), (unsigned)frames, (unsigned)g_sim_config_backend.writes());
+    fflush(stderr);
+    if (report && !phases.empty()) writeReport();
+    int status = finish_handler ? finish_handler() : 0;
+    fflush(stdout);
+    _Exit(status);
+}
@@ -0,0 +1,286 @@
+/**
+ * @file simulator.hpp
+ * @brief Defines the Simulator, which runs RingUI on a host with virtual time, GPIO and scripted input.
+ * @defgroup Simulator Host Simulator
+ * @{
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "../delegate.hpp"
+#include "../remote.hpp"
+#include "sim_display.hpp"
+
+/**
+ * @class Simulator
+ * @brief The host side of the Arduino shim: a virtual clock, pin levels and an input script.
+ * @ingroup Simulator
+ *
+ * Time only advances when the firmware sleeps, i.e. in delay(), so the UI loops run as
+ * fast as the host allows and every run of the same script produces the same frames.
+ * Input is injected at the GPIO level, as timed pin edges that run the attached interrupt
+ * handlers, so the real encoder and button decoding is part of the simulation.
+ *
+ * A script has one command per line; `#` starts a comment. Commands are scheduled one
+ * after the other:
+ * @code
+ * cw 2        # turn the encoder two detents clockwise
+ * click       # press and release the encoder button
+ * wait 500    # let the page animation finish
+ * cancel      # press the cancel button
+ * quit        # end the run now instead of after SETTLE_MS
+ * @endcode
+ * The other commands are `ccw [n]`, `click [n]`, `press`, `release` and `cancel [n]`.
+ * `cw n ms` and `ccw n ms` turn n detents that start ms milliseconds apart (at least
+ * 8), e.g. `cw 30 20` for a fast spin; without it detents are 48 ms apart.
+ * `quad AB [us]` sets the encoder pins to A and B and waits us microseconds (default
+ * 2000), so recorded pin traces, bounce included, can be replayed:
+ * @code
+ * quad 10 40  # A bounces for 40 us before B follows
+ * quad 11 30
+ * quad 10
+ * quad 00
+ * quad 01
+ * quad 11     # one detent clockwise
+ * @endcode
+ * When the script is done and the UI had SETTLE_MS to settle, the process exits.
+ *
+ * `send COMMAND [BYTE...]` sends a remote-control frame over the serial port, built with
+ * the firmware's own RemoteWriter. COMMAND is a RemoteCommand number or one of `ping`,
+ * `input`, `navigate`, `get`, `set`, `profile` and `mirror`; a byte containing a `.` is sent as a
+ * 4-byte float, e.g. `send set 0 0.3` sets the scroll Kp. `serial BYTE...` sends raw
+ * bytes, e.g. to test recovery from corrupted frames. With setReplyLog(), what the
+ * firmware writes to the serial port is decoded with RemoteParser, so a script and its
+ * reply log form a loopback test of the protocol.
+ *
+ * `mark NAME` starts a benchmark phase, and `mark` without a name ends it. For every frame drawn in a phase, the simulator
+ * records the host time spent on it (drawing, diffing and transferring), the bytes sent
+ * to the panel and the heap allocations, and finish() writes a JSON report of the phases
+ * and of the results added with addResult().
+ * Timings are measured on the host but not added to the simulated time, so frame content
+ * stays reproducible.
+ */
+class Simulator {
+public:
+    /// The measurements of a benchmark phase.
+    struct Phase {
+        char name[32];              ///< The phase name.
+        uint64_t start_us;          ///< The simulated time the phase started at.
+        uint64_t last_frame_us = 0; ///< The simulated time of the last frame in the phase.
+        uint32_t frames = 0;        ///< The number of frames drawn.
+        uint64_t draw_us = 0;       ///< The total host time of the frames.
+        uint32_t max_draw_us = 0;   ///< The longest host time of a frame.
+        uint64_t bytes = 0;         ///< The bytes sent to the panel.
+        uint64_t allocations = 0;   ///< The heap allocations.
+    };
+
+    /// The number of GPIO pins.
+    static constexpr int PIN_COUNT = 64;
+    /// The time the UI gets to settle after the last scripted input, in milliseconds.
+    static constexpr uint32_t SETTLE_MS = 1000;
+
+    Simulator();
+
+    // --- Time ---
+
+    /**
+     * @brief Gets the simulated time.
+     * @return The time since startup in microseconds.
+     */
+    uint64_t nowUs() const;
+
+    /**
+     * @brief Advances the simulated time, applying the scripted pin edges that fall due.
+     * @details Ends the process once the script is done and has settled.
+     * @param us The time to sleep in microseconds.
+     */
+    void sleep(uint64_t us);
+
+    /**
+     * @brief Adds the host time spent between sleeps to the simulated time.
+     * @details Makes frame time measurements meaningful for profiling, at the cost of
+     * runs no longer being reproducible.
+     * @param enabled true to count host time.
+     */
+    void setHostTime(bool enabled);
+
+    // --- GPIO ---
+
+    /// @brief Configures a pin. Pull-ups and pull-downs set the idle level.
+    void setPinMode(uint8_t pin, uint8_t mode);
+    /// @brief Reads the level of a pin.
+    int readPin(uint8_t pin) const;
+    /// @brief Drives a pin and runs its interrupt handler if the edge matches.
+    void writePin(uint8_t pin, uint8_t level);
+    /// @brief Attaches an interrupt handler to a pin.
+    void attachInterrupt(uint8_t pin, Delegate<void()> handler, int mode);
+    /// @brief Detaches the interrupt handler of a pin.
+    void detachInterrupt(uint8_t pin);
+
+    // --- Script and output ---
+
+    /**
+     * @brief Schedules the commands of a script after those already scheduled.
+     * @param file The script.
+     * @param name The name used in error messages.
+     * @return false if a line could not be parsed, which is reported on stderr.
+     */
+    bool loadScript(FILE* file, const char* name);
+
+    /**
+     * @brief Schedules one script command.
+     * @param line The command, e.g. "cw 3".
+     * @return false if the command is unknown.
+     */
+    bool schedule(const char* line);
+
+    /**
+     * @brief Dumps every transferred frame of a display as a PBM file.
+     * @param display The display to watch.
+     * @param directory The directory to write frame_00001.pbm etc. to, or nullptr to only count frames.
+     */
+    void attachDisplay(SimDisplay& display, const char* directory);
+
+    /**
+     * @brief Selects where finish() writes the benchmark report.
+     * @param out The stream, or nullptr for no report. Scripts without `mark` produce none.
+     */
+    void setReport(FILE* out) { report = out; }
+
+    /**
+     * @brief Sets a function that finish() calls before the process ends.
+     * @param handler The function, e.g. a test that checks the phases. It returns the exit status.
+     */
+    void setFinishHandler(Delegate<int()> handler) { finish_handler = handler; }
+
+    /**
+     * @brief Adds a measurement taken outside the script, e.g. by a microbenchmark, to the report.
+     * @param name The name of the measurement. It must outlive the simulator, e.g. a literal.
+     * @param value The measured value.
+     * @param unit The unit of the value, e.g. "ns". It must outlive the simulator.
+     */
+    void addResult(const char* name, double value, const char* unit);
+
+    /// @brief Gets the number of benchmark phases started so far, including unnamed ones.
+    size_t phaseCount() const { return phases.size(); }
+    /// @brief Gets the measurements of a phase, by name; nullptr if there is none.
+    const Phase* findPhase(const char* name) const;
+
+    /**
+     * @brief Decodes the serial output into reply frames, one text line each.
+     * @param out The stream the lines are written to, or nullptr to pass serial output
+     * through to stdout unchanged.
+     */
+    void setReplyLog(FILE* out) { reply_log = out; }
+
+    // --- Serial ---
+
+    /// @brief Gets the number of received bytes the firmware has not read yet.
+    size_t serialAvailable() const { return serial_rx.size() - serial_read; }
+    /// @brief Gets the next received byte without reading it, or -1.
+    int serialPeek() const { return serialAvailable() ? serial_rx[serial_read] : -1; }
+    /// @brief Reads received bytes.
+    size_t serialRead(uint8_t* buffer, size_t length);
+    /// @brief Handles bytes the firmware writes to the serial port.
+    size_t serialWrite(const uint8_t* buffer, size_t length);
+
+    /**
+     * @brief Gets the number of heap allocations since startup.
+     * @return The number of calls to the global operator new.
+     */
+    static uint64_t allocationCount();
+
+    /**
+     * @brief Prints a summary and ends the process.
+     * @param reason Why the simulation ended.
+     */
+    [[noreturn]] void finish(const char* reason);
+
+private:
+    /// A scheduled change of a pin level.
+    struct PinEdge {
+        uint64_t time_us; ///< When the edge happens.
+        uint8_t pin;      ///< The pin.
+        uint8_t level;    ///< The new level.
+    };
+
+    /// The start of a benchmark phase.
+    struct Mark {
+        uint64_t time_us;      ///< When the phase starts.
+        char name[32];         ///< The phase name.
+    };
+
+    /// A measurement added with addResult().
+    struct Result {
+        const char* name; ///< The name of the measurement.
+        double value;     ///< The measured value.
+        const char* unit; ///< The unit of the value.
+    };
+
+    /// Scripted serial input: bytes that arrive at once.
+    struct SerialChunk {
+        uint64_t time_us; ///< When the bytes arrive.
+        size_t end;       ///< One past the chunk's last byte in serial_script.
+    };
+
+    /// A pin and its interrupt handler.
+    struct Pin {
+        uint8_t level = 0;          ///< The current level.
+        int mode = 0;               ///< RISING, FALLING or CHANGE, or 0 without a handler.
+        Delegate<void()> handler;   ///< The interrupt handler.
+    };
+
+    /// Schedules an edge at the script cursor.
+    void scheduleEdge(uint8_t pin, uint8_t level);
+    /// Schedules one encoder detent.
+    void scheduleDetent(bool clockwise);
+    /// Parses the arguments of `send` and `serial` and schedules the bytes.
+    bool scheduleSerial(const char* command, const char* arguments);
+    /// Writes a frame to the frame directory.
+    static void onRefresh(void* context, const SimDisplay& display);
+    /// Adds the frame drawn since the last sleep, if any, to the current phase.
+    void recordFrame();
+    /// Writes the benchmark report.
+    void writeReport() const;
+
+    uint64_t now_us = 0;                ///< The simulated time.
+    bool host_time = false;             ///< True if host time is added at every sleep.
+    std::chrono::steady_clock::time_point last_sleep; ///< The host time of the last sleep.
+
+    Pin pins[PIN_COUNT];                ///< The pin levels and interrupt handlers.
+    std::vector<PinEdge> edges;         ///< The scripted edges, in time order.
+    size_t next_edge = 0;               ///< The first edge not yet applied.
+    uint64_t cursor_us = 0;             ///< The time the next script command is scheduled at.
+    uint8_t encoder_state = 0b11;       ///< The encoder pin state `(A << 1) | B` at cursor_us.
+    uint64_t settle_us = SETTLE_MS * 1000ULL; ///< The time the run continues after the script.
+
+    std::vector<uint8_t> serial_script; ///< The scripted serial bytes of all chunks.
+    std::vector<SerialChunk> serial_chunks; ///< The scripted serial input, in time order.
+    size_t next_chunk = 0;              ///< The first chunk not yet received.
+    std::vector<uint8_t> serial_rx;     ///< The received bytes.
+    size_t serial_read = 0;             ///< The first received byte not yet read.
+    FILE* reply_log = nullptr;          ///< Where decoded replies are written, or nullptr.
+    RemoteParser reply_parser;          ///< Splits the serial output into reply frames.
+
+    const char* frame_directory = nullptr; ///< Where frames are dumped, or nullptr.
+    uint32_t frames = 0;                ///< The number of frames seen.
+    const SimDisplay* display = nullptr; ///< The watched display.
+
+    std::vector<Mark> marks;            ///< The scripted phase starts, in time order.
+    size_t next_mark = 0;               ///< The first mark not yet reached.
+    std::vector<Phase> phases;          ///< The measured phases.
+    std::vector<Result> results;        ///< The measurements added with addResult().
+    FILE* report = nullptr;             ///< Where the report is written, or nullptr.
+    Delegate<int()> finish_handler;     ///< Called by finish(), or empty.
+    uint32_t frames_seen = 0;           ///< The display's frame count at the last sleep.
+    uint64_t bytes_seen = 0;            ///< The display's byte count at the last sleep.
+    uint64_t allocations_seen = 0;      ///< The allocation count at the last sleep.
+};
+
+/// @brief The simulator instance behind the Arduino shim.
+/// @ingroup Simulator
+extern Simulator g_simulator;
+/** @} */
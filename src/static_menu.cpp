@@ -0,0 +1,58 @@
+/**
+ * @file static_menu.cpp
+ * @brief Implements the StaticMenu class.
+ */
+#include "static_menu.hpp"
+
+int StaticMenu::size() const {
+    return table.count;
+}
+
+/**
+ * @brief Builds a MenuItem for an entry of the table.
+ * @details The item is only needed when an item is activated, so each menu has one
+ * buffer for it. The reference is valid until the next getItem() on the same menu.
+ */
+MenuItem& StaticMenu::getItem(int index) {
+    const StaticMenuItem& entry = table.items[index];
+    item.label = entry.label;
+    item.type = entry.type;
+    item.subMenu = entry.sub_menu;
+    item.action = entry.action;
+    item.on_close_callback = entry.on_close_callback;
+    item.switch_action = entry.switch_action;
+    item.get_switch_state = entry.get_switch_state;
+    return item;
+}
+
+StringView StaticMenu::label(int index) {
+    return table.items[index].label;
+}
+
+MenuItem::ItemType StaticMenu::itemType(int index) {
+    return table.items[index].type;
+}
+
+bool StaticMenu::switchState(int index) {
+    return table.items[index].get_switch_state ? table.items[index].get_switch_state() : false;
+}
+
+/**
+ * @brief Measures the switch state texts once per font, and the selected label whenever
+ * the selection changes.
+ */
+void StaticMenu::updateLayout(const uint8_t* font, const TextMeasure& measure) {
+    if (layout_font != font) {
+        MenuModel::updateLayout(font, measure);
+        selected_width_index = -1;
+    }
+    if (selected_width_index != selected && selected >= 0 && selected < table.count) {
+        selected_width = measure(table.items[selected].label);
+        selected_width_index = selected;
+    }
+}
+
+MenuItemLayout StaticMenu::itemLayout(int index) const {
+    int16_t width = index == selected_width_index ? selected_width : -1;
+    return MenuItemLayout{rowBaseline(index), width};
+}
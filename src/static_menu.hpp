@@ -0,0 +1,140 @@
+/**
+ * @file static_menu.hpp
+ * @brief Defines StaticMenu, a menu whose items are a constant table in flash.
+ * @ingroup MenuSystem
+ */
+#pragma once
+
+#include <stddef.h>
+#include "menu.hpp"
+
+/**
+ * @struct StaticMenuItem
+ * @brief A constant menu item: a label in flash and plain function pointers.
+ * @ingroup MenuSystem
+ *
+ * Items are declared with the constexpr factories option(), directory() and toggle(),
+ * so a whole table can be a `constexpr` array that lives in flash and needs no
+ * construction at startup:
+ * @code
+ * extern StaticMenu settingsMenu;
+ * constexpr StaticMenuItem mainItems[] = {
+ *     StaticMenuItem::directory("Settings", &settingsMenu),
+ *     StaticMenuItem::option("About", showAbout),
+ * };
+ * constexpr StaticMenuTable mainTable = StaticMenuTable::of("Main Menu", mainItems);
+ * StaticMenu mainMenu(mainTable);
+ * @endcode
+ */
+struct StaticMenuItem {
+    using PageFunction = Page* (*)();
+    using Callback = void (*)();
+    using StateFunction = bool (*)();
+
+    StringView label;              ///< The text to display for the item.
+    MenuItem::ItemType type;       ///< The type of the item.
+    MenuModel* sub_menu;           ///< The submenu, if this item is a DIRECTORY.
+    PageFunction action;           ///< Creates the page of an OPTION item, or nullptr.
+    Callback on_close_callback;    ///< Called after the page of an OPTION item is closed, or nullptr.
+    Callback switch_action;        ///< Toggles a SWITCH item.
+    StateFunction get_switch_state; ///< Gets the state of a SWITCH item.
+
+    /**
+     * @brief Declares an item that shows a page.
+     * @param label The text to display for the item.
+     * @param action A function that creates the page, or nullptr for a placeholder item.
+     * @param on_close_callback An optional function to call after the page is closed.
+     */
+    static constexpr StaticMenuItem option(StringView label, PageFunction action = nullptr,
+                                           Callback on_close_callback = nullptr) {
+        return StaticMenuItem{label, MenuItem::ItemType::OPTION, nullptr, action, on_close_callback, nullptr, nullptr};
+    }
+
+    /**
+     * @brief Declares an item that opens a submenu.
+     * @param label The text to display for the item.
+     * @param sub_menu The submenu to open.
+     */
+    static constexpr StaticMenuItem directory(StringView label, MenuModel* sub_menu) {
+        return StaticMenuItem{label, MenuItem::ItemType::DIRECTORY, sub_menu, nullptr, nullptr, nullptr, nullptr};
+    }
+
+    /**
+     * @brief Declares an item that toggles a boolean value.
+     * @param label The text to display for the item.
+     * @param switch_action A function that toggles the value.
+     * @param get_switch_state A function that returns the value.
+     */
+    static constexpr StaticMenuItem toggle(StringView label, Callback switch_action, StateFunction get_switch_state) {
+        return StaticMenuItem{label, MenuItem::ItemType::SWITCH, nullptr, nullptr, nullptr, switch_action, get_switch_state};
+    }
+};
+
+/**
+ * @struct StaticMenuTable
+ * @brief The constant part of a StaticMenu: its title, items and parent.
+ * @ingroup MenuSystem
+ *
+ * Declared `constexpr`, so the compiler rejects a menu whose description is not a
+ * compile-time constant, e.g. an item table that would be built at startup.
+ */
+struct StaticMenuTable {
+    StringView title;            ///< The title of the menu.
+    const StaticMenuItem* items; ///< The item table.
+    int count;                   ///< The number of items in the table.
+    MenuModel* parent;           ///< The parent menu, or nullptr for a root menu.
+
+    /**
+     * @brief Declares a menu over an item table.
+     * @param title The title of the menu.
+     * @param items The item table, a constexpr array.
+     * @param parent The parent menu, or nullptr for a root menu.
+     */
+    template <size_t N>
+    static constexpr StaticMenuTable of(StringView title, const StaticMenuItem (&items)[N], MenuModel* parent = nullptr) {
+        return StaticMenuTable{title, items, (int)N, parent};
+    }
+};
+
+/**
+ * @class StaticMenu
+ * @brief A menu over a constant StaticMenuItem table.
+ * @ingroup MenuSystem
+ *
+ * The constructor is constexpr and takes a constexpr StaticMenuTable, so a global
+ * StaticMenu is initialized at compile time: nothing is allocated or copied at startup,
+ * and the parent link is fixed in the declaration. Rows are drawn straight from the
+ * table, and only the label width of the selected item is measured and cached. Only
+ * activating an item builds a MenuItem, in a buffer of the menu's own.
+ */
+class StaticMenu : public MenuModel {
+public:
+    /**
+     * @brief Construct a new StaticMenu.
+     * @param table The menu's title, items and parent. It must outlive the menu, e.g. be constexpr.
+     */
+    constexpr explicit StaticMenu(const StaticMenuTable& table)
+        : MenuModel(table.parent), table(table), item() {}
+    /// A temporary table would not outlive the menu.
+    StaticMenu(const StaticMenuTable&& table) = delete;
+
+    /**
+     * @brief Gets the title of the menu.
+     * @return The menu's title.
+     */
+    StringView getTitle() const { return table.title; }
+
+    int size() const override;
+    MenuItem& getItem(int index) override;
+    StringView label(int index) override;
+    MenuItem::ItemType itemType(int index) override;
+    bool switchState(int index) override;
+    void updateLayout(const uint8_t* font, const TextMeasure& measure) override;
+    MenuItemLayout itemLayout(int index) const override;
+
+private:
+    const StaticMenuTable& table;  ///< The title, items and parent.
+    MenuItem item;                 ///< The item built by the last getItem().
+    int selected_width_index = -1; ///< The item whose label width is cached, or -1.
+    int16_t selected_width = 0;    ///< The cached label width of the selected item.
+};
@@ -0,0 +1,118 @@
+/**
+ * @file string_view.hpp
+ * @brief Defines StringView, a non-owning reference to a run of characters.
+ * @ingroup UI
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @class StringView
+ * @brief A pointer and a length into text owned by someone else.
+ * @ingroup UI
+ *
+ * Used for labels and page content instead of String, so slicing, copying and drawing
+ * text never allocates. The text does not have to be NUL-terminated, which is what lets
+ * substr() cut lines out of a larger buffer; draw a view with printTo() rather than
+ * passing data() to functions that expect a C string. The referenced text must outlive
+ * the view: string literals and StaticMenuItem tables always do.
+ */
+class StringView {
+public:
+    /// Returned by find() when the character is not present.
+    static constexpr size_t npos = (size_t)-1;
+
+    /// Constructs an empty view.
+    constexpr StringView() : ptr(""), len(0) {}
+
+    /**
+     * @brief Views a NUL-terminated string. Evaluated at compile time for literals.
+     * @param text The string, or nullptr for an empty view.
+     */
+    constexpr StringView(const char* text) : ptr(text ? text : ""), len(text ? __builtin_strlen(text) : 0) {}
+
+    /**
+     * @brief Views a run of characters.
+     * @param text The first character.
+     * @param length The number of characters.
+     */
+    constexpr StringView(const char* text, size_t length) : ptr(text), len(length) {}
+
+    /**
+     * @brief Views the contents of a String. The String must not change or be destroyed
+     * while the view is in use.
+     * @param text The string to view.
+     */
+    explicit StringView(const String& text) : ptr(text.c_str()), len(text.length()) {}
+
+    /// @brief Gets a pointer to the first character. Not necessarily NUL-terminated.
+    constexpr const char* data() const { return ptr; }
+    /// @brief Gets the number of characters.
+    constexpr size_t size() const { return len; }
+    /// @brief Checks whether the view has no characters.
+    constexpr bool empty() const { return len == 0; }
+    /// @brief Gets the character at an index, which must be less than size().
+    constexpr char operator[](size_t index) const { return ptr[index]; }
+
+    /**
+     * @brief Gets a part of the view.
+     * @param pos The index of the first character. Clamped to size().
+     * @param count The maximum number of characters.
+     * @return The part, which references the same text.
+     */
+    StringView substr(size_t pos, size_t count = npos) const {
+        if (pos > len) pos = len;
+        size_t rest = len - pos;
+        return StringView(ptr + pos, count < rest ? count : rest);
+    }
+
+    /**
+     * @brief Finds a character.
+     * @param c The character to look for.
+     * @param from The index to start at.
+     * @return The index of the first occurrence at or after @p from, or npos.
+     */
+    size_t find(char c, size_t from = 0) const {
+        if (from >= len) return npos;
+        const void* hit = memchr(ptr + from, c, len - from);
+        return hit ? (size_t)(static_cast<const char*>(hit) - ptr) : npos;
+    }
+
+    /**
+     * @brief Copies the characters into a buffer as a NUL-terminated string, e.g. for
+     * functions that only accept C strings. Text that does not fit is cut off.
+     * @param buffer The destination.
+     * @param capacity The size of @p buffer in bytes, including the terminator.
+     * @return The number of characters copied.
+     */
+    size_t copyTo(char* buffer, size_t capacity) const {
+        if (capacity == 0) return 0;
+        size_t count = len < capacity - 1 ? len : capacity - 1;
+        memcpy(buffer, ptr, count);
+        buffer[count] = '\0';
+        return count;
+    }
+
+    /**
+     * @brief Writes the characters to a stream, e.g. the display driver at its cursor.
+     * @param out The stream to write to.
+     * @return The number of bytes written.
+     */
+    size_t printTo(Print& out) const {
+        return out.write(reinterpret_cast<const uint8_t*>(ptr), len);
+    }
+
+    /// @brief Compares the characters of two views.
+    bool operator==(const StringView& other) const {
+        return len == other.len && memcmp(ptr, other.ptr, len) == 0;
+    }
+    /// @brief Compares the characters of two views.
+    bool operator!=(const StringView& other) const { return !(*this == other); }
+
+private:
+    const char* ptr; ///< The first character.
+    size_t len;      ///< The number of characters.
+};
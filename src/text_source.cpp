@@ -0,0 +1,89 @@
+/**
+ * @file text_source.cpp
+ * @brief Implements the text sources and the chunk cache.
+ */
+#include "text_source.hpp"
+#include <string.h>
+
+// --- MemoryTextSource Implementation ---
+
+size_t MemoryTextSource::read(size_t offset, char* buffer, size_t length) {
+    StringView part = text.substr(offset, length);
+    memcpy(buffer, part.data(), part.size());
+    return part.size();
+}
+
+// --- StdioTextSource Implementation ---
+
+StdioTextSource::StdioTextSource(FILE* file) : file(file), file_size(0) {
+    if (file && fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        file_size = end > 0 ? (size_t)end : 0;
+    }
+}
+
+size_t StdioTextSource::read(size_t offset, char* buffer, size_t length) {
+    if (!file || offset >= file_size) return 0;
+    if (fseek(file, (long)offset, SEEK_SET) != 0) return 0;
+    return fread(buffer, 1, length, file);
+}
+
+// --- ChunkCache Implementation ---
+
+ChunkCache::ChunkCache(TextSource& source)
+    : source(source), text_size(source.size()), data(STREAM_CHUNK_SIZE * STREAM_CHUNK_COUNT) {}
+
+int ChunkCache::at(size_t offset) {
+    if (offset >= text_size) return -1;
+    int slot = load(offset / STREAM_CHUNK_SIZE);
+    size_t within = offset % STREAM_CHUNK_SIZE;
+    if (within >= chunks[slot].length) return -1;
+    return (unsigned char)data[slot * STREAM_CHUNK_SIZE + within];
+}
+
+size_t ChunkCache::copy(size_t offset, char* buffer, size_t length) {
+    size_t copied = 0;
+    while (copied < length && offset < text_size) {
+        int slot = load(offset / STREAM_CHUNK_SIZE);
+        size_t within = offset % STREAM_CHUNK_SIZE;
+        if (within >= chunks[slot].length) break;
+        size_t count = chunks[slot].length - within;
+        if (count > length - copied) count = length - copied;
+        memcpy(buffer + copied, &data[slot * STREAM_CHUNK_SIZE + within], count);
+        copied += count;
+        offset += count;
+    }
+    return copied;
+}
+
+/**
+ * @brief Finds a chunk, reading it into the least recently used slot on a miss.
+ * @details The slot of the previous access is checked first, since text is mostly
+ * scanned byte by byte.
+ */
+int ChunkCache::load(size_t index) {
+    clock++;
+    if (last_slot >= 0 && chunks[last_slot].index == index) {
+        chunks[last_slot].last_used = clock;
+        return last_slot;
+    }
+
+    int victim = 0;
+    for (int i = 0; i < STREAM_CHUNK_COUNT; i++) {
+        if (chunks[i].index == index) {
+            chunks[i].last_used = clock;
+            last_slot = i;
+            return i;
+        }
+        if (chunks[i].last_used < chunks[victim].last_used) {
+            victim = i;
+        }
+    }
+
+    Chunk& chunk = chunks[victim];
+    chunk.index = index;
+    chunk.length = source.read(index * STREAM_CHUNK_SIZE, &data[victim * STREAM_CHUNK_SIZE], STREAM_CHUNK_SIZE);
+    chunk.last_used = clock;
+    last_slot = victim;
+    return victim;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file text_source.hpp
+ * @brief Defines the TextSource interface for text that is read on demand, and a chunk cache over it.
+ * @ingroup Pages
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "config.hpp"
+#include "string_view.hpp"
+
+/**
+ * @class TextSource
+ * @brief Random-access text that does not have to be in memory, e.g. a file or a flash partition.
+ * @ingroup Pages
+ */
+class TextSource {
+public:
+    virtual ~TextSource() {}
+
+    /**
+     * @brief Gets the size of the text.
+     * @return The size in bytes.
+     */
+    virtual size_t size() const = 0;
+
+    /**
+     * @brief Reads a part of the text.
+     * @param offset The index of the first byte to read.
+     * @param buffer The destination.
+     * @param length The number of bytes to read.
+     * @return The number of bytes read, which is less than @p length only at the end of the text.
+     */
+    virtual size_t read(size_t offset, char* buffer, size_t length) = 0;
+
+    /**
+     * @brief Gets the number of display lines, if the source knows it, for the scrollbar.
+     * @return The line count, or -1 if unknown, in which case the scrollbar follows the byte position.
+     */
+    virtual int lineCount() const { return -1; }
+};
+
+/**
+ * @class MemoryTextSource
+ * @brief A TextSource over text that is already addressable, e.g. in flash or a log buffer.
+ * @ingroup Pages
+ */
+class MemoryTextSource : public TextSource {
+public:
+    /**
+     * @param text The text. It is not copied and must outlive the source.
+     */
+    explicit MemoryTextSource(StringView text) : text(text) {}
+
+    size_t size() const override { return text.size(); }
+    size_t read(size_t offset, char* buffer, size_t length) override;
+
+private:
+    StringView text; ///< The text.
+};
+
+/**
+ * @class StdioTextSource
+ * @brief A TextSource over a stdio file.
+ * @ingroup Pages
+ *
+ * Works for files on a mounted SPIFFS or LittleFS partition (e.g. "/littlefs/log.txt")
+ * as well as for regular files on a host build.
+ */
+class StdioTextSource : public TextSource {
+public:
+    /**
+     * @param file An open file, read from its current contents. The source does not close it.
+     */
+    explicit StdioTextSource(FILE* file);
+
+    size_t size() const override { return file_size; }
+    size_t read(size_t offset, char* buffer, size_t length) override;
+
+private:
+    FILE* file;       ///< The file.
+    size_t file_size; ///< The size of the file when the source was created.
+};
+
+/**
+ * @class ChunkCache
+ * @brief A small least-recently-used cache of fixed-size chunks of a TextSource.
+ * @ingroup Pages
+ *
+ * Holds STREAM_CHUNK_COUNT chunks of STREAM_CHUNK_SIZE bytes, so only the text around
+ * the scroll position is in memory no matter how large the source is.
+ */
+class ChunkCache {
+public:
+    /**
+     * @param source The text to cache. Must outlive the cache.
+     */
+    explicit ChunkCache(TextSource& source);
+
+    /**
+     * @brief Gets the size of the source.
+     * @return The size in bytes.
+     */
+    size_t size() const { return text_size; }
+
+    /**
+     * @brief Gets one byte of the text.
+     * @param offset The index of the byte.
+     * @return The byte, or -1 past the end of the text.
+     */
+    int at(size_t offset);
+
+    /**
+     * @brief Copies a part of the text.
+     * @param offset The index of the first byte.
+     * @param buffer The destination.
+     * @param length The maximum number of bytes to copy.
+     * @return The number of bytes copied.
+     */
+    size_t copy(size_t offset, char* buffer, size_t length);
+
+private:
+    /// A chunk of the text held in the cache.
+    struct Chunk {
+        size_t index = SIZE_MAX; ///< The chunk number, i.e. offset / STREAM_CHUNK_SIZE, or SIZE_MAX if empty.
+        size_t length = 0;       ///< The number of valid bytes.
+        uint32_t last_used = 0;  ///< The access clock when the chunk was last used.
+    };
+
+    /// Finds a chunk, reading it into the least recently used slot on a miss.
+    int load(size_t index);
+
+    TextSource& source;                 ///< The cached text.
+    size_t text_size;                   ///< The size of the text.
+    std::vector<char> data;             ///< The chunk buffers, allocated once.
+    Chunk chunks[STREAM_CHUNK_COUNT];   ///< The cached chunks.
+    uint32_t clock = 0;                 ///< Incremented on every access, for the LRU order.
+    int last_slot = -1;                 ///< The slot of the last access, checked first.
+};
@@ -12,21 +12,31 @@
 #include <U8g2lib.h>
 #include "menu.hpp"
 #include "config.hpp"
-#include "pid.hpp"
+#include "animation.hpp"
 #include "input.hpp"
+#include "framebuffer.hpp"
+#include "frame_pipeline.hpp"
+#include "double_buffer.hpp"
+#include "frame_scheduler.hpp"
+#include "page_arena.hpp"
+#include "profiler.hpp"
+#include "remote.hpp"
+#include "mirror.hpp"
+#include "config_store.hpp"
 
 template <typename Driver>
 /**
  * @class RingController
  * @brief Manages the entire UI, including menus, pages, and animations.
  */
-class RingController {
+class RingController : private RemoteTarget {
 public:
     Driver& OLED;
     RingController(Driver& oled) : 
         OLED(oled),
-        anim_pid(g_config.anim_pid_kp, g_config.anim_pid_ki, g_config.anim_pid_kd),
-        scroll_pid(g_config.scroll_pid_kp, g_config.scroll_pid_ki, g_config.scroll_pid_kd)
+        sync_transport([this](const uint8_t* frame) { return transferFrame(frame); }),
+        display_buffer(oled),
+        frame_scheduler(TARGET_FPS)
     {}
 
     /**
@@ -37,66 +47,219 @@ public:
         OLED.enableUTF8Print();
         OLED.setFont(DEFAULT_TEXT_FONT);
         OLED.setFontMode(1);
+        frame_diff.begin(OLED.getBufferTileWidth(), OLED.getBufferTileHeight());
+        g_mirror.begin(OLED.getBufferTileWidth(), OLED.getBufferTileHeight());
+        display_buffer.begin(&sync_transport);
     }
     
     /**
-     * @brief Updates PID controller gains from the global config.
+     * @brief Moves the display transfer to a dedicated render task.
+     *
+     * Must be called after setup(). From then on the driver is double-buffered: every
+     * finished frame is handed to the render task, and the UI loop continues with input
+     * and animation in the other buffer while the frame is sent. Other code must not
+     * access the display bus (e.g. setContrast()) once the render task runs.
+     *
+     * Only the transfer moves. Frames are still composed on the UI task, and menu and
+     * page callbacks still run there, so a slow draw() or action callback still delays
+     * the next frame's input handling and animation.
+     * @param core The CPU core to pin the render task to, or -1 for any core.
+     * @return true if the render task was started.
+     */
+    bool startRenderTask(int core = RENDER_TASK_CORE) {
+        if (!pipeline.begin([this](const uint8_t* frame) { return transferFrame(frame); }, core)) {
+            return false;
+        }
+        display_buffer.begin(&pipeline);
+        return true;
+    }
+
+    /**
+     * @brief Gets the accumulated transfer and blocking times of presented frames.
+     * @details Use FrameTimeReport::print() to see how much CPU time the render task recovers.
+     * @return The report since the last resetFrameTimeReport().
+     */
+    const FrameTimeReport& frameTimeReport() const {
+        return display_buffer.frameTimeReport();
+    }
+
+    /**
+     * @brief Clears the accumulated frame timings.
+     */
+    void resetFrameTimeReport() {
+        display_buffer.resetReport();
+    }
+
+    /**
+     * @brief Changes the frame rate the UI loops aim for.
+     * @details Animation speed does not depend on the frame rate, only its smoothness.
+     * @param fps The target frame rate.
+     */
+    void setFrameRate(uint32_t fps) {
+        frame_scheduler.setTargetFps(fps);
+    }
+
+    /**
+     * @brief Gets the frame scheduler, e.g. to read the missed deadline count.
+     * @return A reference to the scheduler that paces the UI loops.
+     */
+    const FrameScheduler& frameScheduler() const {
+        return frame_scheduler;
+    }
+
+    /**
+     * @brief Constructs a page in the controller's page arena instead of on the heap.
+     * @details Meant for OPTION actions, e.g. `return controller.emplacePage<RebootPage>();`.
+     * The controller destroys the page when it is closed, and the next page reuses the
+     * same memory, so opening pages does not fragment the heap.
+     * @tparam T The page type. Must fit in PAGE_ARENA_SIZE bytes.
+     * @param args The arguments forwarded to the page's constructor.
+     * @return The page, or nullptr if another arena page is still open.
+     */
+    template <typename T, typename... Args>
+    T* emplacePage(Args&&... args) {
+        return page_arena.emplace<T>(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Gets the free-heap deltas measured around each page open/close cycle.
+     * @return The report since the last resetPageHeapReport().
+     */
+    const PageHeapReport& pageHeapReport() const {
+        return page_arena.heapReport();
+    }
+
+    /**
+     * @brief Clears the page heap report.
+     */
+    void resetPageHeapReport() {
+        page_arena.resetReport();
+    }
+
+    /**
+     * @brief Updates the animation gains from the global config.
      */
     void update_pid_gains() {
-        anim_pid.set_gains(g_config.anim_pid_kp, g_config.anim_pid_ki, g_config.anim_pid_kd);
-        scroll_pid.set_gains(g_config.scroll_pid_kp, g_config.scroll_pid_ki, g_config.scroll_pid_kd);
+        g_animator.applyGains();
+    }
+
+    /**
+     * @brief Gets the number of framebuffer bytes sent to the display by the last frame.
+     * @details Read from the frame-time report, which takes the count only once the
+     * transfer is fenced. With the render task running, the newest frame is fenced by the
+     * next present(), so this reports the frame before it.
+     * @return The byte count, or 0 if the frame was identical to the one before it.
+     */
+    size_t lastFrameBytes() const {
+        return display_buffer.frameTimeReport().last_frame_bytes;
+    }
+
+    /**
+     * @brief Requests a redraw of the current menu or page on the next frame.
+     * @details Menus and pages stop rendering once they are settled. Call this when
+     * state shown on screen changes outside of the UI, e.g. a switch toggled remotely.
+     */
+    void invalidate() {
+        redraw_requested = true;
+        label_width_cache.menu = nullptr;
     }
 
     /**
      * @brief The main entry point and loop for the UI.
-     * @param startMenu The root menu to display.
+     * @param startMenu The root menu to display. Any MenuModel, e.g. a Menu or a CallbackMenu.
      */
-    void handle(Menu* startMenu) {
+    void handle(MenuModel* startMenu) {
         if (!startMenu) return;
 
-        std::vector<Menu*> menuStack;
+        std::vector<MenuModel*> menuStack;
         menuStack.push_back(startMenu);
+        root_menu = startMenu;
 
         while (true) {
-            Menu* currentMenu = menuStack.back();
+            MenuModel* currentMenu = menuStack.back();
             pending_page = nullptr; // Reset pending page before showing a menu
             int selectedIndex = showMenu(currentMenu);
 
             if (selectedIndex >= 0) { // An item was selected
-                MenuItem& selectedItem = currentMenu->getItem(selectedIndex);
+                // Only the parts needed below are kept, since a model that produces items
+                // on demand may reuse the item's storage while the page or the next menu
+                // is drawn. Delegates copy without allocating.
+                const MenuItem& selectedItem = currentMenu->getItem(selectedIndex);
+                MenuItem::ItemType selectedType = selectedItem.type;
+                MenuModel* subMenu = selectedItem.subMenu;
+                Delegate<void()> onClose = selectedItem.on_close_callback;
 
                 if (pending_page) {
                     // If showMenu created a page, handle its lifecycle.
-                    handlePage(pending_page, currentMenu, selectedItem);
-                    delete pending_page;
+                    handlePage(pending_page, currentMenu);
+                    page_arena.release(pending_page);
                     pending_page = nullptr;
-                    if (selectedItem.on_close_callback) {
-                        selectedItem.on_close_callback();
+                    if (onClose) {
+                        onClose();
                     }
-                } else if (selectedItem.type == MenuItem::ItemType::DIRECTORY && selectedItem.subMenu) {
+                    // A page usually edits a setting; save it now rather than after the delay.
+                    g_config_store.flush();
+                } else if (selectedType == MenuItem::ItemType::DIRECTORY && subMenu) {
                     // If a directory was selected, transition to it.
-                    selectedItem.subMenu->selected = 0;
-                    animateTransition(currentMenu, selectedItem.subMenu, ANIM_FORWARD);
-                    menuStack.push_back(selectedItem.subMenu);
+                    subMenu->selected = 0;
+                    animateTransition(currentMenu, subMenu, ANIM_FORWARD);
+                    menuStack.push_back(subMenu);
                 }
                 // SWITCH items and OPTION items that don't create a page are fully handled
                 // inside showMenu() to prevent UI jitter, so no action is needed here.
 
+            } else if (selectedIndex == MENU_NAVIGATE) { // A remote command moved to another menu
+                followNavigation(menuStack);
             } else { // A menu was cancelled
                 if (menuStack.size() > 1) {
-                    Menu* parentMenu = menuStack[menuStack.size() - 2];
+                    MenuModel* parentMenu = menuStack[menuStack.size() - 2];
                     animateTransition(currentMenu, parentMenu, ANIM_BACKWARD);
                     menuStack.pop_back();
                 }
+                // Saves the switches toggled in the menu that was left.
+                g_config_store.flush();
             }
         }
     }
 
 private:
-    PIDController anim_pid;
-    PIDController scroll_pid;
     // Used to pass a newly created Page object from showMenu to handle.
     Page* pending_page = nullptr;
+    // Tracks the tiles that changed since the last transfer to the display.
+    FrameDiff frame_diff;
+    // Transfers frames inline, blocking the UI loop. Used until startRenderTask() is called.
+    SyncTransport sync_transport;
+    // Transfers frames from a dedicated task once startRenderTask() was called.
+    FramePipeline pipeline;
+    // Swaps the driver between two buffers when the transfer is asynchronous.
+    DoubleBuffer<Driver> display_buffer;
+    // Paces all UI loops and measures the real frame time for the animations.
+    FrameScheduler frame_scheduler;
+    // Records the phase timings of each frame. Empty unless built with RINGUI_PROFILER.
+    FrameProfiler profiler;
+#if defined(RINGUI_PROFILER)
+    // The time the performance HUD was last drawn, in milliseconds.
+    uint32_t hud_drawn_ms = 0;
+#endif
+    // Turns the detents in a menu into selection steps, accelerated if the menu opted in.
+    DetentAccelerator menu_accelerator;
+    // Holds the open page and measures the heap around each page's lifetime.
+    PageArena page_arena;
+    // Set by invalidate() to force a redraw of a settled menu or page.
+    bool redraw_requested = false;
+    // The label width selectedLabelWidth() measured last, and the item it belongs to.
+    struct {
+        const MenuModel* menu;
+        int index;
+        uint32_t layout_version;
+        int width;
+    } label_width_cache = {nullptr, -1, 0, 0};
+    // The menu handle() started with, which remote menu paths begin at.
+    MenuModel* root_menu = nullptr;
+    // The menu path of a pending remote NAVIGATE command, followed by handle().
+    uint8_t navigation_path[REMOTE_MAX_PATH];
+    // The length of navigation_path, or 0 if no navigation is pending.
+    size_t navigation_depth = 0;
 
     enum anim_direction {
         ANIM_FORWARD,
@@ -108,121 +271,349 @@ private:
      * @param page A pointer to the page to handle.
      * @param under_menu The menu that is displayed underneath the page during animations.
      */
-    void handlePage(Page* page, Menu* under_menu, MenuItem& item) {
-        double current_y, target_y;
-        double velocity_y = 0.0;
+    void handlePage(Page* page, MenuModel* under_menu) {
         int menu_y_offset = calculate_scroll_offset(under_menu);
 
         // --- Page Entry Animation ---
-        current_y = -SCREEN_HEIGHT;
-        target_y = 0;
-        anim_pid.reset();
-        while (abs(target_y - current_y) > 0.1 || abs(velocity_y) > 0.1) {
-            velocity_y = anim_pid.update(target_y, current_y);
-            current_y += velocity_y;
-
-            OLED.clearBuffer();
-            OLED.setDrawColor(1);
-            drawMenu(under_menu, 0, menu_y_offset);
-            page->draw(round(current_y));
-            OLED.sendBuffer();
-            delay(ANIMATION_DELAY);
-        }
+        Animation page_y(AnimationGains::TRANSITION, -SCREEN_HEIGHT);
+        page_y.animateTo(0);
+        slidePage(page, under_menu, menu_y_offset, page_y);
 
         // --- Page Main Loop ---
+        // The page is only redrawn when it reports new content or one of its animations
+        // moves, so a static page sleeps, leaving the CPU and the display bus idle until
+        // the next input event.
+        page->invalidate();
+        frame_scheduler.reset();
         while (true) {
-            if (page->handleInput()) {
+            AnimValue dt = beginFrame();
+            if (page->handleInput() || navigation_depth > 0) {
                 break;
             }
-
-            OLED.clearBuffer();
-            OLED.setDrawColor(1);
-            page->draw(0);
-            OLED.sendBuffer();
-            delay(ANIMATION_DELAY);
+            profiler.mark(FramePhase::HANDLE_INPUT);
+            page->animate(dt);
+            bool moving = g_animator.advance(dt);
+            profiler.mark(FramePhase::ANIMATE);
+
+            if (moving || page->needsRedraw() || redraw_requested) {
+                redraw_requested = false;
+                page->markDrawn();
+                OLED.clearBuffer();
+                OLED.setDrawColor(1);
+                page->draw(0);
+                present();
+                endFrame();
+            } else {
+                endIdleFrame();
+            }
         }
 
         // --- Page Exit Animation ---
-        current_y = 0;
-        target_y = -SCREEN_HEIGHT;
-        velocity_y = 0.0;
-        anim_pid.reset();
-        while (abs(target_y - current_y) > 0.1 || abs(velocity_y) > 0.1) {
-            velocity_y = anim_pid.update(target_y, current_y);
-            current_y += velocity_y;
+        page_y.animateTo(-SCREEN_HEIGHT);
+        slidePage(page, under_menu, menu_y_offset, page_y);
+    }
+
+    /**
+     * @brief Runs a page entry or exit animation until the page's position has settled.
+     * @param page The page being animated.
+     * @param under_menu The menu that is displayed underneath the page.
+     * @param menu_y_offset The scroll offset of the menu underneath.
+     * @param page_y The animated vertical offset of the page.
+     */
+    void slidePage(Page* page, MenuModel* under_menu, int menu_y_offset, Animation& page_y) {
+        frame_scheduler.reset();
+        while (!page_y.settled()) {
+            AnimValue dt = beginFrame();
+            page->animate(dt);
+            g_animator.advance(dt);
+            profiler.mark(FramePhase::ANIMATE);
 
             OLED.clearBuffer();
             OLED.setDrawColor(1);
             drawMenu(under_menu, 0, menu_y_offset);
-            page->draw(round(current_y));
-            OLED.sendBuffer();
-            delay(ANIMATION_DELAY);
+            page->draw(page_y.rounded());
+            present();
+            endFrame();
+        }
+    }
+
+    /**
+     * @brief Hands the finished frame in the driver's buffer over to the display.
+     * @details Replaces sendBuffer(). The frame is either handed to the render task, with
+     * drawing continuing in the second buffer, or transferred immediately. While the
+     * framebuffer mirror is on, it is also offered to g_mirror first.
+     */
+    void present() {
+#if defined(RINGUI_PROFILER)
+        if (g_config.show_profiler_hud) {
+            drawHud();
+        }
+#endif
+        profiler.mark(FramePhase::DRAW);
+        g_mirror.mirror(OLED.getBufferPtr());
+        display_buffer.present();
+        profiler.mark(FramePhase::TRANSFER);
+    }
+
+    /**
+     * @brief Starts a frame of a UI loop.
+     * @details Collects the encoder detents the interrupts could not complete yet and
+     * handles the remote commands received since the last frame, so their input events
+     * are seen by this frame, and lets the settings store write g_config once it
+     * has settled. Also requests a redraw when the performance HUD is due for an update,
+     * so its numbers stay current on a settled screen.
+     * @return The elapsed time since the previous frame, see FrameScheduler::beginFrame().
+     */
+    AnimValue beginFrame() {
+        profiler.beginFrame();
+        g_encoder.poll();
+        if (g_config.use_serial_control) {
+            g_remote.poll(*this);
+        }
+        g_config_store.poll();
+#if defined(RINGUI_PROFILER)
+        if (g_config.show_profiler_hud && millis() - hud_drawn_ms >= HUD_REFRESH_MS) {
+            redraw_requested = true;
+        }
+#endif
+        return frame_scheduler.beginFrame();
+    }
+
+    /**
+     * @brief Ends a frame of a UI loop and sleeps for the rest of the frame period.
+     */
+    void endFrame() {
+        frame_scheduler.endFrame();
+        profiler.endFrame();
+    }
+
+    /**
+     * @brief Ends a frame in which nothing moved or was drawn, and sleeps until there is work.
+     * @details Instead of waking every frame period, the loop sleeps on g_input_signal
+     * until input arrives or the next thing beginFrame() must do falls due: a pending
+     * encoder poll, the settings commit or the HUD refresh. While replies are still
+     * queued for the serial port, it wakes every frame to send them.
+     */
+    void endIdleFrame() {
+        endFrame();
+        uint32_t timeout = idleTimeoutMs();
+        if (timeout > 0) {
+            frame_scheduler.idle(g_input_signal, timeout);
+        }
+    }
+
+    /**
+     * @brief Gets how long a settled loop may sleep before beginFrame() has work to do.
+     * @return The time in milliseconds, 0 for none, or Signal::WAIT_FOREVER.
+     */
+    uint32_t idleTimeoutMs() {
+        if (g_config.use_serial_control && g_remote.sending()) return 0;
+        uint32_t timeout = g_encoder.idleTimeoutMs();
+        uint32_t commit = g_config_store.msUntilCommit();
+        if (commit < timeout) timeout = commit;
+#if defined(RINGUI_PROFILER)
+        if (g_config.show_profiler_hud) {
+            uint32_t since_hud = millis() - hud_drawn_ms;
+            uint32_t hud = since_hud >= HUD_REFRESH_MS ? 0 : HUD_REFRESH_MS - since_hud;
+            if (hud < timeout) timeout = hud;
         }
+#endif
+        return timeout;
     }
 
-    void drawMenuItems(Menu* menu, int x_offset, int y_offset, int skip_index = -1) {
-        if (!menu) return;
-        for (int i = 0; i < menu->size(); i++) {
-            if (i == skip_index) continue;
-            OLED.setCursor(x_offset + INIT_CURSOR_X + DEFAULT_TEXT_MARGIN, 
-                        i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + y_offset);
-            OLED.print(menu->getItem(i).label);
-            if (menu->getItem(i).type == MenuItem::ItemType::SWITCH) {
-                String state = menu->getItem(i).get_switch_state() ? "[ON]" : "[OFF]";
-                int state_width = OLED.getStrWidth(state.c_str());
-                OLED.setCursor(x_offset + SCREEN_WIDTH - state_width - DEFAULT_TEXT_MARGIN, 
-                            i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + y_offset);
-                OLED.print(state);
+    RemoteStatus navigate(const uint8_t* path, size_t depth) override {
+        MenuModel* menu = root_menu;
+        for (size_t i = 0; i < depth; i++) {
+            if (!menu || path[i] >= menu->size()) return RemoteStatus::BAD_PATH;
+            if (i + 1 < depth) {
+                const MenuItem& item = menu->getItem(path[i]);
+                if (item.type != MenuItem::ItemType::DIRECTORY) return RemoteStatus::BAD_PATH;
+                menu = item.subMenu;
             }
         }
+        memcpy(navigation_path, path, depth);
+        navigation_depth = depth;
+        return RemoteStatus::OK;
     }
 
-    void drawMenu(Menu* menu, int x_offset, int y_offset) {
-        if (!menu || menu->size() == 0) return;
+    void configChanged() override {
+        update_pid_gains();
+        invalidate();
+    }
+
+#if defined(RINGUI_PROFILER)
+    const FrameProfiler* frameProfiler() const override {
+        return &profiler;
+    }
+#endif
+
+    /**
+     * @brief Replaces the menu stack with the path of a pending NAVIGATE command.
+     * @details The path was checked when it arrived; should a menu have shrunk since,
+     * the walk stops at the last menu that still has the item.
+     * @param menuStack The stack of handle(), which keeps the root menu.
+     */
+    void followNavigation(std::vector<MenuModel*>& menuStack) {
+        MenuModel* from = menuStack.back();
+        menuStack.resize(1);
+        MenuModel* menu = menuStack[0];
+        for (size_t i = 0; i < navigation_depth; i++) {
+            if (navigation_path[i] >= menu->size()) break;
+            menu->selected = navigation_path[i];
+            if (i + 1 == navigation_depth) break;
+            MenuModel* subMenu = menu->getItem(navigation_path[i]).subMenu;
+            if (!subMenu) break;
+            subMenu->selected = 0;
+            menuStack.push_back(subMenu);
+            menu = subMenu;
+        }
+        navigation_depth = 0;
+        if (menu != from) {
+            animateTransition(from, menu, ANIM_FORWARD);
+        }
+    }
 
-        double currentY = menu->selected * DEFAULT_TEXT_HEIGHT;
-        String selectedLabel = menu->getItem(menu->selected).label;
-        double currentWidth = OLED.getStrWidth(selectedLabel.c_str());
-
-        for (int i = 0; i < menu->size(); i++) {
-            OLED.setCursor(x_offset + INIT_CURSOR_X + DEFAULT_TEXT_MARGIN, 
-                        i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + y_offset);
-            OLED.print(menu->getItem(i).label);
-            if (menu->getItem(i).type == MenuItem::ItemType::SWITCH) {
-                String state = menu->getItem(i).get_switch_state() ? "[ON]" : "[OFF]";
-                int state_width = OLED.getStrWidth(state.c_str());
-                OLED.setCursor(x_offset + SCREEN_WIDTH - state_width - DEFAULT_TEXT_MARGIN, 
-                            i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + y_offset);
-                OLED.print(state);
+#if defined(RINGUI_PROFILER)
+    /**
+     * @brief Draws the frame rate, the worst frame time and the free heap in the top right corner.
+     * @details Drawn last, over whatever the frame contains, in an inverted box.
+     */
+    void drawHud() {
+        char text[24];
+        uint32_t worst_us = profiler.worstFrameUs();
+        snprintf(text, sizeof(text), "%ufps %u.%ums %uk", (unsigned)profiler.fps(),
+                 (unsigned)(worst_us / 1000), (unsigned)(worst_us / 100 % 10),
+                 (unsigned)(ESP.getFreeHeap() / 1024));
+        OLED.setFont(u8g2_font_4x6_tr);
+        int width = OLED.getStrWidth(text) + 2;
+        int x = SCREEN_WIDTH - width;
+        OLED.setMaxClipWindow();
+        OLED.setDrawColor(0);
+        OLED.drawBox(x, 0, width, 7);
+        OLED.setDrawColor(1);
+        OLED.drawStr(x + 1, 6, text);
+        OLED.setFont(DEFAULT_TEXT_FONT);
+        hud_drawn_ms = millis();
+    }
+#endif
+
+    /**
+     * @brief Sends the tiles of a frame that changed since the previous transfer.
+     * @details Only the dirty span of each tile row is transferred, and nothing is sent at
+     * all if the frame did not change. The tiles are read from @p frame rather than the
+     * driver's current buffer, so the render task can send one buffer while the other is drawn.
+     * @param frame The frame to send, in U8g2 tile layout.
+     * @return The framebuffer bytes sent.
+     */
+    size_t transferFrame(const uint8_t* frame) {
+        int span_count = frame_diff.update(frame);
+        if (span_count == 0) return 0;
+
+        u8x8_t* u8x8 = OLED.getU8x8();
+        size_t row_bytes = (size_t)OLED.getBufferTileWidth() * 8;
+        for (int i = 0; i < span_count; i++) {
+            const FrameDiff::Span& span = frame_diff.span(i);
+            uint8_t* tiles = const_cast<uint8_t*>(frame) + span.y * row_bytes + span.x * 8;
+            u8x8_DrawTile(u8x8, span.x, span.y, span.width, tiles);
+        }
+        u8x8_RefreshDisplay(u8x8);
+        return frame_diff.dirtyBytes();
+    }
+
+    /// Measures a text in the current font. U8g2 only measures C strings, so the text is
+    /// copied to a stack buffer first.
+    int textWidth(StringView text) {
+        char buffer[MAX_MEASURED_TEXT + 1];
+        text.copyTo(buffer, sizeof(buffer));
+        return OLED.getStrWidth(buffer);
+    }
+
+    /// Measures the menu's items in the default font if its layout cache is stale.
+    void layoutMenu(MenuModel* menu) {
+        menu->updateLayout(DEFAULT_TEXT_FONT, [this](StringView text) { return textWidth(text); });
+    }
+
+    /// Gets the label width of the selected item, or 0 for an empty menu. The label is
+    /// only measured if the model has no width for it, and the result is kept until the
+    /// selection, the menu or its layout changes, so a settled menu measures nothing.
+    int selectedLabelWidth(MenuModel* menu) {
+        if (menu->size() == 0) return 0;
+        if (label_width_cache.menu == menu && label_width_cache.index == menu->selected &&
+            label_width_cache.layout_version == menu->layoutVersion()) {
+            return label_width_cache.width;
+        }
+        layoutMenu(menu);
+        int width = menu->itemLayout(menu->selected).label_width;
+        if (width < 0) {
+            width = textWidth(menu->label(menu->selected));
+        }
+        label_width_cache.menu = menu;
+        label_width_cache.index = menu->selected;
+        label_width_cache.layout_version = menu->layoutVersion();
+        label_width_cache.width = width;
+        return width;
+    }
+
+    /**
+     * @brief Draws the rows of a menu that intersect a horizontal band of the screen.
+     * @details Only the visible rows are laid out and printed, so the cost of a frame does
+     * not depend on the length of the menu.
+     * @param menu The menu to draw.
+     * @param x_offset The horizontal offset of the list.
+     * @param y_offset The vertical offset of the list, i.e. the negated scroll position.
+     * @param band_top The first screen row that needs to be drawn.
+     * @param band_bottom The screen row below the last one that needs to be drawn.
+     */
+    void drawMenuItems(MenuModel* menu, int x_offset, int y_offset, int band_top = 0, int band_bottom = SCREEN_HEIGHT) {
+        if (!menu || menu->size() == 0) return;
+        if (x_offset <= -SCREEN_WIDTH || x_offset >= SCREEN_WIDTH) return;
+        band_top = max(band_top, 0);
+        band_bottom = min(band_bottom, SCREEN_HEIGHT);
+        if (band_top >= band_bottom) return;
+
+        // Row i covers [i * H + y_offset, (i + 1) * H + y_offset).
+        int first = band_top - y_offset;
+        first = first > 0 ? first / DEFAULT_TEXT_HEIGHT : 0;
+        int last = band_bottom - 1 - y_offset;
+        if (last < 0) return;
+        last = min(last / DEFAULT_TEXT_HEIGHT, menu->size() - 1);
+
+        layoutMenu(menu);
+        for (int i = first; i <= last; i++) {
+            int baseline = menu->itemLayout(i).baseline + y_offset;
+            OLED.setCursor(x_offset + INIT_CURSOR_X + DEFAULT_TEXT_MARGIN, baseline);
+            menu->label(i).printTo(OLED);
+            if (menu->itemType(i) == MenuItem::ItemType::SWITCH) {
+                bool on = menu->switchState(i);
+                OLED.setCursor(x_offset + SCREEN_WIDTH - menu->switchStateWidth(on) - DEFAULT_TEXT_MARGIN, baseline);
+                OLED.print(on ? SWITCH_ON_TEXT : SWITCH_OFF_TEXT);
             }
         }
+    }
+
+    void drawMenu(MenuModel* menu, int x_offset, int y_offset) {
+        if (!menu || menu->size() == 0) return;
+
+        int currentY = menu->selected * DEFAULT_TEXT_HEIGHT;
+        int currentWidth = selectedLabelWidth(menu);
+
+        drawMenuItems(menu, x_offset, y_offset);
         
-        int selected_box_y = round(currentY) + y_offset;
+        int selected_box_y = currentY + y_offset;
 
         OLED.drawRBox(x_offset + INIT_CURSOR_X, selected_box_y, 
-                    round(currentWidth) + 2 * DEFAULT_TEXT_MARGIN, DEFAULT_TEXT_HEIGHT, 2);
+                    currentWidth + 2 * DEFAULT_TEXT_MARGIN, DEFAULT_TEXT_HEIGHT, 2);
         
         OLED.setDrawColor(0);
         OLED.setClipWindow(x_offset + INIT_CURSOR_X, selected_box_y, 
-                        x_offset + INIT_CURSOR_X + round(currentWidth) + 2 * DEFAULT_TEXT_MARGIN, selected_box_y + DEFAULT_TEXT_HEIGHT);
-
-        for (int i = 0; i < menu->size(); i++) {
-            OLED.setCursor(x_offset + INIT_CURSOR_X + DEFAULT_TEXT_MARGIN, 
-                        i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + y_offset);
-            OLED.print(menu->getItem(i).label);
-            if (menu->getItem(i).type == MenuItem::ItemType::SWITCH) {
-                String state = menu->getItem(i).get_switch_state() ? "[ON]" : "[OFF]";
-                int state_width = OLED.getStrWidth(state.c_str());
-                OLED.setCursor(x_offset + SCREEN_WIDTH - state_width - DEFAULT_TEXT_MARGIN, 
-                            i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + y_offset);
-                OLED.print(state);
-            }
-        }
+                        x_offset + INIT_CURSOR_X + currentWidth + 2 * DEFAULT_TEXT_MARGIN, selected_box_y + DEFAULT_TEXT_HEIGHT);
+
+        drawMenuItems(menu, x_offset, y_offset, selected_box_y, selected_box_y + DEFAULT_TEXT_HEIGHT);
 
         OLED.setMaxClipWindow();
     }
 
-    int calculate_scroll_offset(Menu* menu) {
+    int calculate_scroll_offset(MenuModel* menu) {
         if (!menu) return 0;
         int scrollScreen = 0;
         int currentY = menu->selected * DEFAULT_TEXT_HEIGHT;
@@ -235,44 +626,36 @@ private:
         return scrollScreen;
     }
 
-    void animateTransition(Menu* from, Menu* to, anim_direction direction) {
-        double current_x_to = (direction == ANIM_FORWARD) ? SCREEN_WIDTH : -SCREEN_WIDTH;
-        double target_x_to = 0;
-        double velocity_to = 0.0;
-        double x_offset_from;
+    void animateTransition(MenuModel* from, MenuModel* to, anim_direction direction) {
         int from_y_offset = calculate_scroll_offset(from);
 
-        anim_pid.reset();
+        frame_scheduler.reset();
 
         if (direction == ANIM_FORWARD && to == nullptr) {
-            double current_x_from = 0;
-            double target_x_from = -SCREEN_WIDTH;
-            while (abs(target_x_from - current_x_from) > 0.1 || abs(velocity_to) > 0.1) {
-                velocity_to = anim_pid.update(target_x_from, current_x_from);
-                current_x_from += velocity_to;
+            Animation from_x(AnimationGains::TRANSITION, 0);
+            from_x.animateTo(-SCREEN_WIDTH);
+            while (!from_x.settled()) {
+                AnimValue dt = beginFrame();
+                g_animator.advance(dt);
+                profiler.mark(FramePhase::ANIMATE);
 
                 OLED.clearBuffer();
                 OLED.setDrawColor(1);
-                drawMenu(from, round(current_x_from), from_y_offset);
-                OLED.sendBuffer();
-                delay(ANIMATION_DELAY);
+                drawMenu(from, from_x.rounded(), from_y_offset);
+                present();
+                endFrame();
             }
             return;
         }
         
         int to_y_offset = calculate_scroll_offset(to);
 
-        double select_y_current, select_y_target;
-        double select_w_current, select_w_target;
-        double velocity_y = 0.0, velocity_w = 0.0;
+        int select_y_current, select_y_target;
+        int select_w_current, select_w_target;
 
         if (from) {
             select_y_current = from->selected * DEFAULT_TEXT_HEIGHT + from_y_offset;
-            if (from->size() > 0) {
-                select_w_current = OLED.getStrWidth(from->getItem(from->selected).label.c_str());
-            } else {
-                select_w_current = 0;
-            }
+            select_w_current = selectedLabelWidth(from);
         } else {
             select_y_current = SCREEN_HEIGHT / 2;
             select_w_current = 0;
@@ -280,43 +663,40 @@ private:
 
         if (to) {
             select_y_target = to->selected * DEFAULT_TEXT_HEIGHT + to_y_offset;
-            if (to->size() > 0) {
-                select_w_target = OLED.getStrWidth(to->getItem(to->selected).label.c_str());
-            } else {
-                select_w_target = 0;
-            }
+            select_w_target = selectedLabelWidth(to);
         } else {
             select_y_target = select_y_current;
             select_w_target = SCREEN_WIDTH;
         }
 
-        PIDController y_pid(g_config.anim_pid_kp, g_config.anim_pid_ki, g_config.anim_pid_kd);
-        PIDController w_pid(g_config.anim_pid_kp, g_config.anim_pid_ki, g_config.anim_pid_kd);
+        Animation to_x(AnimationGains::TRANSITION, (direction == ANIM_FORWARD) ? SCREEN_WIDTH : -SCREEN_WIDTH);
+        Animation select_y(AnimationGains::TRANSITION, select_y_current);
+        Animation select_w(AnimationGains::TRANSITION, select_w_current);
+        to_x.animateTo(0);
+        select_y.animateTo(select_y_target);
+        select_w.animateTo(select_w_target);
 
-        while (abs(target_x_to - current_x_to) > 0.1 || abs(velocity_to) > 0.1) {
-            velocity_to = anim_pid.update(target_x_to, current_x_to);
-            current_x_to += velocity_to;
+        while (!to_x.settled()) {
+            AnimValue dt = beginFrame();
+            g_animator.advance(dt);
+            profiler.mark(FramePhase::ANIMATE);
 
+            int x_offset_to = to_x.rounded();
+            int x_offset_from;
             if (direction == ANIM_FORWARD) {
-                x_offset_from = current_x_to - SCREEN_WIDTH;
+                x_offset_from = x_offset_to - SCREEN_WIDTH;
             } else {
-                x_offset_from = current_x_to + SCREEN_WIDTH;
+                x_offset_from = x_offset_to + SCREEN_WIDTH;
             }
 
-            velocity_y = y_pid.update(select_y_target, select_y_current);
-            select_y_current += velocity_y;
-
-            velocity_w = w_pid.update(select_w_target, select_w_current);
-            select_w_current += velocity_w;
-
             OLED.clearBuffer();
             OLED.setDrawColor(1);
 
-            drawMenuItems(from, round(x_offset_from), from_y_offset);
-            drawMenuItems(to, round(current_x_to), to_y_offset);
+            drawMenuItems(from, x_offset_from, from_y_offset);
+            drawMenuItems(to, x_offset_to, to_y_offset);
 
-            int box_y = round(select_y_current);
-            int box_w = round(select_w_current);
+            int box_y = select_y.rounded();
+            int box_w = select_w.rounded();
 
             OLED.drawRBox(INIT_CURSOR_X, box_y, box_w + 2 * DEFAULT_TEXT_MARGIN, DEFAULT_TEXT_HEIGHT, 2);
             
@@ -325,106 +705,137 @@ private:
             OLED.setClipWindow(INIT_CURSOR_X, box_y, 
                                INIT_CURSOR_X + box_w + 2 * DEFAULT_TEXT_MARGIN, box_y + DEFAULT_TEXT_HEIGHT);
 
-            drawMenuItems(from, round(x_offset_from), from_y_offset);
-            drawMenuItems(to, round(current_x_to), to_y_offset);
+            drawMenuItems(from, x_offset_from, from_y_offset, box_y, box_y + DEFAULT_TEXT_HEIGHT);
+            drawMenuItems(to, x_offset_to, to_y_offset, box_y, box_y + DEFAULT_TEXT_HEIGHT);
 
             OLED.setMaxClipWindow();
 
-            OLED.sendBuffer();
-            delay(ANIMATION_DELAY);
+            present();
+            endFrame();
         }
     }
 
+    /// Returned by activateItem() when the menu should stay open.
+    static constexpr int MENU_STAY = -2;
+    /// Returned by showMenu() when a remote command asked for another menu.
+    static constexpr int MENU_NAVIGATE = -3;
+
     /**
-     * @brief Displays a menu, handles its internal animation and input, and returns the selected index.
-     * @param menu The menu to show.
-     * @return The selected item's index, or -1 if cancelled.
+     * @brief Performs the action of the selected menu item.
+     * @param menu The menu whose selected item was pressed.
+     * @return The selected index if the menu must be left, or MENU_STAY.
      */
-    int showMenu(Menu* menu) {
-        unsigned long previousMillis_Input = 0;
-        
-        double currentY = menu->selected * DEFAULT_TEXT_HEIGHT;
-        double velocityY = 0.0;
+    int activateItem(MenuModel* menu) {
+        MenuItem& item = menu->getItem(menu->selected);
+
+        // For items that don't navigate away, handle them here and stay in the menu loop
+        // to prevent exiting and re-entering the menu, which causes a UI jitter.
+        if (item.type == MenuItem::ItemType::SWITCH) {
+            if (item.switch_action) {
+                item.switch_action();
+            }
+            return MENU_STAY;
+        }
+
+        if (item.type == MenuItem::ItemType::OPTION) {
+            page_arena.beginCycle();
+            Page* page = item.action ? item.action() : nullptr;
+            if (page) {
+                // If a page is created, set it as pending and return to the handler.
+                pending_page = page;
+                return menu->selected;
+            }
+            // No page was created, so stay in the menu loop.
+            return MENU_STAY;
+        }
 
-        String initialLabel = menu->getItem(menu->selected).label;
-        double currentWidth = OLED.getStrWidth(initialLabel.c_str());
-        double velocityW = 0.0;
+        // For DIRECTORY items, we need to exit to the main handler to change the menu.
+        return menu->selected;
+    }
 
-        scroll_pid.reset();
-        PIDController width_pid(g_config.scroll_pid_kp, g_config.scroll_pid_ki, g_config.scroll_pid_kd);
+    /**
+     * @brief Displays a menu, handles its internal animation and input, and returns the selected index.
+     * @param menu The menu to show.
+     * @return The selected item's index, -1 if cancelled, or MENU_NAVIGATE.
+     */
+    int showMenu(MenuModel* menu) {
+        Animation highlight_y(AnimationGains::SCROLL, menu->selected * DEFAULT_TEXT_HEIGHT);
+        Animation highlight_w(AnimationGains::SCROLL, selectedLabelWidth(menu));
+        // The selection and the layout the highlight was last aimed at.
+        int highlight_index = menu->selected;
+        uint32_t highlight_layout = menu->layoutVersion();
 
         auto scrollScreen = 0;
-        int highlight_screen_y_on_entry = round(currentY) + scrollScreen;
+        int highlight_screen_y_on_entry = highlight_y.rounded() + scrollScreen;
         if (highlight_screen_y_on_entry > SCREEN_HEIGHT - DEFAULT_TEXT_HEIGHT) {
             scrollScreen -= (highlight_screen_y_on_entry - (SCREEN_HEIGHT - DEFAULT_TEXT_HEIGHT));
         } else if (highlight_screen_y_on_entry < 0) {
             scrollScreen -= highlight_screen_y_on_entry;
         }
 
+        // True while the frame on screen does not reflect the menu state. Once the
+        // menu is settled, nothing is rendered until input or invalidate() changes it.
+        bool dirty = true;
+
+        menu_accelerator.setCurve(menu->getAcceleration());
+        frame_scheduler.reset();
         while (true) {
-            RotaryDirection dir;
-            while ((dir = g_encoder.getDirection()) != RotaryDirection::NOROTATION) {
-                if (dir == RotaryDirection::CLOCKWISE) {
-                    if (menu->selected < menu->size() - 1) menu->selected++;
-                } else if (dir == RotaryDirection::COUNTERCLOCKWISE) {
-                    if (menu->selected > 0) menu->selected--;
-                }
+            AnimValue dt = beginFrame();
+            if (navigation_depth > 0) {
+                return MENU_NAVIGATE;
             }
-
-            if (g_encoder.isPressed()) {
-                MenuItem& item = menu->getItem(menu->selected);
-
-                // For items that don't navigate away, handle them here and continue the loop
-                // to prevent exiting and re-entering the menu, which causes a UI jitter.
-                if (item.type == MenuItem::ItemType::SWITCH) {
-                    if (item.switch_action) {
-                        item.switch_action();
-                    }
-                    continue;
+            int result = MENU_STAY;
+            drainInput([&](const InputEvent& event) {
+                switch (event.type) {
+                case InputEventType::DETENT_CW:
+                case InputEventType::DETENT_CCW: {
+                    int target = menu->selected + menu_accelerator.steps(event);
+                    if (target > menu->size() - 1) target = menu->size() - 1;
+                    if (target < 0) target = 0;
+                    menu->selected = target;
+                    dirty = true;
+                    return false;
                 }
-
-                if (item.type == MenuItem::ItemType::OPTION) {
-                    if (item.action) {
-                        Page* page = item.action();
-                        if (page) {
-                            // If a page is created, set it as pending and return to the handler.
-                            pending_page = page;
-                            return menu->selected;
-                        } else {
-                            // No page was created, so stay in the menu loop.
-                            continue;
-                        }
-                    } else {
-                        // No action defined, stay in the menu loop.
-                        continue;
-                    }
+                case InputEventType::PRESS:
+                    result = activateItem(menu);
+                    dirty = true;
+                    return result != MENU_STAY;
+                case InputEventType::CANCEL:
+                    result = -1;
+                    return true;
+                default:
+                    return false;
                 }
-                
-                // For DIRECTORY items, we need to exit to the main handler to change the menu.
-                return menu->selected;
+            });
+            profiler.mark(FramePhase::HANDLE_INPUT);
+            if (result != MENU_STAY) {
+                return result;
             }
 
-            if (is_button_pressed(PIN_CANCEL)) {
-                return -1;
+            // Aim the highlight again only when the selection moved or a label may have changed.
+            if (menu->selected != highlight_index || menu->layoutVersion() != highlight_layout || redraw_requested) {
+                highlight_index = menu->selected;
+                highlight_layout = menu->layoutVersion();
+                highlight_y.animateTo(menu->selected * DEFAULT_TEXT_HEIGHT);
+                highlight_w.animateTo(selectedLabelWidth(menu));
             }
-
-            double scrollTargetY = menu->selected * DEFAULT_TEXT_HEIGHT;
-            if (abs(scrollTargetY - currentY) > 0.1 || abs(velocityY) > 0.1) {
-                velocityY = scroll_pid.update(scrollTargetY, currentY);
-                currentY += velocityY;
-            } else {
-                currentY = scrollTargetY;
+            if (g_animator.advance(dt)) {
+                dirty = true;
             }
+            profiler.mark(FramePhase::ANIMATE);
 
-            double targetWidth = OLED.getStrWidth(menu->getItem(menu->selected).label.c_str());
-            if (abs(targetWidth - currentWidth) > 0.1 || abs(velocityW) > 0.1) {
-                velocityW = width_pid.update(targetWidth, currentWidth);
-                currentWidth += velocityW;
-            } else {
-                currentWidth = targetWidth;
+            if (!dirty && !redraw_requested) {
+                // Settled: skip rendering and the bus transfer, and sleep until something changes.
+                endIdleFrame();
+                continue;
             }
+            dirty = false;
+            redraw_requested = false;
+
+            int currentY = highlight_y.rounded();
+            int currentWidth = highlight_w.rounded();
 
-            int highlight_screen_y = round(currentY) + scrollScreen;
+            int highlight_screen_y = currentY + scrollScreen;
             if (highlight_screen_y > SCREEN_HEIGHT - DEFAULT_TEXT_HEIGHT) {
                 scrollScreen -= (highlight_screen_y - (SCREEN_HEIGHT - DEFAULT_TEXT_HEIGHT));
             } else if (highlight_screen_y < 0) {
@@ -434,44 +845,22 @@ private:
             OLED.clearBuffer();
             OLED.setDrawColor(1);
 
-            for (int i = 0; i < menu->size(); i++) {
-                OLED.setCursor(INIT_CURSOR_X + DEFAULT_TEXT_MARGIN, 
-                            i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + scrollScreen);
-                OLED.print(menu->getItem(i).label);
-                if (menu->getItem(i).type == MenuItem::ItemType::SWITCH) {
-                    String state = menu->getItem(i).get_switch_state() ? "[ON]" : "[OFF]";
-                    int state_width = OLED.getStrWidth(state.c_str());
-                    OLED.setCursor(SCREEN_WIDTH - state_width - DEFAULT_TEXT_MARGIN, 
-                                i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + scrollScreen);
-                    OLED.print(state);
-                }
-            }
+            drawMenuItems(menu, 0, scrollScreen);
             
-            int selected_box_y = round(currentY) + scrollScreen;
+            int selected_box_y = currentY + scrollScreen;
 
             OLED.drawRBox(INIT_CURSOR_X, selected_box_y, 
-                        round(currentWidth) + 2 * DEFAULT_TEXT_MARGIN, DEFAULT_TEXT_HEIGHT, 2);
+                        currentWidth + 2 * DEFAULT_TEXT_MARGIN, DEFAULT_TEXT_HEIGHT, 2);
             
             OLED.setDrawColor(0);
             OLED.setClipWindow(INIT_CURSOR_X, selected_box_y, 
-                            INIT_CURSOR_X + round(currentWidth) + 2 * DEFAULT_TEXT_MARGIN, selected_box_y + DEFAULT_TEXT_HEIGHT);
-
-            for (int i = 0; i < menu->size(); i++) {
-                OLED.setCursor(INIT_CURSOR_X + DEFAULT_TEXT_MARGIN, 
-                            i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + scrollScreen);
-                OLED.print(menu->getItem(i).label);
-                if (menu->getItem(i).type == MenuItem::ItemType::SWITCH) {
-                    String state = menu->getItem(i).get_switch_state() ? "[ON]" : "[OFF]";
-                    int state_width = OLED.getStrWidth(state.c_str());
-                    OLED.setCursor(SCREEN_WIDTH - state_width - DEFAULT_TEXT_MARGIN, 
-                                i * DEFAULT_TEXT_HEIGHT + DEFAULT_TEXT_HEIGHT - DEFAULT_TEXT_MARGIN + scrollScreen);
-                    OLED.print(state);
-                }
-            }
+                            INIT_CURSOR_X + currentWidth + 2 * DEFAULT_TEXT_MARGIN, selected_box_y + DEFAULT_TEXT_HEIGHT);
+
+            drawMenuItems(menu, 0, scrollScreen, selected_box_y, selected_box_y + DEFAULT_TEXT_HEIGHT);
 
             OLED.setMaxClipWindow();
-            OLED.sendBuffer();
-            delay(ANIMATION_DELAY);
+            present();
+            endFrame();
         }
     }
 };
@@ -0,0 +1,160 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of AccelerationCurve and DetentAccelerator with synthetic detent streams.
+ *
+ * Run with `pio test -e native_test -f test_accelerator`. Each stream is a run of
+ * detents a fixed number of milliseconds apart, stamped like the encoder stamps them,
+ * and the steps the accelerator returns for each detent are checked.
+ */
+#include <unity.h>
+#include "config.hpp"
+#include "input.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The curve under test: one step at 80 ms between detents, 25 at 12 ms and faster.
+static constexpr AccelerationCurve CURVE = {80, 12, 25};
+
+/// The time of the next detent fed by spin().
+static uint32_t now_ms;
+
+/**
+ * @brief Feeds detents a fixed interval apart and records the steps of each.
+ * @param accelerator The accelerator to feed.
+ * @param type DETENT_CW or DETENT_CCW.
+ * @param interval_ms The time between detents.
+ * @param count The number of detents.
+ * @param steps Receives the steps of each detent.
+ */
+static void spin(DetentAccelerator& accelerator, InputEventType type, uint32_t interval_ms, int count, int* steps) {
+    for (int i = 0; i < count; i++) {
+        now_ms += interval_ms;
+        steps[i] = accelerator.steps({type, now_ms});
+    }
+}
+
+void setUp() {
+    now_ms = 10000;
+}
+void tearDown() {}
+
+void test_curve_limits_and_shape() {
+    TEST_ASSERT_EQUAL_INT(1, CURVE.stepsAt(80));
+    TEST_ASSERT_EQUAL_INT(1, CURVE.stepsAt(1000));
+    TEST_ASSERT_EQUAL_INT(25, CURVE.stepsAt(12));
+    TEST_ASSERT_EQUAL_INT(25, CURVE.stepsAt(0));
+    int previous = CURVE.stepsAt(80);
+    for (uint32_t interval = 79; interval >= 12; interval--) {
+        int steps = CURVE.stepsAt(interval);
+        TEST_ASSERT_GREATER_OR_EQUAL(previous, steps);
+        previous = steps;
+    }
+    // Quadratic: halfway between the two speeds is a quarter of the extra steps.
+    TEST_ASSERT_EQUAL_INT(1 + 6, CURVE.stepsAt(46));
+}
+
+void test_slow_turns_are_one_step_each() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[20];
+    spin(accelerator, InputEventType::DETENT_CW, 120, 20, steps);
+    for (int value : steps) TEST_ASSERT_EQUAL_INT(1, value);
+    spin(accelerator, InputEventType::DETENT_CCW, 80, 20, steps);
+    for (int value : steps) TEST_ASSERT_EQUAL_INT(-1, value);
+}
+
+void test_fast_spin_ramps_up_to_the_maximum() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[10];
+    spin(accelerator, InputEventType::DETENT_CW, 5, 10, steps);
+    // The first detent of a spin has no speed yet.
+    TEST_ASSERT_EQUAL_INT(1, steps[0]);
+    for (int i = 1; i < 10; i++) TEST_ASSERT_GREATER_OR_EQUAL(steps[i - 1], steps[i]);
+    TEST_ASSERT_GREATER_THAN(1, steps[1]);
+    TEST_ASSERT_EQUAL_INT(25, steps[9]);
+}
+
+void test_fast_counter_clockwise_spin_is_negative() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[10];
+    spin(accelerator, InputEventType::DETENT_CCW, 5, 10, steps);
+    TEST_ASSERT_EQUAL_INT(-1, steps[0]);
+    TEST_ASSERT_EQUAL_INT(-25, steps[9]);
+}
+
+void test_single_short_gap_does_not_jump() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[6];
+    spin(accelerator, InputEventType::DETENT_CW, 70, 5, steps);
+    spin(accelerator, InputEventType::DETENT_CW, 10, 1, steps + 5);
+    // The average moves only halfway towards the short gap.
+    TEST_ASSERT_LESS_THAN(25, steps[5]);
+    TEST_ASSERT_GREATER_THAN(1, steps[5]);
+}
+
+void test_direction_reversal_starts_over() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[10];
+    spin(accelerator, InputEventType::DETENT_CW, 5, 10, steps);
+    TEST_ASSERT_EQUAL_INT(25, steps[9]);
+    spin(accelerator, InputEventType::DETENT_CCW, 5, 2, steps);
+    TEST_ASSERT_EQUAL_INT(-1, steps[0]);
+    TEST_ASSERT_LESS_THAN(-1, steps[1]);
+    TEST_ASSERT_GREATER_THAN(-25, steps[1]);
+}
+
+void test_pause_resets_the_spin() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[10];
+    spin(accelerator, InputEventType::DETENT_CW, 5, 10, steps);
+    TEST_ASSERT_EQUAL_INT(25, steps[9]);
+    spin(accelerator, InputEventType::DETENT_CW, 80, 1, steps);
+    TEST_ASSERT_EQUAL_INT(1, steps[0]);
+    spin(accelerator, InputEventType::DETENT_CW, 500, 1, steps);
+    TEST_ASSERT_EQUAL_INT(1, steps[0]);
+    // Spinning fast again ramps up from the start.
+    spin(accelerator, InputEventType::DETENT_CW, 5, 2, steps);
+    TEST_ASSERT_LESS_THAN(25, steps[1]);
+}
+
+void test_same_timestamp_batch_is_one_step_each() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[8];
+    spin(accelerator, InputEventType::DETENT_CW, 0, 8, steps);
+    for (int value : steps) TEST_ASSERT_EQUAL_INT(1, value);
+}
+
+void test_other_events_and_no_curve() {
+    DetentAccelerator accelerator(&CURVE);
+    TEST_ASSERT_EQUAL_INT(0, accelerator.steps({InputEventType::PRESS, 100}));
+    TEST_ASSERT_EQUAL_INT(0, accelerator.steps({InputEventType::CANCEL, 101}));
+
+    DetentAccelerator linear;
+    int steps[10];
+    spin(linear, InputEventType::DETENT_CW, 1, 10, steps);
+    for (int value : steps) TEST_ASSERT_EQUAL_INT(1, value);
+}
+
+void test_set_curve_forgets_the_spin() {
+    DetentAccelerator accelerator(&CURVE);
+    int steps[10];
+    spin(accelerator, InputEventType::DETENT_CW, 5, 10, steps);
+    accelerator.setCurve(&MENU_ACCELERATION);
+    spin(accelerator, InputEventType::DETENT_CW, 5, 10, steps);
+    TEST_ASSERT_EQUAL_INT(1, steps[0]);
+    TEST_ASSERT_EQUAL_INT(MENU_ACCEL_MAX_STEPS, steps[9]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_curve_limits_and_shape);
+    RUN_TEST(test_slow_turns_are_one_step_each);
+    RUN_TEST(test_fast_spin_ramps_up_to_the_maximum);
+    RUN_TEST(test_fast_counter_clockwise_spin_is_negative);
+    RUN_TEST(test_single_short_gap_does_not_jump);
+    RUN_TEST(test_direction_reversal_starts_over);
+    RUN_TEST(test_pause_resets_the_spin);
+    RUN_TEST(test_same_timestamp_batch_is_one_step_each);
+    RUN_TEST(test_other_events_and_no_curve);
+    RUN_TEST(test_set_curve_forgets_the_spin);
+    return UNITY_END();
+}
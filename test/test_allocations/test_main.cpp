@@ -0,0 +1,130 @@
+/**
+ * @file test_main.cpp
+ * @brief Checks on the simulator that menu navigation allocates nothing once warmed up.
+ *
+ * Run with `pio test -e native_test -f test_allocations`. The script below drives the
+ * real RingController through scrolling, a fast spin through a long CallbackMenu,
+ * switch toggles and the transitions into and out of submenus. The first round of it
+ * may allocate, e.g. to size the menu layouts; the same round repeated afterwards is a
+ * benchmark phase, and the allocation counter of the benchmark report must stay at 0.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include "config.hpp"
+#include "input.hpp"
+#include "menu.hpp"
+#include "static_menu.hpp"
+#include "ui.hpp"
+#include "simulator.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+RingController<DisplayDriver> controller(OLED);
+
+/// The script commands of one round of navigation, starting and ending on the first root item.
+static const char* const NAVIGATION_ROUND[] = {
+    "cw", "ccw", "wait 300",
+    "click", "wait 600",              // into List
+    "cw 40 12", "ccw 20", "wait 600", // fast spin and back
+    "cancel", "wait 600",
+    "cw", "click", "wait 600",        // into Switches
+    "click", "cw", "click", "wait 300",
+    "cancel", "wait 600",
+    "ccw", "wait 600",
+};
+
+/// The number of rounds measured after the warm-up round.
+static constexpr int MEASURED_ROUNDS = 3;
+
+static bool switch_a = false;
+static bool switch_b = true;
+static void toggleA() { switch_a = !switch_a; }
+static bool stateA() { return switch_a; }
+static void toggleB() { switch_b = !switch_b; }
+static bool stateB() { return switch_b; }
+
+static MenuItem listItem(int index, char* label, size_t capacity) {
+    snprintf(label, capacity, "Item %d", index + 1);
+    return MenuItem(label, Delegate<Page*()>());
+}
+
+static CallbackMenu list100([] { return 100; }, listItem);
+
+constexpr StaticMenuItem switchItems[] = {
+    StaticMenuItem::toggle("Switch A", toggleA, stateA),
+    StaticMenuItem::toggle("Switch B", toggleB, stateB),
+};
+extern StaticMenu rootMenu;
+constexpr StaticMenuTable switchTable = StaticMenuTable::of("Switches", switchItems, &rootMenu);
+StaticMenu switchMenu(switchTable);
+
+constexpr StaticMenuItem rootItems[] = {
+    StaticMenuItem::directory("List", &list100),
+    StaticMenuItem::directory("Switches", &switchMenu),
+    StaticMenuItem::option("Placeholder"),
+};
+constexpr StaticMenuTable rootTable = StaticMenuTable::of("Test", rootItems);
+StaticMenu rootMenu(rootTable);
+
+void setUp() {}
+void tearDown() {}
+
+void test_warm_up_draws_frames() {
+    const Simulator::Phase* warm_up = g_simulator.findPhase("warm_up");
+    TEST_ASSERT_NOT_NULL(warm_up);
+    TEST_ASSERT_GREATER_THAN(0, warm_up->frames);
+}
+
+void test_menu_navigation_does_not_allocate() {
+    const Simulator::Phase* steady = g_simulator.findPhase("steady");
+    TEST_ASSERT_NOT_NULL(steady);
+    TEST_ASSERT_GREATER_THAN(MEASURED_ROUNDS * 20, steady->frames);
+    TEST_ASSERT_EQUAL_UINT64(0, steady->allocations);
+}
+
+void test_static_menus_build_their_own_items() {
+    // An item built by one menu stays valid while another menu builds one.
+    const MenuItem& root_item = rootMenu.getItem(1);
+    const MenuItem& switch_item = switchMenu.getItem(0);
+    TEST_ASSERT_TRUE(&root_item != &switch_item);
+    TEST_ASSERT_TRUE(root_item.label == StringView("Switches"));
+    TEST_ASSERT_TRUE(root_item.subMenu == &switchMenu);
+    TEST_ASSERT_TRUE(switch_item.label == StringView("Switch A"));
+    TEST_ASSERT_TRUE(switch_item.type == MenuItem::ItemType::SWITCH);
+    TEST_ASSERT_TRUE(switchMenu.getParent() == &rootMenu);
+}
+
+/// Runs the tests once the simulator has played the script.
+static int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_warm_up_draws_frames);
+    RUN_TEST(test_menu_navigation_does_not_allocate);
+    RUN_TEST(test_static_menus_build_their_own_items);
+    return UNITY_END();
+}
+
+int main() {
+    list100.setParent(&rootMenu);
+
+    g_simulator.schedule("mark warm_up");
+    for (const char* line : NAVIGATION_ROUND) {
+        g_simulator.schedule(line);
+    }
+    g_simulator.schedule("mark steady");
+    for (int round = 0; round < MEASURED_ROUNDS; round++) {
+        for (const char* line : NAVIGATION_ROUND) {
+            g_simulator.schedule(line);
+        }
+    }
+    g_simulator.schedule("mark");
+    g_simulator.schedule("quit");
+
+    g_simulator.setFinishHandler(runTests);
+    g_simulator.attachDisplay(OLED, nullptr);
+    g_encoder.begin();
+    g_cancel_button.begin();
+    controller.setup();
+
+    // Does not return: the simulator runs the tests and ends the process once the
+    // script is done.
+    controller.handle(&rootMenu);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file test_main.cpp
+ * @brief Checks that the PID animation lands on the same pixels in float, double and Q16.16.
+ *
+ * Run with `pio test -e native_test -f test_animation_math`. Each case animates a move
+ * with BasicPIDController in all three number types, frame by frame as the UI does, and
+ * requires the rounded float and Q16.16 positions to stay within one pixel of double.
+ */
+#include <unity.h>
+#include <stdlib.h>
+#include "config.hpp"
+#include "fixed.hpp"
+#include "pid.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The frames each move is animated for.
+static constexpr int FRAMES = 240;
+
+/// PID gains, as in the configuration.
+struct Gains {
+    float kp;
+    float ki;
+    float kd;
+};
+
+/// The largest pixel difference to double seen by the last animate().
+static int max_float_error;
+static int max_fixed_error;
+
+/// Animates from start to target with each number type and records the pixel errors.
+template <typename T>
+static void animateWith(const Gains& gains, uint32_t frame_us, int start, int target, int* positions) {
+    BasicPIDController<T> pid(T(gains.kp), T(gains.ki), T(gains.kd));
+    const T dt = fromRatio<T>(frame_us, (uint32_t)(ANIMATION_REFERENCE_MS * 1000));
+    T value = T(start);
+    for (int i = 0; i < FRAMES; i++) {
+        value += pid.update(T(target), value, dt) * dt;
+        positions[i] = roundToInt(value);
+    }
+}
+
+static void animate(const Gains& gains, uint32_t frame_us, int start, int target) {
+    int reference[FRAMES], positions[FRAMES];
+    animateWith<double>(gains, frame_us, start, target, reference);
+
+    max_float_error = 0;
+    animateWith<float>(gains, frame_us, start, target, positions);
+    for (int i = 0; i < FRAMES; i++) {
+        int error = abs(positions[i] - reference[i]);
+        if (error > max_float_error) max_float_error = error;
+    }
+
+    max_fixed_error = 0;
+    animateWith<Fixed16>(gains, frame_us, start, target, positions);
+    for (int i = 0; i < FRAMES; i++) {
+        int error = abs(positions[i] - reference[i]);
+        if (error > max_fixed_error) max_fixed_error = error;
+    }
+    // Every move must actually arrive.
+    TEST_ASSERT_INT_WITHIN(1, target, reference[FRAMES - 1]);
+    TEST_ASSERT_INT_WITHIN(1, target, positions[FRAMES - 1]);
+}
+
+static void checkMoves(const Gains& gains) {
+    static const uint32_t frame_times_us[] = {8333, 16667, 33333};
+    static const int moves[][2] = {{0, 96}, {96, 0}, {0, 12}, {-64, 127}, {0, -300}};
+    for (uint32_t frame_us : frame_times_us) {
+        for (const auto& move : moves) {
+            animate(gains, frame_us, move[0], move[1]);
+            TEST_ASSERT_LESS_OR_EQUAL(1, max_float_error);
+            TEST_ASSERT_LESS_OR_EQUAL(1, max_fixed_error);
+        }
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_from_ratio_matches_float() {
+    TEST_ASSERT_EQUAL_INT32(Fixed16(1).raw(), fromRatio<Fixed16>(10000, 10000).raw());
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / 65536, 1.6f, fromRatio<Fixed16>(16000, 10000).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / 65536, 0.1f, fromRatio<Fixed16>(1, 10).toFloat());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.6f, fromRatio<float>(16000, 10000));
+}
+
+void test_scroll_gains_stay_within_a_pixel() {
+    checkMoves({0.2f, 0.0f, 0.1f});
+}
+
+void test_transition_gains_stay_within_a_pixel() {
+    checkMoves({0.25f, 0.0f, 0.0f});
+}
+
+void test_integral_gain_stays_within_a_pixel() {
+    checkMoves({0.15f, 0.02f, 0.05f});
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_from_ratio_matches_float);
+    RUN_TEST(test_scroll_gains_stay_within_a_pixel);
+    RUN_TEST(test_transition_gains_stay_within_a_pixel);
+    RUN_TEST(test_integral_gain_stays_within_a_pixel);
+    return UNITY_END();
+}
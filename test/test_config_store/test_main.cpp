@@ -0,0 +1,198 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of ConfigStore's write coalescing, with a backend that counts flash writes.
+ *
+ * Run with `pio test -e native_test -f test_config_store`. Time is the simulator's
+ * virtual clock, advanced with delay(), so millis() moves exactly as the test says.
+ */
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "config.hpp"
+#include "config_store.hpp"
+#include "simulator.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The time between two simulated frames.
+static constexpr uint32_t FRAME_MS = 10;
+
+/**
+ * @class CountingBackend
+ * @brief Keeps the record in memory, counts the writes and can be told to fail them.
+ */
+class CountingBackend : public ConfigBackend {
+public:
+    size_t read(uint8_t* data, size_t capacity) override {
+        if (record.empty() || record.size() > capacity) return 0;
+        memcpy(data, record.data(), record.size());
+        return record.size();
+    }
+
+    bool write(const uint8_t* data, size_t length) override {
+        attempts++;
+        if (fail) return false;
+        record.assign(data, data + length);
+        writes++;
+        return true;
+    }
+
+    std::vector<uint8_t> record; ///< The stored record, empty if none.
+    int attempts = 0;            ///< The calls to write().
+    int writes = 0;              ///< The writes that succeeded.
+    bool fail = false;           ///< Makes write() fail.
+};
+
+/// The defaults g_config starts with.
+static AppConfig defaults;
+
+/// Runs frames of the UI loop for a while, polling the store like beginFrame() does.
+static void runFrames(ConfigStore& store, uint32_t ms) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += FRAME_MS) {
+        store.poll();
+        delay(FRAME_MS);
+    }
+}
+
+void setUp() {
+    g_config = defaults;
+}
+void tearDown() {}
+
+void test_burst_of_edits_is_one_write() {
+    CountingBackend backend;
+    ConfigStore store;
+    TEST_ASSERT_FALSE(store.begin(backend));
+
+    // A hundred encoder steps, one per frame, all within the commit delay of each other.
+    for (int i = 0; i < 100; i++) {
+        g_config.scroll_pid_kd += 0.001f;
+        runFrames(store, FRAME_MS);
+    }
+    TEST_ASSERT_EQUAL_INT(0, backend.attempts);
+
+    runFrames(store, CONFIG_COMMIT_DELAY_MS - 2 * FRAME_MS);
+    TEST_ASSERT_EQUAL_INT(0, backend.attempts);
+    runFrames(store, 4 * FRAME_MS);
+    TEST_ASSERT_EQUAL_INT(1, backend.writes);
+    TEST_ASSERT_EQUAL_UINT32(1, store.commits());
+
+    // Nothing changed since, so nothing more is written.
+    runFrames(store, 3 * CONFIG_COMMIT_DELAY_MS);
+    TEST_ASSERT_EQUAL_INT(1, backend.attempts);
+}
+
+void test_flush_writes_at_once() {
+    CountingBackend backend;
+    ConfigStore store;
+    store.begin(backend);
+    store.flush();
+    TEST_ASSERT_EQUAL_INT(0, backend.attempts);
+
+    g_config.use_serial_control = !g_config.use_serial_control;
+    runFrames(store, FRAME_MS);
+    store.flush();
+    TEST_ASSERT_EQUAL_INT(1, backend.writes);
+
+    // The change is stored, so the delayed commit has nothing left to write.
+    runFrames(store, 2 * CONFIG_COMMIT_DELAY_MS);
+    TEST_ASSERT_EQUAL_INT(1, backend.attempts);
+}
+
+void test_failed_write_is_retried() {
+    CountingBackend backend;
+    ConfigStore store;
+    store.begin(backend);
+    backend.fail = true;
+
+    g_config.anim_pid_kp = 0.5f;
+    runFrames(store, CONFIG_COMMIT_DELAY_MS + 2 * FRAME_MS);
+    TEST_ASSERT_EQUAL_INT(1, backend.attempts);
+    TEST_ASSERT_EQUAL_INT(0, backend.writes);
+    TEST_ASSERT_EQUAL_UINT32(0, store.commits());
+
+    // The retry waits another commit delay instead of writing on every frame.
+    runFrames(store, CONFIG_COMMIT_DELAY_MS / 2);
+    TEST_ASSERT_EQUAL_INT(1, backend.attempts);
+
+    backend.fail = false;
+    runFrames(store, CONFIG_COMMIT_DELAY_MS);
+    TEST_ASSERT_EQUAL_INT(2, backend.attempts);
+    TEST_ASSERT_EQUAL_INT(1, backend.writes);
+    TEST_ASSERT_EQUAL_UINT32(1, store.commits());
+}
+
+void test_record_is_loaded_at_begin() {
+    CountingBackend backend;
+    ConfigStore store;
+    store.begin(backend);
+    g_config.scroll_pid_kp = 0.75f;
+    g_config.show_profiler_hud = true;
+    store.flush();
+
+    g_config = defaults;
+    ConfigStore reloaded;
+    TEST_ASSERT_TRUE(reloaded.begin(backend));
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.75f, g_config.scroll_pid_kp);
+    TEST_ASSERT_TRUE(g_config.show_profiler_hud);
+    // Loading is not a change.
+    runFrames(reloaded, 2 * CONFIG_COMMIT_DELAY_MS);
+    TEST_ASSERT_EQUAL_INT(1, backend.attempts);
+}
+
+void test_other_version_is_ignored() {
+    CountingBackend backend;
+    ConfigStore store;
+    store.begin(backend);
+    g_config.scroll_pid_kp = 0.75f;
+    store.flush();
+    backend.record[0] = CONFIG_VERSION + 1;
+
+    g_config = defaults;
+    ConfigStore reloaded;
+    TEST_ASSERT_FALSE(reloaded.begin(backend));
+    TEST_ASSERT_EQUAL_MEMORY(&defaults, &g_config, sizeof(AppConfig));
+}
+
+void test_time_until_commit() {
+    ConfigStore store;
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, store.msUntilCommit());
+    CountingBackend backend;
+    store.begin(backend);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, store.msUntilCommit());
+
+    // An edit poll() has not seen yet is due at once, then the commit delay counts down.
+    g_config.anim_pid_kd = 0.25f;
+    TEST_ASSERT_EQUAL_UINT32(0, store.msUntilCommit());
+    runFrames(store, FRAME_MS);
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_COMMIT_DELAY_MS - FRAME_MS, store.msUntilCommit());
+    delay(CONFIG_COMMIT_DELAY_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, store.msUntilCommit());
+    store.poll();
+    TEST_ASSERT_EQUAL_INT(1, backend.writes);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, store.msUntilCommit());
+
+    // A failed write is retried after another commit delay.
+    backend.fail = true;
+    g_config.anim_pid_kd = 0.5f;
+    runFrames(store, FRAME_MS);
+    delay(CONFIG_COMMIT_DELAY_MS);
+    store.poll();
+    TEST_ASSERT_EQUAL_INT(2, backend.attempts);
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_COMMIT_DELAY_MS, store.msUntilCommit());
+}
+
+int main() {
+    defaults = g_config;
+    // Keeps the simulator running: it ends the process once its script is done.
+    g_simulator.schedule("wait 3600000");
+
+    UNITY_BEGIN();
+    RUN_TEST(test_burst_of_edits_is_one_write);
+    RUN_TEST(test_flush_writes_at_once);
+    RUN_TEST(test_failed_write_is_retried);
+    RUN_TEST(test_record_is_loaded_at_begin);
+    RUN_TEST(test_other_version_is_ignored);
+    RUN_TEST(test_time_until_commit);
+    return UNITY_END();
+}
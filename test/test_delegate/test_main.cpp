@@ -0,0 +1,101 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of Delegate: every kind of callable is called, and no copy allocates.
+ *
+ * Run with `pio test -e native_test -f test_delegate`. Allocations are read from the
+ * simulator's counter of calls to the global operator new.
+ */
+#include <unity.h>
+#include "config.hpp"
+#include "delegate.hpp"
+#include "menu.hpp"
+#include "simulator.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The number of copies each allocation check makes.
+static constexpr int COPIES = 1000;
+
+static int doubled(int value) { return value * 2; }
+
+static int addContext(void* context, int value) { return *static_cast<int*>(context) + value; }
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty_delegate_is_false() {
+    Delegate<int(int)> empty;
+    Delegate<int(int)> from_null(nullptr);
+    Delegate<int(int)> from_null_function(static_cast<int (*)(int)>(nullptr));
+    TEST_ASSERT_FALSE(empty);
+    TEST_ASSERT_FALSE(from_null);
+    TEST_ASSERT_FALSE(from_null_function);
+}
+
+void test_function_pointer_is_called() {
+    Delegate<int(int)> delegate(doubled);
+    TEST_ASSERT_TRUE(delegate);
+    TEST_ASSERT_EQUAL_INT(42, delegate(21));
+}
+
+void test_context_function_gets_its_context() {
+    int base = 100;
+    Delegate<int(int)> delegate(addContext, &base);
+    TEST_ASSERT_EQUAL_INT(105, delegate(5));
+    base = 200;
+    TEST_ASSERT_EQUAL_INT(205, delegate(5));
+}
+
+void test_capturing_lambda_is_called() {
+    int calls = 0;
+    int offset = 7;
+    Delegate<int(int)> delegate([&calls, offset](int value) {
+        calls++;
+        return value + offset;
+    });
+    TEST_ASSERT_EQUAL_INT(10, delegate(3));
+    TEST_ASSERT_EQUAL_INT(1, calls);
+}
+
+void test_copies_do_not_allocate() {
+    int calls = 0;
+    int offset = 1;
+    Delegate<int(int)> lambda([&calls, offset](int value) {
+        calls++;
+        return value + offset;
+    });
+    Delegate<int(int)> bound(addContext, &offset);
+
+    uint64_t allocations = Simulator::allocationCount();
+    int sum = 0;
+    for (int i = 0; i < COPIES; i++) {
+        Delegate<int(int)> copy(lambda);
+        Delegate<int(int)> assigned;
+        assigned = bound;
+        sum += copy(i) + assigned(i);
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, Simulator::allocationCount() - allocations);
+    TEST_ASSERT_EQUAL_INT(COPIES, calls);
+    TEST_ASSERT_EQUAL_INT(COPIES * (COPIES - 1) + 2 * COPIES, sum);
+}
+
+void test_menu_item_copies_do_not_allocate() {
+    MenuItem item("Item", Delegate<Page*()>());
+    uint64_t allocations = Simulator::allocationCount();
+    for (int i = 0; i < COPIES; i++) {
+        MenuItem copy(item);
+        TEST_ASSERT_FALSE(copy.action);
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, Simulator::allocationCount() - allocations);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_delegate_is_false);
+    RUN_TEST(test_function_pointer_is_called);
+    RUN_TEST(test_context_function_gets_its_context);
+    RUN_TEST(test_capturing_lambda_is_called);
+    RUN_TEST(test_copies_do_not_allocate);
+    RUN_TEST(test_menu_item_copies_do_not_allocate);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of DoubleBuffer and FramePipeline with transports that finish late.
+ *
+ * Run with `pio test -e native_test -f test_double_buffer`. FakeAsyncTransport only reads
+ * a frame when it is fenced, like a DMA transfer that is still streaming the buffer out,
+ * so any drawing into the frame in flight would show up on its panel. The FramePipeline
+ * case holds its render task inside the transfer while the next frame is composed.
+ */
+#include <unity.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "config.hpp"
+#include "double_buffer.hpp"
+#include "frame_pipeline.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The bytes of a 128x32 frame.
+static constexpr size_t FRAME_BYTES = 128 * 32 / 8;
+/// The transfer time the fake transport reports.
+static constexpr uint32_t FAKE_TRANSFER_US = 4000;
+
+/**
+ * @class FakeAsyncTransport
+ * @brief An asynchronous transport that reads the frame only in wait().
+ */
+class FakeAsyncTransport : public FrameTransport {
+public:
+    void start(const uint8_t* frame) override {
+        if (in_flight) unfenced_starts++;
+        in_flight = frame;
+        starts++;
+    }
+
+    void wait() override {
+        if (!in_flight) return;
+        memcpy(panel, in_flight, FRAME_BYTES);
+        in_flight = nullptr;
+        last_transfer_us = FAKE_TRANSFER_US;
+        last_transfer_bytes = FRAME_BYTES;
+    }
+
+    bool isAsync() const override { return true; }
+
+    const uint8_t* in_flight = nullptr; ///< The frame being sent, or nullptr.
+    uint8_t panel[FRAME_BYTES] = {};    ///< What the display shows.
+    int starts = 0;                     ///< The number of start() calls.
+    int unfenced_starts = 0;            ///< start() calls while a frame was in flight.
+};
+
+/// Composes a frame: fills the driver's buffer with a pattern, as drawing would.
+static void compose(uint8_t pattern) {
+    memset(OLED.getBufferPtr(), pattern, FRAME_BYTES);
+}
+
+/// The buffer the driver allocated. A DoubleBuffer may leave the driver pointing at its
+/// second buffer, so every test starts from this one again.
+static uint8_t* driver_buffer;
+
+void setUp() {
+    OLED.getU8g2()->tile_buf_ptr = driver_buffer;
+}
+void tearDown() {}
+
+void test_composition_overlaps_the_transfer() {
+    FakeAsyncTransport transport;
+    DoubleBuffer<DisplayDriver> buffers(OLED);
+    buffers.begin(&transport);
+
+    compose(0xAA);
+    const uint8_t* first = OLED.getBufferPtr();
+    buffers.present();
+    TEST_ASSERT_TRUE(transport.in_flight == first);
+
+    // Drawing continues in the other buffer while the first frame is still in flight.
+    TEST_ASSERT_TRUE(OLED.getBufferPtr() != first);
+    compose(0x55);
+    buffers.present();
+    TEST_ASSERT_EQUAL_INT(0xAA, transport.panel[0]);
+    TEST_ASSERT_EQUAL_INT(0xAA, transport.panel[FRAME_BYTES - 1]);
+
+    // Back in the first buffer, which the transport is done with.
+    TEST_ASSERT_TRUE(OLED.getBufferPtr() == first);
+    compose(0x0F);
+    buffers.present();
+    TEST_ASSERT_EQUAL_INT(0x55, transport.panel[0]);
+
+    transport.wait();
+    TEST_ASSERT_EQUAL_INT(0x0F, transport.panel[0]);
+    TEST_ASSERT_EQUAL_INT(3, transport.starts);
+    TEST_ASSERT_EQUAL_INT(0, transport.unfenced_starts);
+}
+
+void test_report_counts_the_recovered_time() {
+    FakeAsyncTransport transport;
+    DoubleBuffer<DisplayDriver> buffers(OLED);
+    buffers.begin(&transport);
+    buffers.resetReport();
+    for (int i = 0; i < 4; i++) {
+        compose((uint8_t)i);
+        buffers.present();
+    }
+    const FrameTimeReport& report = buffers.frameTimeReport();
+    TEST_ASSERT_EQUAL_UINT32(4, report.frames);
+    // The newest transfer is accounted for by the next present().
+    TEST_ASSERT_EQUAL_UINT64(3 * FAKE_TRANSFER_US, report.transfer_us);
+    TEST_ASSERT_EQUAL_UINT64(report.transfer_us - report.blocked_us, report.recoveredUs());
+    TEST_ASSERT_GREATER_THAN(0, report.recoveredUs());
+    TEST_ASSERT_EQUAL_UINT64(3 * FRAME_BYTES, report.bytes);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_BYTES, report.last_frame_bytes);
+}
+
+void test_sync_transport_does_not_swap() {
+    int transfers = 0;
+    SyncTransport transport([&](const uint8_t*) {
+        transfers++;
+        return FRAME_BYTES;
+    });
+    DoubleBuffer<DisplayDriver> buffers(OLED);
+    buffers.begin(&transport);
+    const uint8_t* buffer = OLED.getBufferPtr();
+    buffers.present();
+    buffers.present();
+    TEST_ASSERT_TRUE(OLED.getBufferPtr() == buffer);
+    TEST_ASSERT_EQUAL_INT(2, transfers);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_BYTES, buffers.frameTimeReport().last_frame_bytes);
+}
+
+static std::atomic<bool> transfer_released(false);
+static std::atomic<int> transfers_done(0);
+static uint8_t pipeline_panel[FRAME_BYTES];
+
+void test_pipeline_start_returns_before_the_transfer() {
+    // Never destroyed: the render task waits on it until the process ends.
+    FramePipeline& pipeline = *new FramePipeline();
+    TEST_ASSERT_TRUE(pipeline.begin([](const uint8_t* frame) {
+        while (!transfer_released.load()) std::this_thread::yield();
+        memcpy(pipeline_panel, frame, FRAME_BYTES);
+        transfers_done++;
+        return FRAME_BYTES;
+    }, -1));
+
+    static uint8_t frames[2][FRAME_BYTES];
+    memset(frames[0], 0x3C, FRAME_BYTES);
+    pipeline.start(frames[0]);
+
+    // The render task is stuck in the transfer, yet the UI side composes the next frame.
+    memset(frames[1], 0xC3, FRAME_BYTES);
+    TEST_ASSERT_EQUAL_INT(0, transfers_done.load());
+
+    transfer_released = true;
+    pipeline.wait();
+    TEST_ASSERT_EQUAL_INT(1, transfers_done.load());
+    TEST_ASSERT_EQUAL_INT(0x3C, pipeline_panel[0]);
+
+    pipeline.start(frames[1]);
+    pipeline.wait();
+    TEST_ASSERT_EQUAL_INT(2, transfers_done.load());
+    TEST_ASSERT_EQUAL_INT(0xC3, pipeline_panel[0]);
+}
+
+int main() {
+    OLED.begin();
+    driver_buffer = OLED.getBufferPtr();
+    UNITY_BEGIN();
+    RUN_TEST(test_composition_overlaps_the_transfer);
+    RUN_TEST(test_report_counts_the_recovered_time);
+    RUN_TEST(test_sync_transport_does_not_swap);
+    RUN_TEST(test_pipeline_start_returns_before_the_transfer);
+    return UNITY_END();
+}
@@ -0,0 +1,149 @@
+/**
+ * @file test_main.cpp
+ * @brief Counts the bytes pushed per frame, with FrameDiff alone and through the simulated driver.
+ *
+ * Run with `pio test -e native_test -f test_framebuffer`. The FrameDiff cases feed raw
+ * frames in U8g2 tile layout. The controller cases run the real RingController on
+ * SimDisplay, which counts every tile byte the controller transfers like the I2C bus
+ * would carry it, and compare the panel it ends up with against the drawn frame.
+ */
+#include <unity.h>
+#include <string.h>
+#include "config.hpp"
+#include "framebuffer.hpp"
+#include "input.hpp"
+#include "static_menu.hpp"
+#include "ui.hpp"
+#include "simulator.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+RingController<DisplayDriver> controller(OLED);
+
+/// The tile dimensions of the 128x32 panel.
+static constexpr uint8_t TILES_X = 16;
+static constexpr uint8_t TILES_Y = 4;
+/// The bytes of a full frame.
+static constexpr size_t FRAME_BYTES = TILES_X * TILES_Y * 8;
+
+static uint8_t frame[FRAME_BYTES];
+
+/// Sets a pixel in U8g2 tile layout: bit y % 8 of byte x of tile row y / 8.
+static void setPixel(int x, int y) {
+    frame[(y / 8) * TILES_X * 8 + x] |= (uint8_t)(1 << (y % 8));
+}
+
+constexpr StaticMenuItem rootItems[] = {
+    StaticMenuItem::option("First"),
+    StaticMenuItem::option("Second item"),
+    StaticMenuItem::option("Third"),
+};
+constexpr StaticMenuTable rootTable = StaticMenuTable::of("Test", rootItems);
+StaticMenu rootMenu(rootTable);
+
+void setUp() {
+    memset(frame, 0, sizeof(frame));
+}
+void tearDown() {}
+
+void test_first_frame_is_sent_whole() {
+    FrameDiff diff;
+    diff.begin(TILES_X, TILES_Y);
+    TEST_ASSERT_EQUAL_INT(TILES_Y, diff.update(frame));
+    TEST_ASSERT_EQUAL_size_t(FRAME_BYTES, diff.dirtyBytes());
+}
+
+void test_unchanged_frame_sends_nothing() {
+    FrameDiff diff;
+    diff.begin(TILES_X, TILES_Y);
+    diff.update(frame);
+    TEST_ASSERT_EQUAL_INT(0, diff.update(frame));
+    TEST_ASSERT_EQUAL_size_t(0, diff.dirtyBytes());
+}
+
+void test_one_pixel_sends_one_tile() {
+    FrameDiff diff;
+    diff.begin(TILES_X, TILES_Y);
+    diff.update(frame);
+    setPixel(37, 20);
+    TEST_ASSERT_EQUAL_INT(1, diff.update(frame));
+    TEST_ASSERT_EQUAL_size_t(8, diff.dirtyBytes());
+    TEST_ASSERT_EQUAL_INT(4, diff.span(0).x);
+    TEST_ASSERT_EQUAL_INT(2, diff.span(0).y);
+    TEST_ASSERT_EQUAL_INT(1, diff.span(0).width);
+}
+
+void test_span_covers_the_tiles_in_between() {
+    FrameDiff diff;
+    diff.begin(TILES_X, TILES_Y);
+    diff.update(frame);
+    setPixel(2 * 8, 3);
+    setPixel(5 * 8 + 7, 5);
+    setPixel(100, 31);
+    TEST_ASSERT_EQUAL_INT(2, diff.update(frame));
+    TEST_ASSERT_EQUAL_INT(2, diff.span(0).x);
+    TEST_ASSERT_EQUAL_INT(4, diff.span(0).width);
+    TEST_ASSERT_EQUAL_size_t((4 + 1) * 8, diff.dirtyBytes());
+}
+
+void test_invalidate_resends_the_whole_frame() {
+    FrameDiff diff;
+    diff.begin(TILES_X, TILES_Y);
+    diff.update(frame);
+    diff.invalidate();
+    diff.update(frame);
+    TEST_ASSERT_EQUAL_size_t(FRAME_BYTES, diff.dirtyBytes());
+}
+
+void test_settled_menu_sends_nothing() {
+    const Simulator::Phase* idle = g_simulator.findPhase("idle");
+    TEST_ASSERT_NOT_NULL(idle);
+    TEST_ASSERT_EQUAL_UINT64(0, idle->bytes);
+}
+
+void test_scrolling_sends_partial_frames() {
+    const Simulator::Phase* scroll = g_simulator.findPhase("scroll");
+    TEST_ASSERT_NOT_NULL(scroll);
+    TEST_ASSERT_GREATER_THAN(1, scroll->frames);
+    TEST_ASSERT_GREATER_THAN(0, scroll->bytes);
+    // The title row does not change while the highlight moves.
+    TEST_ASSERT_LESS_OR_EQUAL(FRAME_BYTES * 3 / 4, scroll->bytes / scroll->frames);
+}
+
+void test_panel_matches_the_drawn_frame() {
+    TEST_ASSERT_EQUAL_MEMORY(OLED.getBufferPtr(), OLED.panel(), FRAME_BYTES);
+}
+
+/// Runs the tests once the simulator has played the script.
+static int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_frame_is_sent_whole);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_one_pixel_sends_one_tile);
+    RUN_TEST(test_span_covers_the_tiles_in_between);
+    RUN_TEST(test_invalidate_resends_the_whole_frame);
+    RUN_TEST(test_settled_menu_sends_nothing);
+    RUN_TEST(test_scrolling_sends_partial_frames);
+    RUN_TEST(test_panel_matches_the_drawn_frame);
+    return UNITY_END();
+}
+
+int main() {
+    static const char* const script[] = {
+        "wait 1000",
+        "mark idle", "wait 500",
+        "mark scroll", "cw", "wait 600",
+        "mark", "quit",
+    };
+    for (const char* line : script) {
+        g_simulator.schedule(line);
+    }
+    g_simulator.setFinishHandler(runTests);
+    g_simulator.attachDisplay(OLED, nullptr);
+    g_encoder.begin();
+    g_cancel_button.begin();
+    controller.setup();
+
+    // Does not return: the simulator runs the tests and ends the process once the
+    // script is done.
+    controller.handle(&rootMenu);
+}
@@ -0,0 +1,186 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of the input event queue, fed by interrupt handler stand-ins.
+ *
+ * Run with `pio test -e native_test -f test_input_queue`. The ISR side is played by
+ * direct calls to the handlers the pin interrupts run, Button::onEdge() and
+ * RotaryEncoder::onPinChange(), and by a producer thread that pushes while the test
+ * drains, like an interrupt preempting the UI loop.
+ */
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "config.hpp"
+#include "event_queue.hpp"
+#include "input.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// Drains g_input and g_ui_input into an array.
+static int drainAll(InputEvent* events, int capacity) {
+    int count = 0;
+    drainInput([&](const InputEvent& event) {
+        if (count < capacity) events[count] = event;
+        count++;
+        return false;
+    });
+    return count;
+}
+
+void setUp() {
+    g_input.clear();
+    g_ui_input.clear();
+}
+void tearDown() {}
+
+void test_queue_keeps_order_and_counts_overflows() {
+    EventQueue<int, 4> queue;
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_TRUE(queue.push(1));
+    TEST_ASSERT_TRUE(queue.push(2));
+    TEST_ASSERT_TRUE(queue.push(3));
+    // One slot stays free.
+    TEST_ASSERT_FALSE(queue.push(4));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.overflowCount());
+
+    int value = 0;
+    TEST_ASSERT_TRUE(queue.peek(value));
+    TEST_ASSERT_EQUAL_INT(1, value);
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(1, value);
+    TEST_ASSERT_TRUE(queue.push(5));
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(2, value);
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(3, value);
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(5, value);
+    TEST_ASSERT_FALSE(queue.pop(value));
+}
+
+void test_drain_stops_at_the_handler() {
+    EventQueue<int, 8> queue;
+    for (int i = 1; i <= 5; i++) queue.push(i);
+    int last = 0;
+    TEST_ASSERT_TRUE(queue.drain([&](const int& value) {
+        last = value;
+        return value == 3;
+    }));
+    TEST_ASSERT_EQUAL_INT(3, last);
+    int value = 0;
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(4, value);
+}
+
+void test_concurrent_producer_loses_nothing() {
+    static EventQueue<uint32_t, 64> queue;
+    static constexpr uint32_t COUNT = 200000;
+    std::atomic<bool> go(false);
+    std::thread producer([&] {
+        while (!go.load()) {}
+        for (uint32_t i = 0; i < COUNT; i++) {
+            while (!queue.push(i)) {}
+        }
+    });
+    go.store(true);
+
+    uint32_t expected = 0;
+    while (expected < COUNT) {
+        queue.drain([&](const uint32_t& value) {
+            if (value != expected) return true;
+            expected++;
+            return false;
+        });
+        uint32_t value;
+        if (queue.peek(value) && value != expected) break;
+    }
+    producer.join();
+    TEST_ASSERT_EQUAL_UINT32(COUNT, expected);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_button_edges_are_debounced() {
+    Button button(PIN_ENCODER_BUTTON, LOW, InputEventType::PRESS, InputEventType::RELEASE);
+    button.onEdge(LOW, 1000);
+    button.onEdge(HIGH, 1000 + BUTTON_DEBOUNCE_MS / 2); // bounce
+    button.onEdge(HIGH, 1200);
+
+    InputEvent events[4];
+    TEST_ASSERT_EQUAL_INT(2, drainAll(events, 4));
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::PRESS, (int)events[0].type);
+    TEST_ASSERT_EQUAL_UINT32(1000, events[0].timestamp);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::RELEASE, (int)events[1].type);
+    TEST_ASSERT_EQUAL_UINT32(1200, events[1].timestamp);
+}
+
+void test_button_press_inside_the_debounce_window_is_kept() {
+    Button button(PIN_ENCODER_BUTTON, LOW, InputEventType::PRESS, InputEventType::RELEASE);
+    button.onEdge(LOW, 1000);
+    // Released within the debounce time, so the release is dropped; the next press
+    // reads the level that was already accepted.
+    button.onEdge(HIGH, 1000 + BUTTON_DEBOUNCE_MS / 2);
+    button.onEdge(LOW, 1000 + BUTTON_DEBOUNCE_MS * 2);
+
+    InputEvent events[4];
+    TEST_ASSERT_EQUAL_INT(3, drainAll(events, 4));
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::PRESS, (int)events[0].type);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::RELEASE, (int)events[1].type);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::PRESS, (int)events[2].type);
+    TEST_ASSERT_EQUAL_UINT32(1000 + BUTTON_DEBOUNCE_MS * 2, events[2].timestamp);
+}
+
+void test_encoder_interrupts_queue_detents() {
+    RotaryEncoder encoder(PIN_ENCODER_A, PIN_ENCODER_B, PIN_ENCODER_BUTTON, 4);
+    const uint8_t clockwise[] = {0b10, 0b00, 0b01, 0b11, 0b10, 0b00, 0b01, 0b11};
+    uint32_t now_us = 10000;
+    for (uint8_t state : clockwise) {
+        encoder.onPinChange(state, now_us);
+        now_us += 2000;
+    }
+    // The next edge shows that the last state was held, which completes the second detent.
+    encoder.onPinChange(0b01, now_us);
+
+    InputEvent events[4];
+    TEST_ASSERT_EQUAL_INT(2, drainAll(events, 4));
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::DETENT_CW, (int)events[0].type);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::DETENT_CW, (int)events[1].type);
+    TEST_ASSERT_TRUE(g_ui_input.empty());
+}
+
+void test_ui_events_are_merged_by_timestamp() {
+    g_input.push({InputEventType::DETENT_CW, 10});
+    g_input.push({InputEventType::PRESS, 30});
+    g_ui_input.push({InputEventType::DETENT_CCW, 20});
+    g_ui_input.push({InputEventType::CANCEL, 30});
+    g_ui_input.push({InputEventType::RELEASE, 40});
+
+    InputEvent events[5];
+    TEST_ASSERT_EQUAL_INT(5, drainAll(events, 5));
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::DETENT_CW, (int)events[0].type);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::DETENT_CCW, (int)events[1].type);
+    // Same timestamp: the interrupt's event first.
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::PRESS, (int)events[2].type);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::CANCEL, (int)events[3].type);
+    TEST_ASSERT_EQUAL_INT((int)InputEventType::RELEASE, (int)events[4].type);
+}
+
+void test_merged_drain_leaves_events_after_the_stop() {
+    g_input.push({InputEventType::PRESS, 10});
+    g_ui_input.push({InputEventType::DETENT_CW, 20});
+    TEST_ASSERT_TRUE(drainInput([](const InputEvent& event) { return event.type == InputEventType::PRESS; }));
+    TEST_ASSERT_TRUE(g_input.empty());
+    TEST_ASSERT_FALSE(g_ui_input.empty());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_keeps_order_and_counts_overflows);
+    RUN_TEST(test_drain_stops_at_the_handler);
+    RUN_TEST(test_concurrent_producer_loses_nothing);
+    RUN_TEST(test_button_edges_are_debounced);
+    RUN_TEST(test_button_press_inside_the_debounce_window_is_kept);
+    RUN_TEST(test_encoder_interrupts_queue_detents);
+    RUN_TEST(test_ui_events_are_merged_by_timestamp);
+    RUN_TEST(test_merged_drain_leaves_events_after_the_stop);
+    return UNITY_END();
+}
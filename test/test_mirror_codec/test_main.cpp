@@ -0,0 +1,231 @@
+/**
+ * @file test_main.cpp
+ * @brief Round-trip tests of the mirror run-length encoding and MirrorDecoder.
+ *
+ * Run with `pio test -e native_test -f test_mirror_codec`. Bytes are encoded with
+ * mirrorRleEncode() and decoded again, both directly and as MIRROR_FRAME payloads
+ * built like Mirror builds them, and malformed records must be counted, not applied.
+ */
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "config.hpp"
+#include "mirror_codec.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The bytes of one 8x8 tile.
+static constexpr size_t TILE = 8;
+/// The size of the test framebuffer in tiles, as on the device.
+static constexpr uint8_t TILES_X = SCREEN_WIDTH / 8;
+static constexpr uint8_t TILES_Y = SCREEN_HEIGHT / 8;
+
+/// Encodes and decodes bytes, checks the round trip and the bound and returns the encoded size.
+static size_t roundTrip(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> encoded(mirrorRleBound(data.size()) + 1, 0xEE);
+    size_t size = mirrorRleEncode(data.data(), data.size(), encoded.data());
+    TEST_ASSERT_LESS_OR_EQUAL(mirrorRleBound(data.size()), size);
+    // Nothing is written past the encoded size.
+    TEST_ASSERT_EQUAL_INT(0xEE, encoded[size]);
+
+    std::vector<uint8_t> decoded(data.size() + 1, 0);
+    TEST_ASSERT_EQUAL_size_t(data.size(), mirrorRleDecode(encoded.data(), size, decoded.data(), decoded.size()));
+    if (!data.empty()) TEST_ASSERT_EQUAL_MEMORY(data.data(), decoded.data(), data.size());
+    return size;
+}
+
+/// Builds a MIRROR_FRAME payload holding one tile record.
+static std::vector<uint8_t> tileRecord(uint16_t sequence, uint8_t row, uint8_t first, uint8_t count,
+                                       const uint8_t* tiles) {
+    std::vector<uint8_t> payload = {0, (uint8_t)(sequence & 0xFF), (uint8_t)(sequence >> 8), row, first, count};
+    size_t span = (size_t)count * TILE;
+    std::vector<uint8_t> encoded(mirrorRleBound(span));
+    size_t size = mirrorRleEncode(tiles, span, encoded.data());
+    payload.insert(payload.end(), encoded.begin(), encoded.begin() + size);
+    return payload;
+}
+
+/// Builds a MIRROR_FRAME payload holding an end record.
+static std::vector<uint8_t> endRecord(uint16_t sequence, uint32_t time_ms) {
+    return {0,
+            (uint8_t)(sequence & 0xFF),
+            (uint8_t)(sequence >> 8),
+            MIRROR_END_OF_FRAME,
+            (uint8_t)time_ms,
+            (uint8_t)(time_ms >> 8),
+            (uint8_t)(time_ms >> 16),
+            (uint8_t)(time_ms >> 24)};
+}
+
+static std::vector<uint8_t> randomBytes(size_t length) {
+    std::vector<uint8_t> data(length);
+    for (uint8_t& value : data) value = (uint8_t)rand();
+    return data;
+}
+
+void setUp() {
+    srand(1);
+}
+void tearDown() {}
+
+void test_all_zero_tiles_compress() {
+    std::vector<uint8_t> data(TILES_X * TILE, 0);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * (data.size() / 129 + 1), roundTrip(data));
+    TEST_ASSERT_EQUAL_size_t(0, roundTrip(std::vector<uint8_t>()));
+    TEST_ASSERT_EQUAL_size_t(2, roundTrip(std::vector<uint8_t>(1, 0)));
+}
+
+void test_alternating_tiles_stay_within_the_bound() {
+    std::vector<uint8_t> data(TILES_X * TILE);
+    for (size_t i = 0; i < data.size(); i++) data[i] = (i & 1) ? 0xAA : 0x55;
+    TEST_ASSERT_EQUAL_size_t(mirrorRleBound(data.size()), roundTrip(data));
+    // Pairs in a literal run are not worth a header of their own.
+    for (size_t i = 0; i < data.size(); i++) data[i] = (i & 2) ? 0xFF : 0x00;
+    TEST_ASSERT_LESS_OR_EQUAL(mirrorRleBound(data.size()), roundTrip(data));
+}
+
+void test_random_tiles_round_trip() {
+    for (size_t length = 1; length <= 4 * TILES_X * TILE; length += 37) {
+        roundTrip(randomBytes(length));
+    }
+    // Random runs between random bytes.
+    for (int pass = 0; pass < 50; pass++) {
+        std::vector<uint8_t> data;
+        while (data.size() < 1024) {
+            std::vector<uint8_t> literal = randomBytes(rand() % 8);
+            data.insert(data.end(), literal.begin(), literal.end());
+            data.insert(data.end(), rand() % 300, (uint8_t)rand());
+        }
+        roundTrip(data);
+    }
+}
+
+void test_runs_at_the_header_limits() {
+    // 129 is the longest repeat a header describes; 128 and 130 are either side of it.
+    TEST_ASSERT_EQUAL_size_t(2, roundTrip(std::vector<uint8_t>(128, 0x3C)));
+    TEST_ASSERT_EQUAL_size_t(2, roundTrip(std::vector<uint8_t>(129, 0x3C)));
+    TEST_ASSERT_EQUAL_size_t(4, roundTrip(std::vector<uint8_t>(130, 0x3C)));
+    TEST_ASSERT_EQUAL_size_t(4, roundTrip(std::vector<uint8_t>(258, 0x3C)));
+    TEST_ASSERT_EQUAL_size_t(6, roundTrip(std::vector<uint8_t>(259, 0x3C)));
+
+    // 128 is also the longest literal run.
+    std::vector<uint8_t> literal(129);
+    for (size_t i = 0; i < literal.size(); i++) literal[i] = (uint8_t)i;
+    TEST_ASSERT_EQUAL_size_t(mirrorRleBound(literal.size()), roundTrip(literal));
+
+    // A run right after a full literal run.
+    literal.resize(128);
+    literal.insert(literal.end(), 130, 0x99);
+    roundTrip(literal);
+}
+
+void test_every_short_pattern_stays_within_the_bound() {
+    // Every sequence of up to 14 bytes over two values covers each mix of runs and literals.
+    for (size_t length = 1; length <= 14; length++) {
+        for (uint32_t bits = 0; bits < (1u << length); bits++) {
+            std::vector<uint8_t> data(length);
+            for (size_t i = 0; i < length; i++) data[i] = (bits >> i) & 1;
+            roundTrip(data);
+        }
+    }
+}
+
+void test_decode_rejects_malformed_input() {
+    uint8_t out[16];
+    // A literal header without its bytes.
+    const uint8_t short_literal[] = {3, 1, 2};
+    TEST_ASSERT_EQUAL_size_t(0, mirrorRleDecode(short_literal, sizeof(short_literal), out, sizeof(out)));
+    // A repeat header without its byte.
+    const uint8_t short_repeat[] = {0x80};
+    TEST_ASSERT_EQUAL_size_t(0, mirrorRleDecode(short_repeat, sizeof(short_repeat), out, sizeof(out)));
+    // More bytes than fit.
+    const uint8_t too_long[] = {0xFF, 7};
+    TEST_ASSERT_EQUAL_size_t(0, mirrorRleDecode(too_long, sizeof(too_long), out, sizeof(out)));
+}
+
+void test_decoder_rebuilds_the_frame() {
+    MirrorDecoder decoder(TILES_X, TILES_Y);
+    std::vector<uint8_t> frame = randomBytes((size_t)TILES_X * TILES_Y * TILE);
+    // Two records per row, like rows split for the payload limit.
+    uint8_t half = TILES_X / 2;
+    for (uint8_t row = 0; row < TILES_Y; row++) {
+        const uint8_t* tiles = frame.data() + (size_t)row * TILES_X * TILE;
+        std::vector<uint8_t> left = tileRecord(7, row, 0, half, tiles);
+        std::vector<uint8_t> right = tileRecord(7, row, half, TILES_X - half, tiles + half * TILE);
+        TEST_ASSERT_FALSE(decoder.apply(left.data(), left.size()));
+        TEST_ASSERT_FALSE(decoder.apply(right.data(), right.size()));
+    }
+    std::vector<uint8_t> end = endRecord(7, 123456789);
+    TEST_ASSERT_TRUE(decoder.apply(end.data(), end.size()));
+    TEST_ASSERT_EQUAL_MEMORY(frame.data(), decoder.frame(), frame.size());
+    TEST_ASSERT_EQUAL_UINT16(7, decoder.sequence());
+    TEST_ASSERT_EQUAL_UINT32(123456789, decoder.timeMs());
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.errors());
+
+    // pixel() reads the U8g2 tile layout: bit y % 8 of byte x in tile row y / 8.
+    int x = 21, y = 42;
+    bool lit = (frame[(size_t)(y / 8) * TILES_X * TILE + x] >> (y % 8)) & 1;
+    TEST_ASSERT_TRUE(decoder.pixel(x, y) == lit);
+    TEST_ASSERT_FALSE(decoder.pixel(-1, 0));
+    TEST_ASSERT_FALSE(decoder.pixel(SCREEN_WIDTH, 0));
+}
+
+void test_decoder_counts_truncated_records() {
+    MirrorDecoder decoder(TILES_X, TILES_Y);
+    std::vector<uint8_t> tiles = randomBytes(4 * TILE);
+    std::vector<uint8_t> record = tileRecord(1, 2, 3, 4, tiles.data());
+    uint32_t errors = 0;
+
+    // Cut short anywhere: in the header, in the encoded tiles or by a whole run.
+    for (size_t length = 0; length < record.size(); length++) {
+        TEST_ASSERT_FALSE(decoder.apply(record.data(), length));
+        TEST_ASSERT_EQUAL_UINT32(++errors, decoder.errors());
+    }
+    std::vector<uint8_t> end = endRecord(1, 5);
+    for (size_t length = 1; length < end.size(); length++) {
+        TEST_ASSERT_FALSE(decoder.apply(end.data(), length));
+        TEST_ASSERT_EQUAL_UINT32(++errors, decoder.errors());
+    }
+}
+
+void test_decoder_counts_oversized_records() {
+    MirrorDecoder decoder(TILES_X, TILES_Y);
+    std::vector<uint8_t> blank(decoder.frame(), decoder.frame() + (size_t)TILES_X * TILES_Y * TILE);
+    std::vector<uint8_t> tiles(TILES_X * TILE, 0xFF);
+
+    // More tiles than the row has, a row below the screen.
+    std::vector<uint8_t> wide = tileRecord(1, 0, 1, TILES_X, tiles.data());
+    TEST_ASSERT_FALSE(decoder.apply(wide.data(), wide.size()));
+    std::vector<uint8_t> low = tileRecord(1, TILES_Y, 0, 1, tiles.data());
+    TEST_ASSERT_FALSE(decoder.apply(low.data(), low.size()));
+    TEST_ASSERT_EQUAL_UINT32(2, decoder.errors());
+
+    // Encoded data that decodes to more bytes than the record's tiles.
+    std::vector<uint8_t> record = tileRecord(1, 0, 0, 1, tiles.data());
+    record.push_back(0x80);
+    record.push_back(0xFF);
+    TEST_ASSERT_FALSE(decoder.apply(record.data(), record.size()));
+    TEST_ASSERT_EQUAL_UINT32(3, decoder.errors());
+    TEST_ASSERT_EQUAL_MEMORY(blank.data(), decoder.frame(), blank.size());
+
+    // The decoder still takes good records afterwards.
+    std::vector<uint8_t> good = tileRecord(2, 0, 0, 1, tiles.data());
+    decoder.apply(good.data(), good.size());
+    TEST_ASSERT_EQUAL_UINT32(3, decoder.errors());
+    TEST_ASSERT_TRUE(decoder.pixel(0, 0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_all_zero_tiles_compress);
+    RUN_TEST(test_alternating_tiles_stay_within_the_bound);
+    RUN_TEST(test_random_tiles_round_trip);
+    RUN_TEST(test_runs_at_the_header_limits);
+    RUN_TEST(test_every_short_pattern_stays_within_the_bound);
+    RUN_TEST(test_decode_rejects_malformed_input);
+    RUN_TEST(test_decoder_rebuilds_the_frame);
+    RUN_TEST(test_decoder_counts_truncated_records);
+    RUN_TEST(test_decoder_counts_oversized_records);
+    return UNITY_END();
+}
@@ -0,0 +1,219 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of QuadratureDecoder with recorded-style pin traces, and of CounterDetents.
+ *
+ * Run with `pio test -e native_test -f test_quadrature`. Each trace is a list of pin
+ * states `(A << 1) | B` and the time since the previous one, fed to update() like the
+ * pin interrupt does, followed by a poll() once the last state was held long enough.
+ * CounterDetents is fed readings of a simulated pulse counter that restarts at its limit.
+ */
+#include <unity.h>
+#include <stddef.h>
+#include "config.hpp"
+#include "quadrature.hpp"
+
+// The firmware sources built into every test draw on this display.
+DisplayDriver OLED(U8G2_R0);
+
+/// The glitch filter used by the tests, as in ENCODER_GLITCH_FILTER_US.
+static constexpr uint32_t FILTER_US = 500;
+
+/// One step of a pin trace.
+struct TraceStep {
+    uint8_t state;   ///< The new pin state.
+    uint32_t gap_us; ///< The time since the previous step.
+};
+
+/// The time of the last step of the last replayed trace.
+static uint32_t trace_end_us;
+
+/// Replays a trace from rest state 11 and returns the detents, positive clockwise.
+template <size_t N>
+static int replay(QuadratureDecoder& decoder, const TraceStep (&trace)[N]) {
+    decoder.reset(0b11);
+    uint32_t now_us = 1000;
+    int detents = 0;
+    for (const TraceStep& step : trace) {
+        now_us += step.gap_us;
+        detents += decoder.update(step.state, now_us);
+    }
+    trace_end_us = now_us;
+    return detents + decoder.poll(now_us + FILTER_US);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_clean_clockwise_detent() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    const TraceStep trace[] = {{0b10, 2000}, {0b00, 2000}, {0b01, 2000}, {0b11, 2000}};
+    TEST_ASSERT_EQUAL_INT(1, replay(decoder, trace));
+    TEST_ASSERT_EQUAL_UINT32(trace_end_us, decoder.detentTimeUs());
+}
+
+void test_clean_counter_clockwise_detent() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    const TraceStep trace[] = {{0b01, 2000}, {0b00, 2000}, {0b10, 2000}, {0b11, 2000}};
+    TEST_ASSERT_EQUAL_INT(-1, replay(decoder, trace));
+}
+
+void test_single_channel_bounce_counts_once() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    // A bounces three times before it settles, then B follows cleanly.
+    const TraceStep trace[] = {
+        {0b10, 2000}, {0b11, 40}, {0b10, 30}, {0b11, 40}, {0b10, 30},
+        {0b00, 2000}, {0b01, 2000}, {0b11, 2000},
+    };
+    TEST_ASSERT_EQUAL_INT(1, replay(decoder, trace));
+}
+
+void test_bounce_at_rest_state_counts_once() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    // B bounces back and forth while the detent is reached.
+    const TraceStep trace[] = {
+        {0b10, 2000}, {0b00, 2000}, {0b01, 2000},
+        {0b11, 2000}, {0b01, 50}, {0b11, 50}, {0b01, 50}, {0b11, 50},
+    };
+    TEST_ASSERT_EQUAL_INT(1, replay(decoder, trace));
+}
+
+void test_sub_filter_glitch_is_dropped() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    const TraceStep trace[] = {{0b10, 2000}, {0b11, FILTER_US - 200}, {0b01, 2000}, {0b11, FILTER_US - 100}};
+    TEST_ASSERT_EQUAL_INT(0, replay(decoder, trace));
+}
+
+void test_half_turn_and_back_counts_nothing() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    const TraceStep trace[] = {{0b10, 2000}, {0b00, 2000}, {0b10, 2000}, {0b11, 2000}};
+    TEST_ASSERT_EQUAL_INT(0, replay(decoder, trace));
+}
+
+void test_fast_multi_detent_spin() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    // Three detents clockwise with 1 ms between edges, then two back.
+    const TraceStep trace[] = {
+        {0b10, 1000}, {0b00, 1000}, {0b01, 1000}, {0b11, 1000},
+        {0b10, 1000}, {0b00, 1000}, {0b01, 1000}, {0b11, 1000},
+        {0b10, 1000}, {0b00, 1000}, {0b01, 1000}, {0b11, 1000},
+        {0b01, 1000}, {0b00, 1000}, {0b10, 1000}, {0b11, 1000},
+        {0b01, 1000}, {0b00, 1000}, {0b10, 1000}, {0b11, 1000},
+    };
+    TEST_ASSERT_EQUAL_INT(1, replay(decoder, trace));
+}
+
+/// Regression: a third state arriving before the filter time replaced the pending one,
+/// so the two steps in between were read as an impossible jump and the detent was lost.
+void test_edges_faster_than_filter_lose_no_pulses() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    const TraceStep trace[] = {
+        {0b10, 2000}, {0b00, 100}, {0b01, 100}, {0b11, 100},
+        {0b10, 100}, {0b00, 100}, {0b01, 100}, {0b11, 100},
+    };
+    TEST_ASSERT_EQUAL_INT(2, replay(decoder, trace));
+
+    const TraceStep back[] = {{0b01, 2000}, {0b00, 100}, {0b10, 100}, {0b11, 100}};
+    TEST_ASSERT_EQUAL_INT(-1, replay(decoder, back));
+}
+
+void test_missed_edge_still_counts_the_detent() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    // The change to 01 was never seen, so 00 -> 11 reads as no pulse.
+    const TraceStep trace[] = {{0b10, 2000}, {0b00, 2000}, {0b11, 2000}};
+    TEST_ASSERT_EQUAL_INT(1, replay(decoder, trace));
+}
+
+void test_last_change_is_counted_by_poll() {
+    QuadratureDecoder decoder(4, FILTER_US);
+    decoder.reset(0b11);
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b10, 1000));
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b00, 3000));
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b01, 5000));
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b11, 7000));
+    // The UI must keep polling, not sleep, while the last state waits.
+    TEST_ASSERT_TRUE(decoder.waiting());
+    TEST_ASSERT_EQUAL_INT(0, decoder.poll(7000 + FILTER_US - 1));
+    TEST_ASSERT_EQUAL_INT(1, decoder.poll(7000 + FILTER_US));
+    TEST_ASSERT_EQUAL_UINT32(7000, decoder.detentTimeUs());
+    TEST_ASSERT_FALSE(decoder.waiting());
+    TEST_ASSERT_EQUAL_INT(0, decoder.poll(20000));
+}
+
+void test_two_pulse_encoder_counts_by_threshold() {
+    QuadratureDecoder decoder(2, FILTER_US);
+    const TraceStep trace[] = {{0b10, 2000}, {0b00, 2000}, {0b01, 2000}, {0b11, 2000}};
+    TEST_ASSERT_EQUAL_INT(2, replay(decoder, trace));
+}
+
+void test_without_filter_every_change_counts() {
+    QuadratureDecoder decoder(4, 0);
+    decoder.reset(0b11);
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b10, 0));
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b00, 1));
+    TEST_ASSERT_EQUAL_INT(0, decoder.update(0b01, 2));
+    TEST_ASSERT_EQUAL_INT(1, decoder.update(0b11, 3));
+}
+
+/// The limit of the ESP32 pulse counter, at which it restarts from 0.
+static constexpr int PCNT_LIMIT = 32000;
+
+/**
+ * @brief Turns a pulse counter by some pulses, restarting at the limit like the hardware.
+ * @return The detents CounterDetents reads, one reading per @p per_read pulses.
+ */
+static int turnCounter(CounterDetents& detents, int& count, int pulses, int per_read) {
+    int total = 0;
+    int step = pulses > 0 ? 1 : -1;
+    for (int i = 0; i != pulses; i += step) {
+        count += step;
+        if (count == PCNT_LIMIT || count == -PCNT_LIMIT) count = 0;
+        if ((i + step) % per_read == 0) total += detents.update(count);
+    }
+    return total + detents.update(count);
+}
+
+void test_counter_restarts_do_not_shift_detents() {
+    // 32000 is not a multiple of 3: the partial detent is carried over each restart.
+    for (int pulses_per_detent = 1; pulses_per_detent <= 4; pulses_per_detent++) {
+        CounterDetents detents(pulses_per_detent, PCNT_LIMIT);
+        int count = 0;
+        detents.reset(count);
+        int turned = 0;
+        for (int lap = 0; lap < 5; lap++) {
+            turned += turnCounter(detents, count, PCNT_LIMIT + 1, 97);
+            TEST_ASSERT_EQUAL_INT((lap + 1) * (PCNT_LIMIT + 1) / pulses_per_detent, turned);
+        }
+        // And back through the restarts below zero.
+        turned += turnCounter(detents, count, -10 * (PCNT_LIMIT + 1), 101);
+        TEST_ASSERT_EQUAL_INT(-5 * (PCNT_LIMIT + 1) / pulses_per_detent, turned);
+    }
+}
+
+void test_counter_partial_detents_add_up() {
+    CounterDetents detents(3, PCNT_LIMIT);
+    detents.reset(PCNT_LIMIT - 2);
+    TEST_ASSERT_EQUAL_INT(0, detents.update(PCNT_LIMIT - 1));
+    TEST_ASSERT_EQUAL_INT(0, detents.update(0));
+    TEST_ASSERT_EQUAL_INT(1, detents.update(1));
+    TEST_ASSERT_EQUAL_INT(0, detents.update(0));
+    TEST_ASSERT_EQUAL_INT(-1, detents.update(-2));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_clockwise_detent);
+    RUN_TEST(test_clean_counter_clockwise_detent);
+    RUN_TEST(test_single_channel_bounce_counts_once);
+    RUN_TEST(test_bounce_at_rest_state_counts_once);
+    RUN_TEST(test_sub_filter_glitch_is_dropped);
+    RUN_TEST(test_half_turn_and_back_counts_nothing);
+    RUN_TEST(test_fast_multi_detent_spin);
+    RUN_TEST(test_edges_faster_than_filter_lose_no_pulses);
+    RUN_TEST(test_missed_edge_still_counts_the_detent);
+    RUN_TEST(test_last_change_is_counted_by_poll);
+    RUN_TEST(test_two_pulse_encoder_counts_by_threshold);
+    RUN_TEST(test_without_filter_every_change_counts);
+    RUN_TEST(test_counter_restarts_do_not_shift_detents);
+    RUN_TEST(test_counter_partial_detents_add_up);
+    return UNITY_END();
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_main.cpp
+ * @brief Loopback tests of the remote-control framing: RemoteWriter frames fed back into RemoteParser.
+ *
+ * Run with `pio test -e native_test -f test_remote_protocol`. The frames are built by
+ * the same RemoteWriter the device replies with, then split, batched or corrupted on
+ * their way into the parser.
+ */
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "config.hpp"
+#include "remote.hpp"
+#include "remote_protocol.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/**
+ * @class BytePrint
+ * @brief A Print that collects the written bytes.
+ */
+class BytePrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        bytes.push_back(c);
+        return 1;
+    }
+    size_t write(const uint8_t* data, size_t size) override {
+        bytes.insert(bytes.end(), data, data + size);
+        return size;
+    }
+    using Print::write;
+
+    std::vector<uint8_t> bytes; ///< Everything written.
+};
+
+/// Builds a frame with RemoteWriter.
+static std::vector<uint8_t> makeFrame(uint8_t command, const uint8_t* payload, size_t length) {
+    BytePrint out;
+    RemoteWriter(out).send(command, payload, length);
+    return out.bytes;
+}
+
+/// Checks that the parser returns a frame with the given command and payload.
+static void expectFrame(RemoteParser& parser, uint8_t command, const uint8_t* payload, size_t length) {
+    RemoteFrame frame;
+    TEST_ASSERT_TRUE(parser.next(frame));
+    TEST_ASSERT_EQUAL_INT(command, frame.command);
+    TEST_ASSERT_EQUAL_INT((int)length, frame.length);
+    if (length) TEST_ASSERT_EQUAL_MEMORY(payload, frame.payload, length);
+}
+
+static const uint8_t PAYLOAD[] = {1, 2, 3, 0xA5, 0x00, 0xFF};
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc_matches_known_vectors() {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    // CRC-16/XMODEM starts from 0, CRC-16/CCITT-FALSE, the frame CRC, from 0xFFFF.
+    TEST_ASSERT_EQUAL_UINT16(0x31C3, remoteCrc(check, sizeof(check), 0x0000));
+    TEST_ASSERT_EQUAL_UINT16(0x29B1, remoteCrc(check, sizeof(check)));
+    // Checksumming in parts gives the same result.
+    TEST_ASSERT_EQUAL_UINT16(0x29B1, remoteCrc(check + 4, 5, remoteCrc(check, 4)));
+}
+
+void test_frame_round_trip() {
+    std::vector<uint8_t> bytes = makeFrame(0x05, PAYLOAD, sizeof(PAYLOAD));
+    TEST_ASSERT_EQUAL_size_t(sizeof(PAYLOAD) + REMOTE_FRAME_OVERHEAD, bytes.size());
+    TEST_ASSERT_EQUAL_INT(REMOTE_FRAME_START, bytes[0]);
+
+    RemoteParser parser;
+    parser.receive(bytes.data(), bytes.size());
+    expectFrame(parser, 0x05, PAYLOAD, sizeof(PAYLOAD));
+    RemoteFrame frame;
+    TEST_ASSERT_FALSE(parser.next(frame));
+    TEST_ASSERT_EQUAL_UINT32(0, parser.crcErrors());
+}
+
+void test_frame_split_across_receives() {
+    std::vector<uint8_t> bytes = makeFrame(0x01, PAYLOAD, sizeof(PAYLOAD));
+    // Every split point, down to single bytes.
+    for (size_t split = 1; split < bytes.size(); split++) {
+        RemoteParser parser;
+        RemoteFrame frame;
+        parser.receive(bytes.data(), split);
+        TEST_ASSERT_FALSE(parser.next(frame));
+        parser.receive(bytes.data() + split, bytes.size() - split);
+        expectFrame(parser, 0x01, PAYLOAD, sizeof(PAYLOAD));
+    }
+
+    RemoteParser parser;
+    RemoteFrame frame;
+    for (size_t i = 0; i + 1 < bytes.size(); i++) {
+        parser.receive(&bytes[i], 1);
+        TEST_ASSERT_FALSE(parser.next(frame));
+    }
+    parser.receive(&bytes.back(), 1);
+    expectFrame(parser, 0x01, PAYLOAD, sizeof(PAYLOAD));
+}
+
+void test_several_frames_in_one_receive() {
+    std::vector<uint8_t> bytes;
+    for (uint8_t command = 1; command <= 5; command++) {
+        std::vector<uint8_t> frame = makeFrame(command, PAYLOAD, command);
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+    }
+    std::vector<uint8_t> empty = makeFrame(0x06, nullptr, 0);
+    bytes.insert(bytes.end(), empty.begin(), empty.end());
+
+    RemoteParser parser;
+    TEST_ASSERT_EQUAL_size_t(bytes.size(), parser.receive(bytes.data(), bytes.size()));
+    for (uint8_t command = 1; command <= 5; command++) {
+        expectFrame(parser, command, PAYLOAD, command);
+    }
+    expectFrame(parser, 0x06, nullptr, 0);
+    RemoteFrame frame;
+    TEST_ASSERT_FALSE(parser.next(frame));
+}
+
+void test_stray_bytes_before_a_frame_are_skipped() {
+    std::vector<uint8_t> bytes = {0x00, 0x13, 0x37};
+    std::vector<uint8_t> frame = makeFrame(0x02, PAYLOAD, 2);
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+    RemoteParser parser;
+    parser.receive(bytes.data(), bytes.size());
+    expectFrame(parser, 0x02, PAYLOAD, 2);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.crcErrors());
+}
+
+void test_bad_crc_resyncs_inside_the_frame() {
+    // A frame whose payload carries a complete frame, as after a lost byte on the line.
+    std::vector<uint8_t> inner = makeFrame(0x03, PAYLOAD, 3);
+    std::vector<uint8_t> outer = makeFrame(0x04, inner.data(), inner.size());
+    outer[outer.size() - 1] ^= 0x55;
+
+    RemoteParser parser;
+    parser.receive(outer.data(), outer.size());
+    expectFrame(parser, 0x03, PAYLOAD, 3);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.crcErrors());
+    RemoteFrame frame;
+    TEST_ASSERT_FALSE(parser.next(frame));
+
+    // The parser still takes frames after the bad one.
+    std::vector<uint8_t> next = makeFrame(0x01, PAYLOAD, 1);
+    parser.receive(next.data(), next.size());
+    expectFrame(parser, 0x01, PAYLOAD, 1);
+}
+
+void test_corrupt_length_byte_costs_one_frame() {
+    // Any length byte fits the buffer, so a corrupt one can only delay the parser until
+    // as many bytes as it claims have arrived; it can never stall it.
+    static_assert(REMOTE_MAX_PAYLOAD + REMOTE_FRAME_OVERHEAD <= REMOTE_BUFFER_SIZE,
+                  "the largest frame must fit in the receive buffer");
+    std::vector<uint8_t> bytes = {REMOTE_FRAME_START, 0xFF, 0x01};
+    std::vector<uint8_t> frame = makeFrame(0x02, PAYLOAD, sizeof(PAYLOAD));
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+    RemoteParser parser;
+    RemoteFrame parsed;
+    parser.receive(bytes.data(), bytes.size());
+    TEST_ASSERT_FALSE(parser.next(parsed));
+
+    // Idle bytes until the claimed length is complete.
+    std::vector<uint8_t> filler(REMOTE_MAX_PAYLOAD + REMOTE_FRAME_OVERHEAD, 0);
+    parser.receive(filler.data(), filler.size());
+    expectFrame(parser, 0x02, PAYLOAD, sizeof(PAYLOAD));
+    TEST_ASSERT_EQUAL_UINT32(1, parser.crcErrors());
+}
+
+void test_full_buffer_takes_no_more_bytes() {
+    RemoteParser parser;
+    std::vector<uint8_t> filler(REMOTE_BUFFER_SIZE + 10, 0x11);
+    TEST_ASSERT_EQUAL_size_t(REMOTE_BUFFER_SIZE, parser.receive(filler.data(), filler.size()));
+    RemoteFrame frame;
+    TEST_ASSERT_FALSE(parser.next(frame));
+
+    // The stray bytes were consumed, so the buffer has room again.
+    std::vector<uint8_t> bytes = makeFrame(0x01, PAYLOAD, sizeof(PAYLOAD));
+    TEST_ASSERT_EQUAL_size_t(bytes.size(), parser.receive(bytes.data(), bytes.size()));
+    expectFrame(parser, 0x01, PAYLOAD, sizeof(PAYLOAD));
+}
+
+void test_largest_payload_round_trip() {
+    uint8_t payload[REMOTE_MAX_PAYLOAD];
+    for (size_t i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t)(i * 7);
+    std::vector<uint8_t> bytes = makeFrame(0x08, payload, sizeof(payload));
+    RemoteParser parser;
+    parser.receive(bytes.data(), bytes.size());
+    expectFrame(parser, 0x08, payload, sizeof(payload));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_matches_known_vectors);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_frame_split_across_receives);
+    RUN_TEST(test_several_frames_in_one_receive);
+    RUN_TEST(test_stray_bytes_before_a_frame_are_skipped);
+    RUN_TEST(test_bad_crc_resyncs_inside_the_frame);
+    RUN_TEST(test_corrupt_length_byte_costs_one_frame);
+    RUN_TEST(test_full_buffer_takes_no_more_bytes);
+    RUN_TEST(test_largest_payload_round_trip);
+    return UNITY_END();
+}
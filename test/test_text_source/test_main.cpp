@@ -0,0 +1,224 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests of StdioTextSource, ChunkCache and StreamInfoPage scrolling over a large file.
+ *
+ * Run with `pio test -e native_test -f test_text_source`. The file is a few megabytes
+ * of CRLF text with long unbroken lines, so that display lines cross chunk boundaries
+ * everywhere and scrolling up has to find line starts it has not seen.
+ */
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "config.hpp"
+#include "pages.hpp"
+#include "text_source.hpp"
+#include "simulator.hpp"
+
+DisplayDriver OLED(U8G2_R0);
+
+/// The size of the generated file.
+static constexpr size_t FILE_SIZE = 2 * 1024 * 1024;
+
+/**
+ * @class CountingSource
+ * @brief Passes reads through to another source and records their sizes.
+ */
+class CountingSource : public TextSource {
+public:
+    explicit CountingSource(TextSource& source) : source(source) {}
+
+    size_t size() const override { return source.size(); }
+    size_t read(size_t offset, char* buffer, size_t length) override {
+        reads++;
+        if (length > largest_read) largest_read = length;
+        return source.read(offset, buffer, length);
+    }
+
+    TextSource& source;      ///< The source read from.
+    uint32_t reads = 0;      ///< The number of reads.
+    size_t largest_read = 0; ///< The longest read asked for.
+};
+
+/**
+ * @class StreamPageProbe
+ * @brief Opens up the line stepping of StreamInfoPage for the tests.
+ */
+class StreamPageProbe : public StreamInfoPage {
+public:
+    explicit StreamPageProbe(TextSource& source) : StreamInfoPage(source) {}
+    using StreamInfoPage::nextLine;
+    using StreamInfoPage::onScrollDown;
+    using StreamInfoPage::onScrollUp;
+    using StreamInfoPage::prevLine;
+    using StreamInfoPage::topOffset;
+};
+
+static FILE* file;
+static std::string text;
+
+/// Builds the file: paragraphs of words, unbroken lines of up to 2000 bytes and empty lines.
+static void makeText() {
+    unsigned seed = 1;
+    while (text.size() < FILE_SIZE) {
+        seed = seed * 1103515245 + 12345;
+        switch ((seed >> 16) % 4) {
+        case 0:
+            for (int i = 0; i < 12; i++) text += "word ";
+            text += "end";
+            break;
+        case 1:
+        case 2:
+            for (size_t i = 0, n = (seed >> 8) % 2000 + 1; i < n; i++) text += (char)('a' + i % 26);
+            break;
+        default:
+            break;
+        }
+        text += "\r\n";
+    }
+}
+
+/// Steps through the file with nextLine() from the top and returns the line starts.
+static std::vector<size_t> forwardLines(StreamPageProbe& page) {
+    std::vector<size_t> lines;
+    for (size_t line = 0; line < text.size(); line = page.nextLine(line)) lines.push_back(line);
+    return lines;
+}
+
+void setUp() {
+    OLED.setFont(u8g2_font_6x12_me);
+}
+void tearDown() {
+    OLED.setFont(DEFAULT_TEXT_FONT);
+}
+
+void test_stdio_source_reads_the_file() {
+    StdioTextSource source(file);
+    TEST_ASSERT_EQUAL_size_t(text.size(), source.size());
+    char buffer[300];
+    size_t offset = text.size() / 2 + 7;
+    TEST_ASSERT_EQUAL_size_t(sizeof(buffer), source.read(offset, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_MEMORY(text.data() + offset, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_size_t(5, source.read(text.size() - 5, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_size_t(0, source.read(text.size(), buffer, sizeof(buffer)));
+}
+
+void test_chunk_cache_matches_the_file() {
+    StdioTextSource file_source(file);
+    CountingSource source(file_source);
+    ChunkCache cache(source);
+    TEST_ASSERT_EQUAL_size_t(text.size(), cache.size());
+
+    // Copies across chunk boundaries, forwards and backwards.
+    char buffer[3 * STREAM_CHUNK_SIZE];
+    for (size_t offset = 0; offset < 64 * STREAM_CHUNK_SIZE; offset += STREAM_CHUNK_SIZE / 3) {
+        size_t copied = cache.copy(offset, buffer, sizeof(buffer));
+        TEST_ASSERT_EQUAL_size_t(sizeof(buffer), copied);
+        TEST_ASSERT_EQUAL_MEMORY(text.data() + offset, buffer, copied);
+    }
+    for (size_t offset = text.size() - 1; offset > text.size() - 4 * STREAM_CHUNK_SIZE; offset--) {
+        TEST_ASSERT_EQUAL_INT((unsigned char)text[offset], cache.at(offset));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, cache.at(text.size()));
+    TEST_ASSERT_EQUAL_size_t(3, cache.copy(text.size() - 3, buffer, sizeof(buffer)));
+    TEST_ASSERT_LESS_OR_EQUAL(STREAM_CHUNK_SIZE, source.largest_read);
+
+    // Byte-by-byte scanning within the cached chunks reads nothing more.
+    for (size_t offset = 0; offset < STREAM_CHUNK_COUNT * STREAM_CHUNK_SIZE; offset++) cache.at(offset);
+    uint32_t reads = source.reads;
+    for (size_t offset = 0; offset < STREAM_CHUNK_COUNT * STREAM_CHUNK_SIZE; offset++) cache.at(offset);
+    TEST_ASSERT_EQUAL_UINT32(reads, source.reads);
+}
+
+void test_lines_do_not_show_carriage_returns() {
+    StdioTextSource source(file);
+    StreamPageProbe page(source);
+    std::vector<size_t> lines = forwardLines(page);
+    for (size_t i = 0; i + 1 < lines.size(); i++) {
+        // A line ends at a wrap or at the CRLF, never between CR and LF.
+        size_t next = lines[i + 1];
+        TEST_ASSERT_TRUE(text[next - 1] != '\r');
+        if (text[next - 1] == '\n') TEST_ASSERT_EQUAL_INT('\r', text[next - 2]);
+    }
+}
+
+void test_prev_line_undoes_next_line() {
+    StdioTextSource source(file);
+    StreamPageProbe page(source);
+    std::vector<size_t> lines = forwardLines(page);
+    TEST_ASSERT_GREATER_THAN(FILE_SIZE / 100, lines.size());
+
+    int crossings = 0;
+    for (size_t i = 0; i + 1 < lines.size(); i++) {
+        // Every line that crosses a chunk boundary, and every 50th line.
+        bool crosses = lines[i] / STREAM_CHUNK_SIZE != lines[i + 1] / STREAM_CHUNK_SIZE;
+        if (!crosses && i % 50 != 0) continue;
+        crossings += crosses;
+        TEST_ASSERT_EQUAL_size_t(lines[i], page.prevLine(page.nextLine(lines[i])));
+    }
+    TEST_ASSERT_GREATER_THAN(1000, crossings);
+}
+
+void test_scroll_to_the_end_and_back() {
+    StdioTextSource file_source(file);
+    CountingSource source(file_source);
+    StreamPageProbe page(source);
+
+    std::vector<size_t> tops(1, page.topOffset());
+    tops.reserve(FILE_SIZE / 8);
+    uint64_t allocations = Simulator::allocationCount();
+    while (true) {
+        page.onScrollDown();
+        if (page.topOffset() == tops.back()) break;
+        tops.push_back(page.topOffset());
+    }
+    TEST_ASSERT_GREATER_THAN(text.size() - SCREEN_WIDTH * 8, tops.back());
+
+    for (size_t i = tops.size() - 1; i > 0; i--) {
+        page.onScrollUp();
+        TEST_ASSERT_EQUAL_size_t(tops[i - 1], page.topOffset());
+    }
+    page.onScrollUp();
+    TEST_ASSERT_EQUAL_size_t(0, page.topOffset());
+
+    // Only the chunks the page holds were in memory: nothing was allocated while scrolling.
+    TEST_ASSERT_EQUAL_UINT64(0, Simulator::allocationCount() - allocations);
+    TEST_ASSERT_LESS_OR_EQUAL(STREAM_CHUNK_SIZE, source.largest_read);
+}
+
+void test_paragraph_longer_than_the_back_scan() {
+    // One unbroken line far longer than STREAM_MAX_BACKSCAN, between short ones.
+    std::string long_text = "first\r\n";
+    for (size_t i = 0; i < 3 * STREAM_MAX_BACKSCAN + 17; i++) long_text += (char)('a' + i % 26);
+    long_text += "\r\nlast\r\n";
+    MemoryTextSource source(StringView(long_text.data(), long_text.size()));
+    StreamPageProbe page(source);
+
+    std::vector<size_t> lines;
+    for (size_t line = 0; line < long_text.size(); line = page.nextLine(line)) lines.push_back(line);
+    for (size_t i = 1; i < lines.size(); i++) {
+        // Scrolling up may wrap the long line differently, but never repeats or skips text.
+        size_t previous = page.prevLine(lines[i]);
+        TEST_ASSERT_EQUAL_size_t(lines[i], page.nextLine(previous));
+        TEST_ASSERT_LESS_THAN(lines[i], previous);
+    }
+}
+
+int main() {
+    makeText();
+    file = tmpfile();
+    fwrite(text.data(), 1, text.size(), file);
+    fflush(file);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_stdio_source_reads_the_file);
+    RUN_TEST(test_chunk_cache_matches_the_file);
+    RUN_TEST(test_lines_do_not_show_carriage_returns);
+    RUN_TEST(test_prev_line_undoes_next_line);
+    RUN_TEST(test_scroll_to_the_end_and_back);
+    RUN_TEST(test_paragraph_longer_than_the_back_scan);
+    int failures = UNITY_END();
+    fclose(file);
+    return failures;
+}